@@ -6,6 +6,8 @@
 // PN532 NFC Reader
 #define PN532_SDA                   21
 #define PN532_SCL                   22
+#define PN532_IRQ                   25      // PN532 IRQ output (active LOW), drives the scan engine
+#define PN532_RESET                 26      // PN532 RSTPDN input
 
 // Buttons (ensure these match your wiring)
 #define BUTTON_A_PIN                4       // Up / Next / Select / Option 1 / Yes
@@ -18,32 +20,71 @@
 #define OLED_RESET                  -1      // Reset pin # (or -1 if sharing Arduino reset pin)
 #define OLED_I2C_ADDRESS            0x3C    // Common address, verify for your display
 
+// --- Shared I2C Bus ---
+#define NFC_I2C_CLOCK_HZ            400000  // PN532 maximum (datasheet)
+#ifndef OLED_I2C_CLOCK_HZ
+#define OLED_I2C_CLOCK_HZ           400000  // SSD1306 maximum (datasheet); many modules take 800000 via build_flags -DOLED_I2C_CLOCK_HZ=800000
+#endif
+
 // --- Application Behavior & Timings ---
-#define MAX_EXPECTED_ITEMS          20      // Max items in an equipment list
+#define MAX_EXPECTED_ITEMS          512     // Sanity cap on equipment list size (the table itself is sized at load time)
 #define MAX_BAGS_TO_LIST            10      // Max bags to fetch/display in "Set Active Bag" menu
 
-#define NFC_POLLING_INTERVAL_MS     200     // How often to check for an NFC tag
-#define TAG_READ_DELAY_MS           500     // Pause after a successful tag read to prevent immediate re-read
+#define NFC_EVENT_QUEUE_SIZE        8       // Detected-tag events buffered between the scan engine and the states
+#define NFC_RECENT_UID_SLOTS        8       // Recently detected tags tracked for duplicate suppression
+#define NFC_TAG_GONE_MS             500     // A tag not detected for this long has left the pad (re-presenting it reads again)
+#define NFC_REARM_HOLDOFF_MS        250     // Single-tag states: re-arm delay after a read, keeps a resting tag off the bus (< NFC_TAG_GONE_MS)
 #define HTTP_TIMEOUT_MS             10000   // Timeout for WiFi/HTTP requests (milliseconds)
+#define AIRTABLE_BATCH_SIZE         10      // Records per Airtable create/update request (API limit)
+#define AIRTABLE_JOURNAL_MAX_BYTES  (MAX_EXPECTED_ITEMS * 64) // Offline update journal stops accepting entries beyond this (a full session's "seen" stamps take ~24 bytes per item)
+#define AIRTABLE_SESSIONS_TABLE     "Repack Sessions" // Table receiving repack session outcomes
+#define EQUIPMENT_FULL_SYNC_INTERVAL_S  86400 // Full list download at least daily, catches records deleted in Airtable
+#define EQUIPMENT_SYNC_CLOCK_MARGIN_S   120   // Delta syncs re-ask for changes this far before the last sync
 #define ADMIN_TAG_SCAN_TIMEOUT_MS   10000   // How long to wait for admin tag scan before timing out
 // #define ADMIN_LONG_PRESS_MS         2000 // Currently unused, but could be for future features
 
 #define STATUS_MESSAGE_DURATION_MS  2000    // Default duration for temporary OLED status messages
+#define TOAST_QUEUE_SIZE            4       // Temporary status messages waiting to be shown
+#define TOAST_MIN_DURATION_MS       400     // A toast is cut short to this when another one is waiting
 #define WELL_DONE_TIMEOUT_MS        5000    // Auto-return from "Well Done" / session complete screen
 
 #define DEBOUNCE_DELAY_MS           50      // Button debounce delay
+#define UI_TASK_WAIT_MS             20      // Longest UI task wait between passes when light sleep is not possible
+#define LIGHT_SLEEP_MIN_MS          5       // Shorter idle gaps are not worth a light sleep round-trip
+#define LIGHT_SLEEP_MAX_MS          1000    // Upper bound of one light sleep without any deadline
 
 // --- Deep Sleep Configuration ---
 #define DEEP_SLEEP_TIMEOUT_MS       60000   // Inactivity duration before entering deep sleep (e.g., 60 seconds)
 // BUTTON_MASK is derived from BUTTON_x_PINs in the main .ino, so it stays there or is moved carefully.
 
+#define RTC_SNAPSHOT_BYTES          4096    // RTC slow memory (8 KB in total) kept for the bag/equipment snapshot
+
+// --- FreeRTOS Tasks ---
+// The Arduino loop task (core 1, priority 1) is the UI/render task.
+#define NFC_TASK_STACK_SIZE         4096
+#define NFC_TASK_PRIORITY           3       // Above the UI so a tag read is never held up by drawing
+#define NFC_TASK_CORE               1
+#define NFC_TASK_POLL_MS            10      // Wake-up without IRQ: missed edges
+#define NETWORK_TASK_STACK_SIZE     16384   // TLS handshake + JSON parsing
+#define NETWORK_TASK_PRIORITY       1
+#define NETWORK_TASK_CORE           0       // Same core as the WiFi stack
+#define NET_JOB_QUEUE_SIZE          4
+
 // --- File System Paths ---
-#define EQUIPMENT_LIST_FILE         "/equipment_list.csv" // SPIFFS path for cached equipment list
+#define EQUIPMENT_LIST_FILE         "/equipment_list.bin" // SPIFFS path for cached equipment list (binary, see saveListToSPIFFS)
+#define EQUIPMENT_LIST_TEMP_FILE    "/equipment_list.tmp" // Written first, then renamed over the cache
+#define EQUIPMENT_LIST_CSV_FILE     "/equipment_list.csv" // Cache of older firmware, migrated on first load
+#define EQUIPMENT_SYNC_FILE         "/equipment_sync.txt" // When the cached list was last synced with Airtable
+#define AIRTABLE_JOURNAL_FILE       "/airtable_journal.jsonl" // Updates waiting to be sent to Airtable
+#define AIRTABLE_JOURNAL_TEMP_FILE  "/airtable_journal.tmp"   // Used while compacting the journal
+#define AIRTABLE_JOURNAL_OLD_FILE   "/airtable_journal.old"   // Previous journal, kept until the compacted one is in place
 #define BAG_CONFIG_FILE             "/bag_config.txt"     // SPIFFS path for active bag configuration
 
 // --- Debugging & Logging ---
 // You could add flags here to enable/disable certain verbose logging sections
 // #define DEBUG_NFC_VERBOSE
 // #define DEBUG_HTTP_VERBOSE
+// #define DEBUG_BUTTONS           // Logs every debounced button press
+// #define PERF_METRICS            // Prints a JSON line with scan latency/throughput after each repack session
 
 #endif // CONFIG_H
\ No newline at end of file
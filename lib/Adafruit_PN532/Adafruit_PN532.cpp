@@ -574,16 +574,56 @@ bool Adafruit_PN532::readPassiveTargetID(uint8_t cardbaudrate, uint8_t *uid,
 /*!
     @brief   Put the reader in detection mode, non blocking so interrupts
              must be enabled.
+
+    Only waits for the ACK frame. The PN532 pulls IRQ low once a card has
+    been detected, after which readDetectedPassiveTargetID() fetches it.
+
     @param   cardbaudrate  Baud rate of the card
-    @return  1 if everything executed properly, 0 for an error
+    @param   maxTargets    Max number of cards to inlist (1 or 2), read
+                           them with readDetectedPassiveTargetIDs() when
+                           more than one is requested
+    @return  1 if the command was acknowledged, 0 for an error
 */
 /**************************************************************************/
-bool Adafruit_PN532::startPassiveTargetIDDetection(uint8_t cardbaudrate) {
+bool Adafruit_PN532::startPassiveTargetIDDetection(uint8_t cardbaudrate,
+                                                   uint8_t maxTargets) {
+  if (maxTargets < 1 || maxTargets > PN532_MAX_TARGETS)
+    maxTargets = 1;
+
   pn532_packetbuffer[0] = PN532_COMMAND_INLISTPASSIVETARGET;
-  pn532_packetbuffer[1] = 1; // max 1 cards at once (we can set this to 2 later)
+  pn532_packetbuffer[1] = maxTargets;
   pn532_packetbuffer[2] = cardbaudrate;
 
-  return sendCommandCheckAck(pn532_packetbuffer, 3);
+  writecommand(pn532_packetbuffer, 3);
+
+  // Wait for the ACK only, the response arrives whenever a card shows up
+  if (!waitready(PN532_ACK_WAIT_TIME)) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.println(F("No ACK for detection command"));
+#endif
+    return false;
+  }
+
+  return readack();
+}
+
+/**************************************************************************/
+/*!
+    @brief   Aborts the command the PN532 is currently executing, e.g. a
+             pending startPassiveTargetIDDetection(), by sending an ACK
+             frame (see PN532 User Manual 6.2.1.3).
+*/
+/**************************************************************************/
+void Adafruit_PN532::abortCommand(void) {
+  if (spi_dev) {
+    uint8_t packet[7] = {PN532_SPI_DATAWRITE};
+    memcpy(packet + 1, pn532ack, sizeof(pn532ack));
+    spi_dev->write(packet, sizeof(packet));
+  } else if (i2c_dev) {
+    i2c_dev->write(pn532ack, sizeof(pn532ack));
+  } else if (ser_dev) {
+    ser_dev->write(pn532ack, sizeof(pn532ack));
+  }
 }
 
 /**************************************************************************/
@@ -653,6 +693,103 @@ bool Adafruit_PN532::readDetectedPassiveTargetID(uint8_t *uid,
   return 1;
 }
 
+/**************************************************************************/
+/*!
+    Reads the IDs of all passive targets the reader has detected after
+    startPassiveTargetIDDetection() with maxTargets > 1.
+
+    @param  uids          Array populated with the UID of each target
+                          (up to 7 bytes each), in Tg order
+    @param  uidLengths    Array populated with the UID length of each
+                          target
+    @param  maxTargets    Number of entries in uids/uidLengths
+
+    @returns Number of targets read, 0 for an error
+*/
+/**************************************************************************/
+uint8_t Adafruit_PN532::readDetectedPassiveTargetIDs(uint8_t uids[][7],
+                                                     uint8_t *uidLengths,
+                                                     uint8_t maxTargets) {
+  // Two targets with 7 byte UIDs fit in 34 bytes, ATS bytes may not
+  const uint8_t responseLength = 48;
+  readdata(pn532_packetbuffer, responseLength);
+
+  /* ISO14443A card response should be in the following format:
+
+    byte            Description
+    -------------   ------------------------------------------
+    b0..6           Frame header and preamble
+    b7              Tags Found
+    then per target:
+    b0              Tag Number
+    b1..2           SENS_RES
+    b3              SEL_RES
+    b4              NFCID Length
+    b5..NFCIDLen    NFCID
+    ...             ATS (only if SEL_RES bit 6 is set, b0 is its length) */
+
+  if (pn532_packetbuffer[0] != 0 || pn532_packetbuffer[1] != 0 ||
+      pn532_packetbuffer[2] != 0xFF ||
+      pn532_packetbuffer[6] != PN532_RESPONSE_INLISTPASSIVETARGET)
+    return 0;
+
+  // Frame data (TFI onwards) starts at b5 and is LEN bytes long
+  uint8_t frameEnd = 5 + pn532_packetbuffer[3];
+  if (frameEnd > responseLength)
+    frameEnd = responseLength;
+
+#ifdef MIFAREDEBUG
+  PN532DEBUGPRINT.print(F("Found "));
+  PN532DEBUGPRINT.print(pn532_packetbuffer[7], DEC);
+  PN532DEBUGPRINT.println(F(" tags"));
+#endif
+
+  uint8_t found = 0;
+  uint8_t pos = 8;
+  for (uint8_t t = 0; t < pn532_packetbuffer[7] && found < maxTargets; t++) {
+    if (pos + 5 > frameEnd)
+      break;
+    uint8_t selRes = pn532_packetbuffer[pos + 3];
+    uint8_t nfcidLength = pn532_packetbuffer[pos + 4];
+    if (nfcidLength > 7 || pos + 5 + nfcidLength > frameEnd)
+      break; // Truncated or not an ISO14443A record
+
+    memcpy(uids[found], &pn532_packetbuffer[pos + 5], nfcidLength);
+    uidLengths[found] = nfcidLength;
+    found++;
+
+    pos += 5 + nfcidLength;
+    if (selRes & 0x20) { // ISO14443-4 compliant, skip the ATS
+      if (pos >= frameEnd)
+        break;
+      pos += pn532_packetbuffer[pos];
+    }
+  }
+
+  return found;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Releases target(s). ISO14443A targets are halted (HLTA) and
+             stay silent until they leave the field.
+
+    @param   target  Tg number of the target, 0 for all targets
+    @return  true on success, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::inRelease(uint8_t target) {
+  pn532_packetbuffer[0] = PN532_COMMAND_INRELEASE;
+  pn532_packetbuffer[1] = target;
+
+  if (!sendCommandCheckAck(pn532_packetbuffer, 2))
+    return false;
+
+  readdata(pn532_packetbuffer, 8);
+  return pn532_packetbuffer[6] == PN532_RESPONSE_INRELEASE &&
+         (pn532_packetbuffer[7] & 0x3F) == 0;
+}
+
 /**************************************************************************/
 /*!
     @brief   Exchanges an APDU with the currently inlisted peer
@@ -1362,6 +1499,76 @@ uint8_t Adafruit_PN532::ntag2xx_ReadPage(uint8_t page, uint8_t *buffer) {
   return 1;
 }
 
+/**************************************************************************/
+/*!
+    @brief   Reads a run of consecutive 4-byte pages from an NTAG 2xx tag.
+
+    The MIFARE READ command always returns 16 bytes (4 pages), so this
+    issues one InDataExchange per 4 pages instead of one per page like
+    ntag2xx_ReadPage() does.
+
+    @param   startPage   The first page to read
+    @param   count       Number of pages to read
+    @param   buffer      Pointer to the byte array that will hold the
+                         retrieved data, must be at least count * 4 bytes
+    @return  1 on success, 0 on error.
+*/
+/**************************************************************************/
+uint8_t Adafruit_PN532::ntag2xx_ReadPages(uint8_t startPage, uint8_t count,
+                                          uint8_t *buffer) {
+  if (count == 0 || (uint16_t)startPage + count > 231) {
+#ifdef MIFAREDEBUG
+    PN532DEBUGPRINT.println(F("Page range out of range"));
+#endif
+    return 0;
+  }
+
+  uint8_t page = startPage;
+  uint8_t remaining = count;
+  while (remaining > 0) {
+#ifdef MIFAREDEBUG
+    PN532DEBUGPRINT.print(F("Reading pages from "));
+    PN532DEBUGPRINT.println(page);
+#endif
+
+    /* Prepare the command */
+    pn532_packetbuffer[0] = PN532_COMMAND_INDATAEXCHANGE;
+    pn532_packetbuffer[1] = 1;               /* Card number */
+    pn532_packetbuffer[2] = MIFARE_CMD_READ; /* Mifare Read command = 0x30 */
+    pn532_packetbuffer[3] = page;            /* First page of the block */
+
+    /* Send the command */
+    if (!sendCommandCheckAck(pn532_packetbuffer, 4)) {
+#ifdef MIFAREDEBUG
+      PN532DEBUGPRINT.println(F("Failed to receive ACK for read command"));
+#endif
+      return 0;
+    }
+
+    /* Read the response packet: header + status + 16 data bytes */
+    readdata(pn532_packetbuffer, 26);
+
+    /* If byte 8 isn't 0x00 we probably have an error */
+    if (pn532_packetbuffer[7] != 0x00) {
+#ifdef MIFAREDEBUG
+      PN532DEBUGPRINT.println(F("Unexpected response reading block: "));
+      Adafruit_PN532::PrintHexChar(pn532_packetbuffer, 26);
+#endif
+      return 0;
+    }
+
+    /* Keep all 4 pages of the block, or only what is left to read */
+    uint8_t pages = remaining < 4 ? remaining : 4;
+    memcpy(buffer, pn532_packetbuffer + 8, pages * 4);
+    buffer += pages * 4;
+    page += pages;
+    remaining -= pages;
+  }
+
+  // Return OK signal
+  return 1;
+}
+
 /**************************************************************************/
 /*!
     Tries to write an entire 4-byte page at the specified block
@@ -1553,6 +1760,10 @@ bool Adafruit_PN532::isready() {
     spi_dev->write_then_read(&cmd, 1, &reply, 1);
     return reply == PN532_SPI_READY;
   } else if (i2c_dev) {
+    // With IRQ wired, the PN532 pulls it low once a frame is ready: check the
+    // pin first so waiting causes no bus traffic
+    if (_irq != -1 && digitalRead(_irq) != LOW)
+      return false;
     // I2C ready check via reading RDY byte
     uint8_t rdy[1];
     i2c_dev->read(rdy, 1);
@@ -1575,10 +1786,13 @@ bool Adafruit_PN532::isready() {
 */
 /**************************************************************************/
 bool Adafruit_PN532::waitready(uint16_t timeout) {
+  // Polling the IRQ pin is free, so it can be checked more often than the bus
+  const uint16_t pollMs =
+      (i2c_dev && _irq != -1) ? PN532_IRQ_POLL_MS : PN532_READY_POLL_MS;
   uint16_t timer = 0;
   while (!isready()) {
     if (timeout != 0) {
-      timer += 10;
+      timer += pollMs;
       if (timer > timeout) {
 #ifdef PN532DEBUG
         PN532DEBUGPRINT.println("TIMEOUT!");
@@ -1586,7 +1800,7 @@ bool Adafruit_PN532::waitready(uint16_t timeout) {
         return false;
       }
     }
-    delay(10);
+    delay(pollMs);
   }
   return true;
 }
@@ -62,6 +62,7 @@
 
 #define PN532_RESPONSE_INDATAEXCHANGE (0x41)      ///< Data exchange
 #define PN532_RESPONSE_INLISTPASSIVETARGET (0x4B) ///< List passive target
+#define PN532_RESPONSE_INRELEASE (0x53)           ///< Release
 
 #define PN532_WAKEUP (0x55) ///< Wake
 
@@ -76,7 +77,12 @@
 #define PN532_I2C_READY (0x01)        ///< Ready
 #define PN532_I2C_READYTIMEOUT (20)   ///< Ready timeout
 
+#define PN532_ACK_WAIT_TIME (10) ///< ms to wait for an ACK frame
+#define PN532_READY_POLL_MS (10) ///< ms between ready checks over the bus
+#define PN532_IRQ_POLL_MS (1) ///< ms between IRQ pin checks (I2C with IRQ wired)
+
 #define PN532_MIFARE_ISO14443A (0x00) ///< MiFare
+#define PN532_MAX_TARGETS (2) ///< Max targets the PN532 can inlist at once
 
 // Mifare Commands
 #define MIFARE_CMD_AUTH_A (0x60)           ///< Auth A
@@ -164,8 +170,13 @@ public:
   bool readPassiveTargetID(
       uint8_t cardbaudrate, uint8_t *uid, uint8_t *uidLength,
       uint16_t timeout = 0); // timeout 0 means no timeout - will block forever.
-  bool startPassiveTargetIDDetection(uint8_t cardbaudrate);
+  bool startPassiveTargetIDDetection(uint8_t cardbaudrate,
+                                     uint8_t maxTargets = 1);
   bool readDetectedPassiveTargetID(uint8_t *uid, uint8_t *uidLength);
+  uint8_t readDetectedPassiveTargetIDs(uint8_t uids[][7], uint8_t *uidLengths,
+                                       uint8_t maxTargets);
+  bool inRelease(uint8_t target = 0);
+  void abortCommand(void);
   bool inDataExchange(uint8_t *send, uint8_t sendLength, uint8_t *response,
                       uint8_t *responseLength);
   bool inListPassiveTarget();
@@ -191,6 +202,8 @@ public:
 
   // NTAG2xx functions
   uint8_t ntag2xx_ReadPage(uint8_t page, uint8_t *buffer);
+  uint8_t ntag2xx_ReadPages(uint8_t startPage, uint8_t count,
+                            uint8_t *buffer);
   uint8_t ntag2xx_WritePage(uint8_t page, uint8_t *data);
   uint8_t ntag2xx_WriteNDEFURI(uint8_t uriIdentifier, char *url,
                                uint8_t dataLen);
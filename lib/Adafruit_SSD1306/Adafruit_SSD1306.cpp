@@ -93,8 +93,12 @@
 #endif
 
 #if (ARDUINO >= 157) && !defined(ARDUINO_STM32_FEATHER)
-#define SETWIRECLOCK wire->setClock(wireClk)    ///< Set before I2C transfer
-#define RESWIRECLOCK wire->setClock(restoreClk) ///< Restore after I2C xfer
+#define SETWIRECLOCK                                                           \
+  if (wireClk)                                                                 \
+  wire->setClock(wireClk) ///< Set before I2C transfer, unless 0
+#define RESWIRECLOCK                                                           \
+  if (restoreClk)                                                              \
+  wire->setClock(restoreClk) ///< Restore after I2C xfer, unless 0
 #else // setClock() is not present in older Arduino Wire lib (or WICED)
 #define SETWIRECLOCK ///< Dummy stand-in define
 #define RESWIRECLOCK ///< keeps compiler happy
@@ -159,15 +163,18 @@
             Some systems can operate I2C faster (800 KHz for ESP32, 1 MHz
             for many other 32-bit MCUs), and some (perhaps not all)
             SSD1306's can work with this -- so it's optionally be specified
-            here and is not a default behavior. (Ignored if using pre-1.5.7
-            Arduino software, which operates I2C at a fixed 100 KHz.)
+            here and is not a default behavior. 0 leaves the clock as it
+            is, for callers that set it themselves before each transfer.
+            (Ignored if using pre-1.5.7 Arduino software, which operates
+            I2C at a fixed 100 KHz.)
     @param  clkAfter
             Speed (in Hz) for Wire transmissions following SSD1306 library
             calls. Defaults to 100000 (100 KHz), the default Arduino Wire
             speed. This is done rather than leaving it at the 'during' speed
             because other devices on the I2C bus might not be compatible
-            with the faster rate. (Ignored if using pre-1.5.7 Arduino
-            software, which operates I2C at a fixed 100 KHz.)
+            with the faster rate. 0 leaves the clock at the 'during' speed.
+            (Ignored if using pre-1.5.7 Arduino software, which operates
+            I2C at a fixed 100 KHz.)
     @return Adafruit_SSD1306 object.
     @note   Call the object's begin() function before use -- buffer
             allocation is performed there!
@@ -176,7 +183,8 @@ Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire *twi,
                                    int8_t rst_pin, uint32_t clkDuring,
                                    uint32_t clkAfter)
     : Adafruit_GFX(w, h), spi(NULL), wire(twi ? twi : &Wire), buffer(NULL),
-      mosiPin(-1), clkPin(-1), dcPin(-1), csPin(-1), rstPin(rst_pin)
+      shadow(NULL), shadowValid(false), mosiPin(-1), clkPin(-1), dcPin(-1),
+      csPin(-1), rstPin(rst_pin)
 #if ARDUINO >= 157
       ,
       wireClk(clkDuring), restoreClk(clkAfter)
@@ -214,9 +222,9 @@ Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire *twi,
 Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, int8_t mosi_pin,
                                    int8_t sclk_pin, int8_t dc_pin,
                                    int8_t rst_pin, int8_t cs_pin)
-    : Adafruit_GFX(w, h), spi(NULL), wire(NULL), buffer(NULL),
-      mosiPin(mosi_pin), clkPin(sclk_pin), dcPin(dc_pin), csPin(cs_pin),
-      rstPin(rst_pin) {}
+    : Adafruit_GFX(w, h), spi(NULL), wire(NULL), buffer(NULL), shadow(NULL),
+      shadowValid(false), mosiPin(mosi_pin), clkPin(sclk_pin), dcPin(dc_pin),
+      csPin(cs_pin), rstPin(rst_pin) {}
 
 /*!
     @brief  Constructor for SPI SSD1306 displays, using native hardware SPI.
@@ -248,8 +256,8 @@ Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, SPIClass *spi_ptr,
                                    int8_t dc_pin, int8_t rst_pin, int8_t cs_pin,
                                    uint32_t bitrate)
     : Adafruit_GFX(w, h), spi(spi_ptr ? spi_ptr : &SPI), wire(NULL),
-      buffer(NULL), mosiPin(-1), clkPin(-1), dcPin(dc_pin), csPin(cs_pin),
-      rstPin(rst_pin) {
+      buffer(NULL), shadow(NULL), shadowValid(false), mosiPin(-1), clkPin(-1),
+      dcPin(dc_pin), csPin(cs_pin), rstPin(rst_pin) {
 #ifdef SPI_HAS_TRANSACTION
   spiSettings = SPISettings(bitrate, MSBFIRST, SPI_MODE0);
 #endif
@@ -284,8 +292,8 @@ Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, SPIClass *spi_ptr,
 Adafruit_SSD1306::Adafruit_SSD1306(int8_t mosi_pin, int8_t sclk_pin,
                                    int8_t dc_pin, int8_t rst_pin, int8_t cs_pin)
     : Adafruit_GFX(SSD1306_LCDWIDTH, SSD1306_LCDHEIGHT), spi(NULL), wire(NULL),
-      buffer(NULL), mosiPin(mosi_pin), clkPin(sclk_pin), dcPin(dc_pin),
-      csPin(cs_pin), rstPin(rst_pin) {}
+      buffer(NULL), shadow(NULL), shadowValid(false), mosiPin(mosi_pin),
+      clkPin(sclk_pin), dcPin(dc_pin), csPin(cs_pin), rstPin(rst_pin) {}
 
 /*!
     @brief  DEPRECATED constructor for SPI SSD1306 displays, using native
@@ -310,8 +318,8 @@ Adafruit_SSD1306::Adafruit_SSD1306(int8_t mosi_pin, int8_t sclk_pin,
 */
 Adafruit_SSD1306::Adafruit_SSD1306(int8_t dc_pin, int8_t rst_pin, int8_t cs_pin)
     : Adafruit_GFX(SSD1306_LCDWIDTH, SSD1306_LCDHEIGHT), spi(&SPI), wire(NULL),
-      buffer(NULL), mosiPin(-1), clkPin(-1), dcPin(dc_pin), csPin(cs_pin),
-      rstPin(rst_pin) {
+      buffer(NULL), shadow(NULL), shadowValid(false), mosiPin(-1), clkPin(-1),
+      dcPin(dc_pin), csPin(cs_pin), rstPin(rst_pin) {
 #ifdef SPI_HAS_TRANSACTION
   spiSettings = SPISettings(8000000, MSBFIRST, SPI_MODE0);
 #endif
@@ -333,8 +341,8 @@ Adafruit_SSD1306::Adafruit_SSD1306(int8_t dc_pin, int8_t rst_pin, int8_t cs_pin)
 */
 Adafruit_SSD1306::Adafruit_SSD1306(int8_t rst_pin)
     : Adafruit_GFX(SSD1306_LCDWIDTH, SSD1306_LCDHEIGHT), spi(NULL), wire(&Wire),
-      buffer(NULL), mosiPin(-1), clkPin(-1), dcPin(-1), csPin(-1),
-      rstPin(rst_pin) {}
+      buffer(NULL), shadow(NULL), shadowValid(false), mosiPin(-1), clkPin(-1),
+      dcPin(-1), csPin(-1), rstPin(rst_pin) {}
 
 /*!
     @brief  Destructor for Adafruit_SSD1306 object.
@@ -344,6 +352,10 @@ Adafruit_SSD1306::~Adafruit_SSD1306(void) {
     free(buffer);
     buffer = NULL;
   }
+  if (shadow) {
+    free(shadow);
+    shadow = NULL;
+  }
 }
 
 // LOW-LEVEL UTILS ---------------------------------------------------------
@@ -499,6 +511,12 @@ bool Adafruit_SSD1306::begin(uint8_t vcs, uint8_t addr, bool reset,
   if ((!buffer) && !(buffer = (uint8_t *)malloc(WIDTH * ((HEIGHT + 7) / 8))))
     return false;
 
+  // Shadow copy for displayPartial(), optional: without it every refresh is
+  // a full display()
+  if (!shadow)
+    shadow = (uint8_t *)malloc(WIDTH * ((HEIGHT + 7) / 8));
+  shadowValid = false; // Panel RAM content is unknown until the first push
+
   clearDisplay();
 
 #ifndef SSD1306_NO_SPLASH
@@ -1038,6 +1056,109 @@ void Adafruit_SSD1306::display(void) {
 #if defined(ESP8266)
   yield();
 #endif
+  if (shadow) {
+    memcpy(shadow, buffer, WIDTH * ((HEIGHT + 7) / 8));
+    shadowValid = true;
+  }
+}
+
+/*!
+    @brief  Whether displayPartial()/displayPartialPage() can diff against
+            the panel content, i.e. a full frame has been pushed since
+            begin().
+    @return true if partial updates are possible, false if the next
+            refresh has to be a full display().
+*/
+bool Adafruit_SSD1306::partialReady(void) { return shadow && shadowValid; }
+
+/*!
+    @brief  Push the part of one 8-pixel page that changed since the last
+            refresh. Lets a caller split a refresh into short bus
+            transactions, e.g. to let another device on a shared I2C bus in
+            between pages.
+    @param  page
+            Page index, 0 to (HEIGHT + 7) / 8 - 1.
+    @return Number of command and data bytes sent to the panel (I2C
+            control bytes not counted), 0 if the page is unchanged.
+    @note   Only valid once partialReady() is true.
+*/
+uint16_t Adafruit_SSD1306::displayPartialPage(uint8_t page) {
+  if (!partialReady() || page >= ((HEIGHT + 7) / 8))
+    return 0;
+
+  uint8_t *row = &buffer[page * WIDTH];
+  uint8_t *old = &shadow[page * WIDTH];
+
+  int16_t first = 0;
+  while ((first < WIDTH) && (row[first] == old[first]))
+    first++;
+  if (first == WIDTH)
+    return 0; // Page unchanged
+  int16_t last = WIDTH - 1;
+  while (row[last] == old[last])
+    last--;
+
+  uint8_t window[] = {SSD1306_PAGEADDR,   page,          page,
+                      SSD1306_COLUMNADDR, (uint8_t)first, (uint8_t)last};
+  uint16_t count = last - first + 1;
+  uint8_t *ptr = &row[first];
+  uint16_t bytesSent = sizeof(window) + count;
+
+  TRANSACTION_START
+  if (wire) { // I2C
+    wire->beginTransmission(i2caddr);
+    WIRE_WRITE((uint8_t)0x00); // Co = 0, D/C = 0
+    for (uint8_t i = 0; i < sizeof(window); i++)
+      WIRE_WRITE(window[i]);
+    wire->endTransmission();
+
+    wire->beginTransmission(i2caddr);
+    WIRE_WRITE((uint8_t)0x40);
+    uint16_t bytesOut = 1;
+    while (count--) {
+      if (bytesOut >= WIRE_MAX) {
+        wire->endTransmission();
+        wire->beginTransmission(i2caddr);
+        WIRE_WRITE((uint8_t)0x40);
+        bytesOut = 1;
+      }
+      WIRE_WRITE(*ptr++);
+      bytesOut++;
+    }
+    wire->endTransmission();
+  } else { // SPI
+    SSD1306_MODE_COMMAND
+    for (uint8_t i = 0; i < sizeof(window); i++)
+      SPIwrite(window[i]);
+    SSD1306_MODE_DATA
+    while (count--)
+      SPIwrite(*ptr++);
+  }
+  TRANSACTION_END
+  memcpy(&old[first], &row[first], last - first + 1);
+  return bytesSent;
+}
+
+/*!
+    @brief  Push only the parts of RAM that changed since the last refresh.
+    @return Number of command and data bytes sent to the panel (I2C
+            control bytes not counted), 0 if nothing changed.
+    @note   For every 8-pixel page the first and last differing column are
+            found by comparing against the last pushed frame, and only that
+            window is sent using PAGEADDR/COLUMNADDR. Redrawing an
+            unchanged screen sends nothing. Falls back to display() until
+            the panel content is known.
+*/
+uint16_t Adafruit_SSD1306::displayPartial(void) {
+  if (!partialReady()) {
+    display();
+    return 6 + WIDTH * ((HEIGHT + 7) / 8); // Address window + full frame
+  }
+
+  uint16_t bytesSent = 0;
+  for (uint8_t page = 0; page < ((HEIGHT + 7) / 8); page++)
+    bytesSent += displayPartialPage(page);
+  return bytesSent;
 }
 
 // SCROLLING FUNCTIONS -----------------------------------------------------
@@ -150,6 +150,9 @@ public:
   bool begin(uint8_t switchvcc = SSD1306_SWITCHCAPVCC, uint8_t i2caddr = 0,
              bool reset = true, bool periphBegin = true);
   void display(void);
+  uint16_t displayPartial(void);
+  uint16_t displayPartialPage(uint8_t page);
+  bool partialReady(void);
   void clearDisplay(void);
   void invertDisplay(bool i);
   void dim(bool dim);
@@ -178,6 +181,10 @@ protected:
                    ///< Wire.cpp, Wire.h
   uint8_t *buffer; ///< Buffer data used for display buffer. Allocated when
                    ///< begin method is called.
+  uint8_t *shadow; ///< Copy of what the panel currently shows, compared
+                   ///< against buffer by displayPartial(). Allocated when
+                   ///< begin method is called.
+  bool shadowValid; ///< False until the first full display() after begin
   int8_t i2caddr;  ///< I2C address initialized when begin method is called.
   int8_t vccstate; ///< VCC selection, set by begin method.
   int8_t page_end; ///< not used
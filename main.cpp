@@ -3,28 +3,65 @@
 #include <Adafruit_PN532.h>
 #include <WiFi.h>
 #include <HTTPClient.h>
+#include <WiFiClientSecure.h>
 #include <ArduinoJson.h>
 #include <SPIFFS.h>
 #include <Secrets.h> // Make sure this file exists and has your secrets
 #include <esp_log.h>
+#include <cstddef>
 #include <cstring>
+#include <cstdlib>
+#include <rom/crc.h>
+#include <esp_sleep.h>
+#include <driver/gpio.h>
 #include <Config.h>
 
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
 
 // --- Hardware Pins and Constants ---
-Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
+Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET,
+                         0, 0); // 0: the library never touches the bus clock, i2cBusAcquire() sets it
 
 // --- Deep Sleep Constants ---
 #define BUTTON_MASK                 ( (1ULL << BUTTON_A_PIN) | (1ULL << BUTTON_B_PIN) | (1ULL << BUTTON_C_PIN) )
 
 // --- Global Variables for Application State ---
-String currentExpectedItemNames[MAX_EXPECTED_ITEMS];
-String currentExpectedUIDStrings[MAX_EXPECTED_ITEMS];
-int currentMaxItems = 0;
-bool foundTagsDuringRepack[MAX_EXPECTED_ITEMS] = {false};
-bool usedTagsInitially[MAX_EXPECTED_ITEMS] = {false}; // Tracks items that were "out" at session start
+// Binary UID keys, compared on raw bytes straight from the PN532 buffer
+#define UID_MAX_LENGTH              7
+#define UID_HEX_BUFFER_SIZE         (UID_MAX_LENGTH * 2 + 1)
+struct UidKey {
+  uint8_t length;
+  uint8_t bytes[UID_MAX_LENGTH];
+};
+
+// Airtable record ids are "rec" + 14 characters
+#define AIRTABLE_RECORD_ID_LENGTH   17
+struct AirtableRecordId {
+  char id[AIRTABLE_RECORD_ID_LENGTH + 1]; // Empty if unknown (list cached before ids were kept)
+};
+
+// Equipment list for the active bag as a struct-of-arrays. Every array is
+// allocated once per list load, names are interned back to back in one arena
+// and the per-item repack flags are packed into bitsets.
+struct EquipmentTable {
+  uint16_t count;
+  uint16_t capacity;
+  UidKey* uids;
+  AirtableRecordId* recordIds;
+  uint16_t* nameOffsets;    // Start of each item's name in nameArena
+  char* nameArena;          // '\0'-terminated names, back to back
+  uint16_t arenaUsed;
+  uint16_t arenaCapacity;
+  uint16_t* uidOrder;       // Item indices sorted by UID, see buildUidIndex()
+  uint32_t* usedInitially;  // Bitset: item was "out" at session start
+  uint32_t* foundInRepack;  // Bitset: item scanned back during this repack
+  // Repack progress, kept in step with the bitsets so no scan or redraw walks the list
+  uint16_t usedInitiallyCount;
+  uint16_t foundCount;
+  uint16_t missingCount;    // Initially "out" and not scanned back yet
+};
+EquipmentTable equipment = {};
 
 const char* ntpServer = "pool.ntp.org";
 const long  gmtOffset_sec = 0;     // Change if you need a specific GMT offset for LOCAL display purposes
@@ -39,7 +76,7 @@ String availableBagNames[MAX_BAGS_TO_LIST];
 String availableBagIDs[MAX_BAGS_TO_LIST];
 int  availableBagCount = 0;
 
-Adafruit_PN532 nfc(PN532_SDA, PN532_SCL);
+Adafruit_PN532 nfc(PN532_IRQ, PN532_RESET); // I2C on the default Wire bus
 
 enum SystemState {
   IDLE_MENU,
@@ -73,11 +110,6 @@ String admin_TargetOldUID_str = "";
 String admin_NewUID_str = "";
 String admin_NewEquipmentName_str = "";
 
-// Button debouncing state
-uint8_t buttonState[32];
-uint8_t lastButtonState[32];
-unsigned long lastDebounceTime[32];
-const unsigned long debounceDelay = 50; // Debounce delay in ms
 bool allRepackItemsScanned = false;     // True if all initially "used" items are found
 
 // --- RTC Data Variables (persist through deep sleep) ---
@@ -89,6 +121,280 @@ RTC_DATA_ATTR bool rtcDataIsValid = false; // Flag to check if RTC data is valid
 // --- Inactivity Tracking ---
 unsigned long lastActivityTime = 0; // Timestamp of the last user activity
 
+// --- OLED Toasts (temporary status messages) ---
+#define TOAST_LINE_LENGTH           43      // Two wrapped OLED lines + '\0'
+struct OledToast {
+  char lines[3][TOAST_LINE_LENGTH];
+  uint16_t durationMs;
+};
+OledToast toastQueue[TOAST_QUEUE_SIZE];
+uint8_t toastHead = 0;
+uint8_t toastCount = 0;
+bool toastActive = false;            // A toast currently owns the panel
+unsigned long toastShownAt = 0;
+uint16_t toastDurationMs = 0;
+portMUX_TYPE toastMux = portMUX_INITIALIZER_UNLOCKED; // Background tasks post toasts too
+
+// --- FreeRTOS Tasks ---
+// The Arduino loop task is the UI/render task: buttons, state machine and OLED.
+// The NFC and network tasks are started by setup(), see BOOT SEQUENCE.
+TaskHandle_t uiTaskHandle = NULL;
+TaskHandle_t nfcTaskHandle = NULL;
+TaskHandle_t networkTaskHandle = NULL;
+SemaphoreHandle_t i2cMutex = NULL;  // PN532 and SSD1306 share the Wire bus, see I2C BUS SCHEDULER
+
+//==============================================================================
+// I2C BUS SCHEDULER
+//==============================================================================
+// Every transaction on the shared Wire bus goes through i2cBusAcquire/Release.
+// Ordering comes from the FreeRTOS mutex: a released bus goes to the highest
+// priority waiter, so the NFC task (NFC_TASK_PRIORITY) always gets in ahead of the
+// UI task. The OLED pushes one 8-pixel page per transaction (oledPush), which caps
+// how long a PN532 response read can be kept waiting by a framebuffer refresh.
+// The bus clock is switched to the owner's speed on acquire, and per-client wait
+// and hold times are kept for the bus occupancy stats.
+enum I2cClient {
+  I2C_CLIENT_NFC,
+  I2C_CLIENT_OLED,
+  I2C_CLIENT_COUNT
+};
+const uint32_t i2cClientClockHz[I2C_CLIENT_COUNT] = { NFC_I2C_CLOCK_HZ, OLED_I2C_CLOCK_HZ };
+
+struct I2cClientStats {
+  uint32_t transactions;
+  uint64_t waitUs;   // Blocked in i2cBusAcquire()
+  uint64_t busyUs;   // Holding the bus
+};
+I2cClientStats i2cStats[I2C_CLIENT_COUNT];
+uint32_t i2cStatsSince = 0;        // micros() of the last i2cBusResetStats()
+uint32_t i2cBusClockHz = 0;        // Owned by the bus holder
+I2cClient i2cBusOwner = I2C_CLIENT_NFC;
+uint32_t i2cBusAcquiredAt = 0;
+
+bool i2cBusAcquire(I2cClient client, TickType_t timeout = portMAX_DELAY) {
+  uint32_t askedAt = micros();
+  if (i2cMutex != NULL && xSemaphoreTake(i2cMutex, timeout) != pdTRUE) {
+    return false;
+  }
+  uint32_t now = micros();
+  i2cStats[client].transactions++;
+  i2cStats[client].waitUs += now - askedAt;
+  if (i2cBusClockHz != i2cClientClockHz[client]) {
+    Wire.setClock(i2cClientClockHz[client]);
+    i2cBusClockHz = i2cClientClockHz[client];
+  }
+  i2cBusOwner = client;
+  i2cBusAcquiredAt = now;
+  return true;
+}
+
+void i2cBusRelease() {
+  i2cStats[i2cBusOwner].busyUs += micros() - i2cBusAcquiredAt;
+  if (i2cMutex != NULL) {
+    xSemaphoreGive(i2cMutex);
+  }
+}
+
+// The stats are only written by the bus holder, so the two calls below take the
+// mutex directly: they are not bus transactions and stay out of the counts.
+void i2cBusResetStats() {
+  xSemaphoreTake(i2cMutex, portMAX_DELAY);
+  memset(i2cStats, 0, sizeof(i2cStats));
+  i2cStatsSince = micros();
+  xSemaphoreGive(i2cMutex);
+}
+
+// Adds {"occupancy":F,"nfc":{...},"oled":{...}} to 'out', times in ms.
+void i2cBusWriteStats(JsonObject out) {
+  static const char* const clientNames[I2C_CLIENT_COUNT] = { "nfc", "oled" };
+  xSemaphoreTake(i2cMutex, portMAX_DELAY);
+  I2cClientStats snapshot[I2C_CLIENT_COUNT];
+  memcpy(snapshot, i2cStats, sizeof(snapshot));
+  uint32_t elapsedUs = micros() - i2cStatsSince;
+  xSemaphoreGive(i2cMutex);
+
+  uint64_t busyUs = 0;
+  for (uint8_t c = 0; c < I2C_CLIENT_COUNT; c++) {
+    JsonObject client = out[clientNames[c]].to<JsonObject>();
+    client["transactions"] = snapshot[c].transactions;
+    client["busy_ms"] = (uint32_t)(snapshot[c].busyUs / 1000);
+    client["wait_ms"] = (uint32_t)(snapshot[c].waitUs / 1000);
+    busyUs += snapshot[c].busyUs;
+  }
+  out["occupancy"] = elapsedUs > 0 ? (float)busyUs / elapsedUs : 0.0f;
+}
+
+//==============================================================================
+// BOOT SEQUENCE
+//==============================================================================
+// setup() runs as a short list of stages. A button wake only brings up what the
+// restored screen needs: OLED, saved state and the RTC snapshot. The PN532 is
+// configured by the NFC task on the first scan request, WiFi is only started by
+// the admin flows and SPIFFS on first file access. A cold boot loads the list
+// from flash while the NFC task configures the reader in parallel.
+// Each stage is timestamped and the timings are logged after the first frame.
+#define BOOT_MAX_STAGES             10
+struct BootStageTiming {
+  const char* name;
+  uint32_t doneAtUs;  // micros() when the stage finished
+};
+BootStageTiming bootStages[BOOT_MAX_STAGES];
+uint8_t bootStageCount = 0;
+portMUX_TYPE bootStageMux = portMUX_INITIALIZER_UNLOCKED; // Stages also finish on the NFC task
+bool bootTimingsLogged = false;
+
+void bootStageDone(const char* name) {
+  uint32_t now = micros();
+  portENTER_CRITICAL(&bootStageMux);
+  if (!bootTimingsLogged && bootStageCount < BOOT_MAX_STAGES) {
+    bootStages[bootStageCount].name = name;
+    bootStages[bootStageCount].doneAtUs = now;
+    bootStageCount++;
+  }
+  portEXIT_CRITICAL(&bootStageMux);
+}
+
+// Called from loop() once the first screen is on the panel. Stages that finish
+// later on another task (cold boot NFC init) are left out.
+void bootLogTimings() {
+  bootStageDone("first frame");
+  portENTER_CRITICAL(&bootStageMux);
+  bootTimingsLogged = true;
+  uint8_t count = bootStageCount;
+  portEXIT_CRITICAL(&bootStageMux);
+
+  Serial.println("Boot timings (ms since reset, stage duration):");
+  uint32_t previousUs = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    Serial.printf("  %7.1f  +%6.1f  %s\n", bootStages[i].doneAtUs / 1000.0f,
+                  (bootStages[i].doneAtUs - previousUs) / 1000.0f, bootStages[i].name);
+    previousUs = bootStages[i].doneAtUs;
+  }
+}
+
+//==============================================================================
+// PERFORMANCE METRICS
+//==============================================================================
+// Compiled in with PERF_METRICS (Config.h). Measures the repack hot path on the
+// device and prints one JSON line per session, so builds can be compared:
+//   {"metric":"repack_session","scans":N,"items":N,"items_per_min":F,
+//    "latency_ms":{"p50":N,"p99":N,"max":N},"oled_bytes_per_scan":F,
+//    "heap_delta_per_scan":F,"min_free_heap":N,
+//    "i2c":{"occupancy":F,"nfc":{"transactions":N,"busy_ms":N,"wait_ms":N},"oled":{...}}}
+// Latency runs from the PN532 IRQ edge to the end of the OLED push that shows the
+// scan. Heap is tracked as the free-heap change across each scan batch.
+#ifdef PERF_METRICS
+#define PERF_LATENCY_SAMPLES        128     // Most recent scans kept for the percentiles
+
+uint16_t perfLatencyMs[PERF_LATENCY_SAMPLES];
+uint16_t perfLatencyHead = 0;
+uint16_t perfLatencyCount = 0;
+uint32_t perfScanCount = 0;
+uint32_t perfOledBytes = 0;        // Every OLED push, UI task only
+uint32_t perfScanOledBytes = 0;    // Pushed while handling scans
+int32_t perfScanHeapDelta = 0;
+unsigned long perfFirstScanAt = 0;
+unsigned long perfLastScanAt = 0;
+// Scan batch being handled, see perfScanBatchBegin()
+unsigned long perfBatchDetectedAt[NFC_EVENT_QUEUE_SIZE];
+uint8_t perfBatchCount = 0;
+uint32_t perfBatchOledBytes = 0;
+uint32_t perfBatchFreeHeap = 0;
+
+void perfCountOledBytes(uint16_t bytes) {
+  perfOledBytes += bytes;
+}
+
+void perfSessionReset() {
+  i2cBusResetStats();
+  perfLatencyHead = 0;
+  perfLatencyCount = 0;
+  perfScanCount = 0;
+  perfScanOledBytes = 0;
+  perfScanHeapDelta = 0;
+  perfFirstScanAt = 0;
+  perfLastScanAt = 0;
+}
+
+void perfScanBatchBegin() {
+  perfBatchCount = 0;
+  perfBatchOledBytes = perfOledBytes;
+  perfBatchFreeHeap = ESP.getFreeHeap();
+}
+
+void perfScanSeen(unsigned long detectedAt) {
+  if (perfBatchCount < NFC_EVENT_QUEUE_SIZE) {
+    perfBatchDetectedAt[perfBatchCount++] = detectedAt;
+  }
+}
+
+// After the screen showing the batch has been pushed.
+void perfScanBatchEnd() {
+  if (perfBatchCount == 0) {
+    return;
+  }
+  unsigned long now = millis();
+  for (uint8_t i = 0; i < perfBatchCount; i++) {
+    unsigned long latency = now - perfBatchDetectedAt[i];
+    perfLatencyMs[perfLatencyHead] = latency > UINT16_MAX ? UINT16_MAX : latency;
+    perfLatencyHead = (perfLatencyHead + 1) % PERF_LATENCY_SAMPLES;
+    if (perfLatencyCount < PERF_LATENCY_SAMPLES) {
+      perfLatencyCount++;
+    }
+  }
+  perfScanCount += perfBatchCount;
+  perfScanOledBytes += perfOledBytes - perfBatchOledBytes;
+  perfScanHeapDelta += (int32_t)ESP.getFreeHeap() - (int32_t)perfBatchFreeHeap;
+  if (perfFirstScanAt == 0) {
+    perfFirstScanAt = perfBatchDetectedAt[0];
+  }
+  perfLastScanAt = now;
+}
+
+uint16_t perfLatencyPercentile(const uint16_t* sorted, uint16_t count, uint8_t percent) {
+  return sorted[(count - 1) * percent / 100];
+}
+
+void perfReportSession(uint16_t itemsFound) {
+  uint16_t sorted[PERF_LATENCY_SAMPLES];
+  uint16_t count = perfLatencyCount;
+  memcpy(sorted, perfLatencyMs, count * sizeof(uint16_t));
+  for (uint16_t i = 1; i < count; i++) { // Insertion sort, a few dozen samples
+    uint16_t value = sorted[i];
+    uint16_t j = i;
+    while (j > 0 && sorted[j - 1] > value) {
+      sorted[j] = sorted[j - 1];
+      j--;
+    }
+    sorted[j] = value;
+  }
+
+  JsonDocument report;
+  report["metric"] = "repack_session";
+  report["scans"] = perfScanCount;
+  report["items"] = itemsFound;
+  unsigned long spanMs = perfLastScanAt - perfFirstScanAt;
+  report["items_per_min"] = (spanMs > 0) ? itemsFound * 60000.0f / spanMs : 0.0f;
+  JsonObject latency = report["latency_ms"].to<JsonObject>();
+  latency["p50"] = count > 0 ? perfLatencyPercentile(sorted, count, 50) : 0;
+  latency["p99"] = count > 0 ? perfLatencyPercentile(sorted, count, 99) : 0;
+  latency["max"] = count > 0 ? sorted[count - 1] : 0;
+  report["oled_bytes_per_scan"] = perfScanCount > 0 ? (float)perfScanOledBytes / perfScanCount : 0.0f;
+  report["heap_delta_per_scan"] = perfScanCount > 0 ? (float)perfScanHeapDelta / perfScanCount : 0.0f;
+  report["min_free_heap"] = ESP.getMinFreeHeap();
+  i2cBusWriteStats(report["i2c"].to<JsonObject>());
+  serializeJson(report, Serial);
+  Serial.println();
+}
+#else
+inline void perfCountOledBytes(uint16_t) {}
+inline void perfSessionReset() {}
+inline void perfScanBatchBegin() {}
+inline void perfScanSeen(unsigned long) {}
+inline void perfScanBatchEnd() {}
+inline void perfReportSession(uint16_t) {}
+#endif
+
 //==============================================================================
 // OLED HELPER FUNCTIONS
 //==============================================================================
@@ -96,8 +402,36 @@ void oledClear() {
   display.clearDisplay();
 }
 
+void oledToastService();
+
+// Pushes the changed parts of the framebuffer, one page per bus transaction so a
+// waiting PN532 exchange gets the bus in between (see I2C BUS SCHEDULER).
+void oledPush() {
+  uint16_t bytesSent = 0;
+  if (!display.partialReady()) {
+    i2cBusAcquire(I2C_CLIENT_OLED);
+    bytesSent = display.displayPartial(); // First frame after begin() goes out whole
+    i2cBusRelease();
+  } else {
+    for (uint8_t page = 0; page < (SCREEN_HEIGHT + 7) / 8; page++) {
+      i2cBusAcquire(I2C_CLIENT_OLED);
+      bytesSent += display.displayPartialPage(page);
+      i2cBusRelease();
+    }
+  }
+  perfCountOledBytes(bytesSent);
+}
+
+// Only the page/column windows that differ from what the panel shows go over I2C,
+// so a counter update no longer costs a full 1 KB frame on the bus shared with the PN532.
+// While a toast is on screen the state's screen is kept in the buffer only; the state
+// redraws once the last toast has expired (redrawOled).
 void oledShow() {
-  display.display();
+  oledToastService(); // Also retires toasts during long blocking operations
+  if (toastActive) {
+    return;
+  }
+  oledPush();
 }
 
 void oledPrint(int x, int y, const String& text, int size = 1, bool wrap = true) {
@@ -135,7 +469,7 @@ void oledDisplayMenu(const String& title, const String items[], int itemCount, i
   oledShow();
 }
 
-void oledShowStatusMessage(const String& line1, const String& line2 = "", const String& line3 = "", bool persistent = false, int customDuration = 0) {
+void oledDrawStatusLines(const String& line1, const String& line2, const String& line3) {
   oledClear();
   oledPrint(0, 0, line1, 1, true);
   if (!line2.isEmpty()) {
@@ -144,10 +478,102 @@ void oledShowStatusMessage(const String& line1, const String& line2 = "", const
   if (!line3.isEmpty()) {
     oledPrint(0, 28, line3, 1, true); // Adjusted Y for bicolor display
   }
-  oledShow();
+}
+
+bool onUiTask() {
+  return uiTaskHandle == NULL || xTaskGetCurrentTaskHandle() == uiTaskHandle;
+}
+
+// loop() sleeps between passes until one of these wakes it: a button edge, a tag
+// event, a network result or a toast from a background task.
+void wakeUiTask() {
+  if (uiTaskHandle != NULL) {
+    xTaskNotifyGive(uiTaskHandle);
+  }
+}
+
+// State handlers with a timeout report when it expires, every pass, so the idle
+// scheduler (uiIdleWait) knows how long the CPU may sleep. Reset before each pass.
+bool uiHasDeadline = false;
+unsigned long uiDeadline = 0;
+
+void uiWakeBy(unsigned long at) {
+  if (!uiHasDeadline || (long)(at - uiDeadline) < 0) {
+    uiDeadline = at;
+    uiHasDeadline = true;
+  }
+}
+
+// Called every loop() pass (and from oledShow). Expires the toast on screen, shows
+// the next queued one, and hands the panel back to the current state when done.
+// UI task only: it is the one drawing into the framebuffer.
+void oledToastService() {
+  OledToast toast;
+
+  portENTER_CRITICAL(&toastMux);
+  if (toastActive) {
+    uint16_t limit = toastDurationMs;
+    if (toastCount > 0 && limit > TOAST_MIN_DURATION_MS) {
+      limit = TOAST_MIN_DURATION_MS; // Someone is waiting, keep back-to-back scans flowing
+    }
+    if ((millis() - toastShownAt) < limit) {
+      portEXIT_CRITICAL(&toastMux);
+      return;
+    }
+    toastActive = false;
+    if (toastCount == 0) {
+      portEXIT_CRITICAL(&toastMux);
+      redrawOled = true; // The state's screen was hidden (or clobbered) by the toast
+      return;
+    }
+  }
+  if (toastCount == 0) {
+    portEXIT_CRITICAL(&toastMux);
+    return;
+  }
+  toast = toastQueue[toastHead];
+  toastHead = (toastHead + 1) % TOAST_QUEUE_SIZE;
+  toastCount--;
+  toastDurationMs = toast.durationMs;
+  toastShownAt = millis();
+  toastActive = true;
+  portEXIT_CRITICAL(&toastMux);
+
+  oledDrawStatusLines(toast.lines[0], toast.lines[1], toast.lines[2]);
+  oledPush();
+}
+
+// Persistent messages are the current state's screen. Others are queued as toasts
+// shown for customDuration (or STATUS_MESSAGE_DURATION_MS) without blocking.
+// Called from a background task, every message becomes a toast: only the UI task
+// draws, it picks the toast up on its next pass.
+void oledShowStatusMessage(const String& line1, const String& line2 = "", const String& line3 = "", bool persistent = false, int customDuration = 0) {
+  bool uiTask = onUiTask();
+  if (persistent && uiTask) {
+    oledDrawStatusLines(line1, line2, line3);
+    oledShow();
+    return;
+  }
+
+  OledToast newToast;
+  strlcpy(newToast.lines[0], line1.c_str(), TOAST_LINE_LENGTH);
+  strlcpy(newToast.lines[1], line2.c_str(), TOAST_LINE_LENGTH);
+  strlcpy(newToast.lines[2], line3.c_str(), TOAST_LINE_LENGTH);
+  newToast.durationMs = customDuration > 0 ? customDuration : STATUS_MESSAGE_DURATION_MS;
 
-  if (!persistent) {
-    delay(customDuration > 0 ? customDuration : STATUS_MESSAGE_DURATION_MS);
+  portENTER_CRITICAL(&toastMux);
+  if (toastCount == TOAST_QUEUE_SIZE) { // Full: drop the oldest waiting toast
+    toastHead = (toastHead + 1) % TOAST_QUEUE_SIZE;
+    toastCount--;
+  }
+  toastQueue[(toastHead + toastCount) % TOAST_QUEUE_SIZE] = newToast;
+  toastCount++;
+  portEXIT_CRITICAL(&toastMux);
+
+  if (uiTask) {
+    oledToastService(); // Shows it right away if nothing else is on screen
+  } else {
+    wakeUiTask();
   }
 }
 
@@ -164,62 +590,176 @@ void oledShowScanPrompt(const String& promptLine1, const String& promptLine2 = "
 //==============================================================================
 // BUTTON HANDLING
 //==============================================================================
-void setupButtons() {
-  for (int i = 0; i < 32; i++) {
-    buttonState[i] = LOW;
-    lastButtonState[i] = LOW;
-    lastDebounceTime[i] = 0;
-  }
-  pinMode(BUTTON_A_PIN, INPUT);
-  pinMode(BUTTON_B_PIN, INPUT);
-  pinMode(BUTTON_C_PIN, INPUT);
-  Serial.println("Buttons Initialized (assuming external PULL-DOWN resistors).");
+// Every edge on a button pin raises an interrupt. The ISR debounces against the
+// edge timestamps and posts each press to a single-producer/single-consumer ring,
+// the UI task drains it once per loop() pass (buttonsPoll) into a press mask that
+// the state handlers consume with isButtonPressed(). A press is seen exactly once,
+// whichever handler asks first, and the pins are never polled.
+#define BUTTON_COUNT                3
+#define BUTTON_EVENT_QUEUE_SIZE     16      // Power of two, indices wrap freely
+const uint8_t buttonPins[BUTTON_COUNT] = { BUTTON_A_PIN, BUTTON_B_PIN, BUTTON_C_PIN };
+
+struct ButtonEvent {
+  uint8_t button;           // Index into buttonPins
+  unsigned long pressedAt;  // millis() of the debounced rising edge
+};
+ButtonEvent buttonEvents[BUTTON_EVENT_QUEUE_SIZE];
+volatile uint8_t buttonEventHead = 0;  // Written by the ISR only
+volatile uint8_t buttonEventTail = 0;  // Written by the UI task only
+// ISR side debounce state
+volatile unsigned long buttonLastPressAt[BUTTON_COUNT];
+volatile unsigned long buttonLastReleaseAt[BUTTON_COUNT];
+// UI task side: presses drained this pass, not consumed yet
+uint8_t buttonPressedMask = 0;
+
+// A rising edge is a press unless the button bounced (released or pressed) within
+// DEBOUNCE_DELAY_MS. Falling edges only move the release timestamp.
+// Producer side of the ring: the button ISRs, or the light sleep wake-up while those
+// are disabled. True if a press was posted.
+bool IRAM_ATTR buttonRecordPress(uint8_t button, unsigned long now) {
+  if ((now - buttonLastReleaseAt[button]) < DEBOUNCE_DELAY_MS ||
+      (now - buttonLastPressAt[button]) < DEBOUNCE_DELAY_MS) {
+    return false;
+  }
+  buttonLastPressAt[button] = now;
+
+  uint8_t head = buttonEventHead;
+  if ((uint8_t)(head - buttonEventTail) >= BUTTON_EVENT_QUEUE_SIZE) {
+    return false; // Full, the UI task is far behind; drop the press
+  }
+  buttonEvents[head % BUTTON_EVENT_QUEUE_SIZE] = { button, now };
+  __sync_synchronize(); // Event contents visible before the new head
+  buttonEventHead = head + 1;
+  return true;
 }
 
-// Checks if a button is pressed and debounced. Updates lastActivityTime.
-bool isButtonPressed(int pin) {
-  if (pin < 0 || pin >= 32) {
-    return false;
+void IRAM_ATTR buttonEdgeFromIsr(uint8_t button) {
+  unsigned long now = millis();
+  if (digitalRead(buttonPins[button]) != HIGH) { // Assumes buttons go HIGH when pressed
+    buttonLastReleaseAt[button] = now;
+    return;
   }
+  if (buttonRecordPress(button, now) && uiTaskHandle != NULL) {
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(uiTaskHandle, &higherPriorityTaskWoken);
+    portYIELD_FROM_ISR(higherPriorityTaskWoken);
+  }
+}
 
-  bool triggered = false;
-  int reading = digitalRead(pin);
+void IRAM_ATTR onButtonAEdge() { buttonEdgeFromIsr(0); }
+void IRAM_ATTR onButtonBEdge() { buttonEdgeFromIsr(1); }
+void IRAM_ATTR onButtonCEdge() { buttonEdgeFromIsr(2); }
 
-  if (reading != lastButtonState[pin]) {
-    lastDebounceTime[pin] = millis();
+void setupButtons() {
+  void (*handlers[BUTTON_COUNT])() = { onButtonAEdge, onButtonBEdge, onButtonCEdge };
+  unsigned long now = millis();
+  for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+    buttonLastPressAt[i] = now - DEBOUNCE_DELAY_MS;
+    buttonLastReleaseAt[i] = now - DEBOUNCE_DELAY_MS;
+    pinMode(buttonPins[i], INPUT);
+    attachInterrupt(digitalPinToInterrupt(buttonPins[i]), handlers[i], CHANGE);
   }
+  Serial.println("Buttons Initialized (assuming external PULL-DOWN resistors).");
+}
 
-  if ((millis() - lastDebounceTime[pin]) > debounceDelay) {
-    if (reading != buttonState[pin]) {
-      buttonState[pin] = reading;
-      if (buttonState[pin] == HIGH) { // Assumes buttons go HIGH when pressed
-        triggered = true;
-        Serial.printf("\nDEBUG: Button Pressed & Debounced (Pin %d went HIGH)\n", pin);
-        lastActivityTime = millis(); // Reset inactivity timer on any confirmed button press
-      }
+// Once per loop() pass, before the state handler runs. Presses left unconsumed by
+// the previous pass are dropped so they cannot leak into another state. A second
+// press of the same button stays queued for the next pass.
+void buttonsPoll() {
+  buttonPressedMask = 0;
+  uint8_t tail = buttonEventTail;
+  while (tail != buttonEventHead) {
+    __sync_synchronize(); // Read the event only after seeing the head that published it
+    const ButtonEvent& event = buttonEvents[tail % BUTTON_EVENT_QUEUE_SIZE];
+    uint8_t bit = 1 << event.button;
+    if (buttonPressedMask & bit) {
+      break;
+    }
+    buttonPressedMask |= bit;
+#ifdef DEBUG_BUTTONS
+    Serial.printf("\nDEBUG: Button Pressed & Debounced (Pin %d, %lu ms ago)\n",
+                  buttonPins[event.button], millis() - event.pressedAt);
+#endif
+    lastActivityTime = millis(); // Reset inactivity timer on any confirmed button press
+    tail++;
+  }
+  buttonEventTail = tail;
+}
+
+// True once per press: the first handler asking for 'pin' this pass consumes it.
+bool isButtonPressed(int pin) {
+  for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+    if (buttonPins[i] == pin) {
+      bool pressed = buttonPressedMask & (1 << i);
+      buttonPressedMask &= ~(1 << i);
+      return pressed;
     }
   }
-  lastButtonState[pin] = reading;
-  return triggered;
+  return false;
 }
 
 //==============================================================================
 // UID AND STRING HELPERS
 //==============================================================================
-String uidBytesToHexString(const uint8_t* uid, uint8_t uidLength) {
-  String hexString = "";
+// Writes the uppercase hex form of a UID into outHex (UID_HEX_BUFFER_SIZE bytes).
+void uidBytesToHex(const uint8_t* uid, uint8_t uidLength, char* outHex) {
+  static const char hexChars[] = "0123456789ABCDEF";
+  if (uidLength > UID_MAX_LENGTH) {
+    uidLength = UID_MAX_LENGTH;
+  }
   for (uint8_t i = 0; i < uidLength; i++) {
-    if (uid[i] < 0x10) {
-      hexString += "0";
+    outHex[i * 2] = hexChars[uid[i] >> 4];
+    outHex[i * 2 + 1] = hexChars[uid[i] & 0x0F];
+  }
+  outHex[uidLength * 2] = '\0';
+}
+
+String uidBytesToHexString(const uint8_t* uid, uint8_t uidLength) {
+  char hexBuffer[UID_HEX_BUFFER_SIZE];
+  uidBytesToHex(uid, uidLength, hexBuffer);
+  return String(hexBuffer);
+}
+
+// Parses a stored hex UID ("04A1B2C3D4E580", case and ':'/' ' separators ignored).
+bool uidKeyFromHex(const char* uidHex, size_t uidHexLength, UidKey& outKey) {
+  uint8_t nibbleCount = 0;
+  outKey.length = 0;
+  memset(outKey.bytes, 0, sizeof(outKey.bytes));
+
+  for (size_t i = 0; i < uidHexLength; i++) {
+    char c = uidHex[i];
+    uint8_t nibble;
+    if (c >= '0' && c <= '9') {
+      nibble = c - '0';
+    } else if (c >= 'A' && c <= 'F') {
+      nibble = c - 'A' + 10;
+    } else if (c >= 'a' && c <= 'f') {
+      nibble = c - 'a' + 10;
+    } else if (c == ':' || c == ' ') {
+      continue;
+    } else {
+      return false;
     }
-    hexString += String(uid[i], HEX);
+    if (nibbleCount >= UID_MAX_LENGTH * 2) {
+      return false; // Longer than any ISO14443A UID
+    }
+    outKey.bytes[nibbleCount / 2] = (outKey.bytes[nibbleCount / 2] << 4) | nibble;
+    nibbleCount++;
+  }
+
+  if (nibbleCount == 0 || (nibbleCount % 2) != 0) {
+    return false;
   }
-  hexString.toUpperCase();
-  return hexString;
+  outKey.length = nibbleCount / 2;
+  return true;
 }
 
-bool compareUidStrings(const String& uidStr1, const String& uidStr2) {
-  return uidStr1.equalsIgnoreCase(uidStr2);
+// Orders keys by length first, then bytes, so lookups never need the hex form.
+int compareUidKeys(const UidKey& a, const UidKey& b) {
+  if (a.length != b.length) {
+    return (a.length < b.length) ? -1 : 1;
+  }
+  return memcmp(a.bytes, b.bytes, a.length);
 }
 
 String urlEncode(const String& str) {
@@ -241,122 +781,710 @@ String urlEncode(const String& str) {
 }
 
 //==============================================================================
-// SPIFFS (FILE SYSTEM) OPERATIONS
+// EQUIPMENT TABLE
 //==============================================================================
-bool saveListToSPIFFS() {
-  Serial.println("Saving equipment list to SPIFFS...");
-  File file = SPIFFS.open(EQUIPMENT_LIST_FILE, FILE_WRITE);
-  if (!file) {
-    Serial.println("Failed to open equipment list file for writing!");
-    return false;
-  }
-  for (int i = 0; i < currentMaxItems; i++) {
-    file.println(currentExpectedUIDStrings[i] + "," + currentExpectedItemNames[i]);
+#define BITSET_WORDS(bits)          (((bits) + 31) / 32)
+
+bool bitsetTest(const uint32_t* bits, uint16_t i) {
+  return (bits[i >> 5] >> (i & 31)) & 1;
+}
+
+void bitsetSet(uint32_t* bits, uint16_t i) {
+  bits[i >> 5] |= (1UL << (i & 31));
+}
+
+void bitsetClearAll(uint32_t* bits, uint16_t count) {
+  memset(bits, 0, BITSET_WORDS(count) * sizeof(uint32_t));
+}
+
+// Sets bits [0, count). Bits past count stay clear so popcounts stay exact.
+void bitsetSetAll(uint32_t* bits, uint16_t count) {
+  bitsetClearAll(bits, count);
+  memset(bits, 0xFF, (count / 32) * sizeof(uint32_t));
+  if (count % 32) {
+    bits[count / 32] = (1UL << (count % 32)) - 1;
   }
-  file.close();
-  Serial.println("Equipment list saved to SPIFFS.");
-  return true;
 }
 
-bool loadListFromSPIFFS() {
-  if (!SPIFFS.begin(true)) { // Ensure SPIFFS is mounted, true formats if mount failed
-    Serial.println("SPIFFS Mount Failed!");
-    return false;
+void equipmentTableFree(EquipmentTable& table) {
+  free(table.uids);
+  free(table.recordIds);
+  free(table.nameOffsets);
+  free(table.nameArena);
+  free(table.uidOrder);
+  free(table.usedInitially);
+  free(table.foundInRepack);
+  table = EquipmentTable();
+}
+
+// Allocates room for up to 'items' entries and 'nameBytes' of names (terminators
+// included). Any previous contents are dropped.
+bool equipmentTableReserve(EquipmentTable& table, size_t items, size_t nameBytes) {
+  equipmentTableFree(table);
+  if (items > MAX_EXPECTED_ITEMS) {
+    Serial.printf("Equipment list has %u entries, only the first %d are kept.\n", (unsigned)items, MAX_EXPECTED_ITEMS);
+    items = MAX_EXPECTED_ITEMS;
   }
-  Serial.println("Loading equipment list from SPIFFS...");
-  File file = SPIFFS.open(EQUIPMENT_LIST_FILE, FILE_READ);
-  if (!file || file.isDirectory()) {
-    Serial.println("Failed to open equipment list file for reading or file not found.");
-    currentMaxItems = 0; // Ensure list is empty if file not found
-    return false;
+  if (nameBytes > UINT16_MAX) {
+    nameBytes = UINT16_MAX;
+  }
+  if (items == 0) {
+    return true;
   }
 
-  currentMaxItems = 0; // Reset before loading
-  while (file.available() && currentMaxItems < MAX_EXPECTED_ITEMS) {
-    String line = file.readStringUntil('\n');
-    line.trim();
-    if (line.length() > 0) {
-      int commaIndex = line.indexOf(',');
-      if (commaIndex > 0 && commaIndex < (int)line.length() - 1) {
-        currentExpectedUIDStrings[currentMaxItems] = line.substring(0, commaIndex);
-        currentExpectedItemNames[currentMaxItems] = line.substring(commaIndex + 1);
-        currentMaxItems++;
-      } else {
-        Serial.println("Malformed line in equipment list file: " + line);
-      }
-    }
+  table.uids = (UidKey*)malloc(items * sizeof(UidKey));
+  table.recordIds = (AirtableRecordId*)malloc(items * sizeof(AirtableRecordId));
+  table.nameOffsets = (uint16_t*)malloc(items * sizeof(uint16_t));
+  table.nameArena = (char*)malloc(nameBytes > 0 ? nameBytes : 1);
+  table.uidOrder = (uint16_t*)malloc(items * sizeof(uint16_t));
+  table.usedInitially = (uint32_t*)calloc(BITSET_WORDS(items), sizeof(uint32_t));
+  table.foundInRepack = (uint32_t*)calloc(BITSET_WORDS(items), sizeof(uint32_t));
+  if (!table.uids || !table.recordIds || !table.nameOffsets || !table.nameArena || !table.uidOrder ||
+      !table.usedInitially || !table.foundInRepack) {
+    Serial.printf("Out of memory for %u equipment items!\n", (unsigned)items);
+    equipmentTableFree(table);
+    return false;
   }
-  file.close();
-  Serial.printf("Loaded %d items from SPIFFS.\n", currentMaxItems);
+  table.capacity = items;
+  table.arenaCapacity = nameBytes;
   return true;
 }
 
-//==============================================================================
-// BAG CONFIGURATION (SPIFFS)
-//==============================================================================
-bool saveCurrentBagID(const String& bagID, const String& bagName) {
-  Serial.printf("Saving current bag config to SPIFFS: ID=%s, Name=%s\n", bagID.c_str(), bagName.c_str());
-  File file = SPIFFS.open(BAG_CONFIG_FILE, FILE_WRITE);
-  if (!file) {
-    Serial.println("Failed to open bag config file for writing!");
+// recordId may be NULL or empty when the Airtable record id is not known.
+bool equipmentTableAdd(EquipmentTable& table, const char* uidHex, size_t uidHexLength,
+                       const char* name, size_t nameLength, const char* recordId = nullptr) {
+  if (table.count >= table.capacity) {
     return false;
   }
-  file.println(bagID);    // Line 1: Bag Record ID
-  file.println(bagName);  // Line 2: Bag Name (for display)
-  file.close();
-  currentAssignedBagID = bagID; // Update global variable
-  currentAssignedBagName = bagName;
-  Serial.println("Bag config saved to SPIFFS.");
+  UidKey key;
+  if (!uidKeyFromHex(uidHex, uidHexLength, key)) {
+    Serial.printf("Invalid UID '%.*s' in equipment list, item skipped.\n", (int)uidHexLength, uidHex);
+    return false;
+  }
+  if ((size_t)table.arenaUsed + nameLength + 1 > table.arenaCapacity) {
+    Serial.println("Equipment name arena full, item skipped.");
+    return false;
+  }
+
+  table.uids[table.count] = key;
+  strlcpy(table.recordIds[table.count].id, recordId ? recordId : "", sizeof(table.recordIds[table.count].id));
+  table.nameOffsets[table.count] = table.arenaUsed;
+  memcpy(table.nameArena + table.arenaUsed, name, nameLength);
+  table.nameArena[table.arenaUsed + nameLength] = '\0';
+  table.arenaUsed += nameLength + 1;
+  table.count++;
   return true;
 }
 
-bool loadCurrentBagID() {
-  if (!SPIFFS.exists(BAG_CONFIG_FILE)) {
-    Serial.println("Bag config file not found. No active bag set.");
-    currentAssignedBagID = "";
-    currentAssignedBagName = "";
-    return false;
+// Makes room for one more item with a name of 'nameLength' bytes, growing the arrays
+// and the name arena geometrically. For lists whose size is not known up front
+// (streamed Airtable responses); equipmentTableFinalize() trims the arena afterwards.
+bool equipmentTableEnsureRoom(EquipmentTable& table, size_t nameLength) {
+  if (table.count >= table.capacity) {
+    if (table.capacity >= MAX_EXPECTED_ITEMS) {
+      return false;
+    }
+    size_t items = table.capacity > 0 ? table.capacity * 2 : 16;
+    if (items > MAX_EXPECTED_ITEMS) {
+      items = MAX_EXPECTED_ITEMS;
+    }
+    size_t oldWords = BITSET_WORDS(table.capacity);
+    size_t newWords = BITSET_WORDS(items);
+
+    UidKey* uids = (UidKey*)realloc(table.uids, items * sizeof(UidKey));
+    if (uids) table.uids = uids;
+    AirtableRecordId* recordIds = (AirtableRecordId*)realloc(table.recordIds, items * sizeof(AirtableRecordId));
+    if (recordIds) table.recordIds = recordIds;
+    uint16_t* nameOffsets = (uint16_t*)realloc(table.nameOffsets, items * sizeof(uint16_t));
+    if (nameOffsets) table.nameOffsets = nameOffsets;
+    uint16_t* uidOrder = (uint16_t*)realloc(table.uidOrder, items * sizeof(uint16_t));
+    if (uidOrder) table.uidOrder = uidOrder;
+    uint32_t* usedInitially = (uint32_t*)realloc(table.usedInitially, newWords * sizeof(uint32_t));
+    if (usedInitially) table.usedInitially = usedInitially;
+    uint32_t* foundInRepack = (uint32_t*)realloc(table.foundInRepack, newWords * sizeof(uint32_t));
+    if (foundInRepack) table.foundInRepack = foundInRepack;
+    if (!uids || !recordIds || !nameOffsets || !uidOrder || !usedInitially || !foundInRepack) {
+      Serial.printf("Out of memory growing equipment list to %u items!\n", (unsigned)items);
+      return false; // Table stays valid at its old capacity
+    }
+    memset(table.usedInitially + oldWords, 0, (newWords - oldWords) * sizeof(uint32_t));
+    memset(table.foundInRepack + oldWords, 0, (newWords - oldWords) * sizeof(uint32_t));
+    table.capacity = items;
   }
 
-  File file = SPIFFS.open(BAG_CONFIG_FILE, FILE_READ);
-  if (!file) {
-    Serial.println("Failed to open bag config file for reading!");
-    currentAssignedBagID = "";
-    currentAssignedBagName = "";
-    return false;
+  size_t needed = (size_t)table.arenaUsed + nameLength + 1;
+  if (needed > table.arenaCapacity) {
+    if (needed > UINT16_MAX) {
+      Serial.println("Equipment name arena full, item skipped.");
+      return false;
+    }
+    size_t bytes = table.arenaCapacity > 0 ? table.arenaCapacity * 2 : 256;
+    while (bytes < needed) {
+      bytes *= 2;
+    }
+    if (bytes > UINT16_MAX) {
+      bytes = UINT16_MAX;
+    }
+    char* arena = (char*)realloc(table.nameArena, bytes);
+    if (!arena) {
+      Serial.println("Out of memory growing equipment name arena!");
+      return false;
+    }
+    table.nameArena = arena;
+    table.arenaCapacity = bytes;
   }
+  return true;
+}
 
-  if (file.available()) {
-    currentAssignedBagID = file.readStringUntil('\n');
-    currentAssignedBagID.trim();
-  } else {
-    currentAssignedBagID = "";
+const EquipmentTable* uidSortTable = nullptr; // qsort() has no context argument
+
+int compareUidOrder(const void* a, const void* b) {
+  return compareUidKeys(uidSortTable->uids[*(const uint16_t*)a], uidSortTable->uids[*(const uint16_t*)b]);
+}
+
+// Sorts the UID index. Call once the table has been filled.
+void buildUidIndex(EquipmentTable& table) {
+  for (uint16_t i = 0; i < table.count; i++) {
+    table.uidOrder[i] = i;
   }
-  
-  if (file.available()) {
-    currentAssignedBagName = file.readStringUntil('\n');
-    currentAssignedBagName.trim();
-  } else {
-    currentAssignedBagName = ""; // If name wasn't saved or file is old format
+  uidSortTable = &table;
+  qsort(table.uidOrder, table.count, sizeof(uint16_t), compareUidOrder);
+  uidSortTable = nullptr;
+}
+
+// Gives back the unused part of the name arena and builds the UID index.
+void equipmentTableFinalize(EquipmentTable& table) {
+  if (table.nameArena && table.arenaUsed > 0 && table.arenaUsed < table.arenaCapacity) {
+    char* shrunk = (char*)realloc(table.nameArena, table.arenaUsed);
+    if (shrunk) {
+      table.nameArena = shrunk;
+      table.arenaCapacity = table.arenaUsed;
+    }
   }
-  
-  file.close();
+  buildUidIndex(table);
+}
 
-  if (!currentAssignedBagID.isEmpty()) {
-    Serial.printf("Loaded active bag from SPIFFS: ID=%s, Name=%s\n", currentAssignedBagID.c_str(), currentAssignedBagName.c_str());
-    return true;
-  } else {
-    Serial.println("No active bag ID found in config file.");
-    currentAssignedBagName = ""; // Ensure name is also cleared if ID is missing
-    return false;
+const char* equipmentName(uint16_t i) {
+  return equipment.nameArena + equipment.nameOffsets[i];
+}
+
+void equipmentUidHex(uint16_t i, char* outHex) {
+  uidBytesToHex(equipment.uids[i].bytes, equipment.uids[i].length, outHex);
+}
+
+// Binary search on raw UID bytes. Returns the item index, or -1 if the UID is not in the list.
+int findItemIndexByUid(const uint8_t* uid, uint8_t uidLength) {
+  if (uidLength == 0 || uidLength > UID_MAX_LENGTH) {
+    return -1;
+  }
+  UidKey key;
+  key.length = uidLength;
+  memcpy(key.bytes, uid, uidLength);
+
+  int low = 0;
+  int high = (int)equipment.count - 1;
+  while (low <= high) {
+    int mid = (low + high) / 2;
+    uint16_t item = equipment.uidOrder[mid];
+    int cmp = compareUidKeys(key, equipment.uids[item]);
+    if (cmp == 0) {
+      return item;
+    } else if (cmp < 0) {
+      high = mid - 1;
+    } else {
+      low = mid + 1;
+    }
   }
+  return -1;
 }
 
 //==============================================================================
-// TIME INITIALIZATION (NTP)
+// SPIFFS (FILE SYSTEM) OPERATIONS
 //==============================================================================
-void initTime() {
-  Serial.println("Configuring time from NTP server...");
+// SPIFFS is mounted on first use, so a wake restored from the RTC snapshot never
+// touches flash. Every file operation below goes through here first.
+SemaphoreHandle_t spiffsMountMutex = NULL;
+bool spiffsMounted = false;
+
+bool ensureSpiffsMounted() {
+  xSemaphoreTake(spiffsMountMutex, portMAX_DELAY);
+  if (!spiffsMounted) {
+    spiffsMounted = SPIFFS.begin(true); // true formats if mount failed
+    if (!spiffsMounted) {
+      Serial.println("SPIFFS Mount Failed!");
+    }
+  }
+  xSemaphoreGive(spiffsMountMutex);
+  return spiffsMounted;
+}
+
+// The equipment list is cached as a versioned binary image of the table, loaded
+// with one bulk read per array straight into freshly reserved memory:
+//   EquipmentCacheHeader
+//   UidKey uids[count] | AirtableRecordId recordIds[count] | uint16_t nameOffsets[count]
+//   uint16_t uidOrder[count] | char nameArena[arenaBytes]
+// The CRC32 covers everything after the header. A missing, foreign or corrupt
+// image is ignored and the list is fetched again.
+#define EQUIPMENT_CACHE_MAGIC       0x51454747UL // "GGEQ"
+#define EQUIPMENT_CACHE_VERSION     1            // Bump when the table layout changes
+struct EquipmentCacheHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t count;
+  uint16_t arenaBytes;
+  uint16_t reserved;
+  uint32_t crc;
+};
+
+// True while the cache file holds exactly the list in memory. The sync stamp only
+// describes such a cache, so it is dropped whenever this turns false. Kept in RTC
+// memory so it still holds for a list restored from the snapshot after deep sleep.
+RTC_DATA_ATTR bool equipmentCacheCurrent = false;
+
+// Forgets when the list was last synced: the next fetch downloads everything.
+void discardEquipmentSyncStamp() {
+  equipmentCacheCurrent = false;
+  SPIFFS.remove(EQUIPMENT_SYNC_FILE);
+}
+
+uint32_t crc32Update(uint32_t crc, const void* data, size_t length) {
+  return crc32_le(crc, (const uint8_t*)data, length);
+}
+
+// Writes the table to a temp file and renames it over the cache, so a power cut
+// mid-write leaves the previous cache intact.
+bool saveListToSPIFFS() {
+  if (!ensureSpiffsMounted()) {
+    equipmentCacheCurrent = false;
+    return false;
+  }
+  Serial.println("Saving equipment list to SPIFFS...");
+  File file = SPIFFS.open(EQUIPMENT_LIST_TEMP_FILE, FILE_WRITE);
+  if (!file) {
+    Serial.println("Failed to open equipment list file for writing!");
+    discardEquipmentSyncStamp(); // The old cache no longer matches the list
+    return false;
+  }
+
+  uint16_t count = equipment.count;
+  EquipmentCacheHeader header = {};
+  header.magic = EQUIPMENT_CACHE_MAGIC;
+  header.version = EQUIPMENT_CACHE_VERSION;
+  header.count = count;
+  header.arenaBytes = equipment.arenaUsed;
+  const void* sections[] = { equipment.uids, equipment.recordIds, equipment.nameOffsets, equipment.uidOrder, equipment.nameArena };
+  const size_t sectionSizes[] = { count * sizeof(UidKey), count * sizeof(AirtableRecordId), count * sizeof(uint16_t),
+                                  count * sizeof(uint16_t), equipment.arenaUsed };
+  for (size_t i = 0; i < 5; i++) {
+    if (sectionSizes[i] > 0) {
+      header.crc = crc32Update(header.crc, sections[i], sectionSizes[i]);
+    }
+  }
+
+  bool written = file.write((const uint8_t*)&header, sizeof(header)) == sizeof(header);
+  for (size_t i = 0; i < 5 && written; i++) {
+    if (sectionSizes[i] > 0) {
+      written = file.write((const uint8_t*)sections[i], sectionSizes[i]) == sectionSizes[i];
+    }
+  }
+  file.close();
+  if (!written) {
+    Serial.println("Writing the equipment list cache failed!");
+    SPIFFS.remove(EQUIPMENT_LIST_TEMP_FILE);
+    discardEquipmentSyncStamp();
+    return false;
+  }
+  SPIFFS.remove(EQUIPMENT_LIST_FILE);
+  if (!SPIFFS.rename(EQUIPMENT_LIST_TEMP_FILE, EQUIPMENT_LIST_FILE)) {
+    Serial.println("Failed to replace the equipment list cache!");
+    discardEquipmentSyncStamp();
+    return false;
+  }
+  equipmentCacheCurrent = true;
+  Serial.printf("Equipment list saved to SPIFFS (%u items).\n", count);
+  return true;
+}
+
+// Reads one section into 'dest' and folds it into the running CRC.
+bool readCacheSection(File& file, void* dest, size_t length, uint32_t& crc) {
+  if (length == 0) {
+    return true;
+  }
+  if (file.read((uint8_t*)dest, length) != length) {
+    return false;
+  }
+  crc = crc32Update(crc, dest, length);
+  return true;
+}
+
+bool loadBinaryListCache() {
+  File file = SPIFFS.open(EQUIPMENT_LIST_FILE, FILE_READ);
+  if (!file || file.isDirectory()) {
+    return false;
+  }
+  EquipmentCacheHeader header;
+  if (file.read((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+      header.magic != EQUIPMENT_CACHE_MAGIC || header.version != EQUIPMENT_CACHE_VERSION ||
+      header.count > MAX_EXPECTED_ITEMS) {
+    Serial.println("Equipment list cache has an unknown format, ignored.");
+    file.close();
+    return false;
+  }
+  if (!equipmentTableReserve(equipment, header.count, header.arenaBytes)) {
+    file.close();
+    return false;
+  }
+
+  uint16_t count = header.count;
+  uint32_t crc = 0;
+  bool complete = readCacheSection(file, equipment.uids, count * sizeof(UidKey), crc) &&
+                  readCacheSection(file, equipment.recordIds, count * sizeof(AirtableRecordId), crc) &&
+                  readCacheSection(file, equipment.nameOffsets, count * sizeof(uint16_t), crc) &&
+                  readCacheSection(file, equipment.uidOrder, count * sizeof(uint16_t), crc) &&
+                  readCacheSection(file, equipment.nameArena, header.arenaBytes, crc);
+  file.close();
+  if (!complete || crc != header.crc ||
+      (header.arenaBytes > 0 && equipment.nameArena[header.arenaBytes - 1] != '\0')) {
+    Serial.println("Equipment list cache is truncated or corrupt (CRC mismatch), ignored.");
+    equipmentTableFree(equipment);
+    return false;
+  }
+  equipment.count = count;
+  equipment.arenaUsed = header.arenaBytes;
+  return true; // uidOrder was cached sorted, no index rebuild needed
+}
+
+// Lists cached by older firmware as CSV: "UID,recordId,Item Name" or "UID,Item Name".
+// Parsed once, then rewritten in the binary format.
+bool migrateCsvListCache() {
+  File file = SPIFFS.open(EQUIPMENT_LIST_CSV_FILE, FILE_READ);
+  if (!file || file.isDirectory()) {
+    return false;
+  }
+  Serial.println("Migrating CSV equipment list cache to the binary format...");
+
+  // First pass: count lines so the table is sized exactly once. The file size
+  // bounds the name bytes, the surplus is handed back by equipmentTableFinalize().
+  size_t lineCount = 1; // Last line may lack a newline
+  uint8_t chunk[64];
+  size_t chunkLength;
+  while ((chunkLength = file.read(chunk, sizeof(chunk))) > 0) {
+    for (size_t i = 0; i < chunkLength; i++) {
+      if (chunk[i] == '\n') {
+        lineCount++;
+      }
+    }
+  }
+  if (!equipmentTableReserve(equipment, lineCount, file.size())) {
+    file.close();
+    return false;
+  }
+  file.seek(0);
+
+  while (file.available() && equipment.count < equipment.capacity) {
+    String line = file.readStringUntil('\n');
+    line.trim();
+    if (line.length() > 0) {
+      int commaIndex = line.indexOf(',');
+      if (commaIndex > 0 && commaIndex < (int)line.length() - 1) {
+        const char* rest = line.c_str() + commaIndex + 1;
+        char recordId[AIRTABLE_RECORD_ID_LENGTH + 1] = "";
+        if (rest[0] == ',') { // No record id
+          rest++;
+        } else if (strncmp(rest, "rec", 3) == 0 && strlen(rest) > AIRTABLE_RECORD_ID_LENGTH &&
+                   rest[AIRTABLE_RECORD_ID_LENGTH] == ',') {
+          memcpy(recordId, rest, AIRTABLE_RECORD_ID_LENGTH);
+          recordId[AIRTABLE_RECORD_ID_LENGTH] = '\0';
+          rest += AIRTABLE_RECORD_ID_LENGTH + 1;
+        }
+        equipmentTableAdd(equipment, line.c_str(), commaIndex, rest, strlen(rest), recordId);
+      } else {
+        Serial.println("Malformed line in equipment list file: " + line);
+      }
+    }
+  }
+  file.close();
+  equipmentTableFinalize(equipment);
+  if (saveListToSPIFFS()) {
+    SPIFFS.remove(EQUIPMENT_LIST_CSV_FILE);
+  }
+  return true;
+}
+
+bool loadListFromSPIFFS() {
+  if (!ensureSpiffsMounted()) {
+    equipmentCacheCurrent = false;
+    return false;
+  }
+  Serial.println("Loading equipment list from SPIFFS...");
+  if (loadBinaryListCache()) {
+    equipmentCacheCurrent = true;
+  } else if (!migrateCsvListCache()) {
+    Serial.println("Failed to open equipment list file for reading or file not found.");
+    equipmentTableFree(equipment); // Ensure list is empty if file not found
+    discardEquipmentSyncStamp(); // A stamp without its list would turn the next fetch into a lossy delta
+    return false;
+  }
+  Serial.printf("Loaded %d items from SPIFFS.\n", equipment.count);
+  return true;
+}
+
+// True when a non-empty list is loaded and every item knows its Airtable record id,
+// which delta syncs need to match changed records. An empty list can only be
+// rebuilt by a full fetch.
+bool equipmentHasRecordIds() {
+  if (equipment.count == 0) {
+    return false;
+  }
+  for (uint16_t i = 0; i < equipment.count; i++) {
+    if (equipment.recordIds[i].id[0] == '\0') {
+      return false;
+    }
+  }
+  return true;
+}
+
+// When the cached list was last synced, stored next to it as three lines:
+// bag record id, last sync and last full sync (UTC epoch seconds).
+struct EquipmentSyncStamp {
+  String bagID;
+  time_t lastSync = 0;
+  time_t lastFullSync = 0;
+};
+
+bool loadEquipmentSyncStamp(EquipmentSyncStamp& stamp) {
+  if (!ensureSpiffsMounted()) {
+    return false;
+  }
+  File file = SPIFFS.open(EQUIPMENT_SYNC_FILE, FILE_READ);
+  if (!file || file.isDirectory()) {
+    return false;
+  }
+  stamp.bagID = file.readStringUntil('\n');
+  stamp.bagID.trim();
+  stamp.lastSync = (time_t)strtoll(file.readStringUntil('\n').c_str(), nullptr, 10);
+  stamp.lastFullSync = (time_t)strtoll(file.readStringUntil('\n').c_str(), nullptr, 10);
+  file.close();
+  return !stamp.bagID.isEmpty() && stamp.lastSync > 0 && stamp.lastFullSync > 0;
+}
+
+// lastSync is stored EQUIPMENT_SYNC_CLOCK_MARGIN_S early so edits made while the
+// sync ran, or a device clock slightly ahead of Airtable's, are not missed.
+bool saveEquipmentSyncStamp(const EquipmentSyncStamp& stamp) {
+  if (!ensureSpiffsMounted()) {
+    return false;
+  }
+  File file = SPIFFS.open(EQUIPMENT_SYNC_FILE, FILE_WRITE);
+  if (!file) {
+    Serial.println("Failed to open equipment sync file for writing!");
+    return false;
+  }
+  file.printf("%s\n%lld\n%lld\n", stamp.bagID.c_str(),
+              (long long)(stamp.lastSync - EQUIPMENT_SYNC_CLOCK_MARGIN_S), (long long)stamp.lastFullSync);
+  file.close();
+  return true;
+}
+
+//==============================================================================
+// BAG CONFIGURATION (SPIFFS)
+//==============================================================================
+bool saveCurrentBagID(const String& bagID, const String& bagName) {
+  Serial.printf("Saving current bag config to SPIFFS: ID=%s, Name=%s\n", bagID.c_str(), bagName.c_str());
+  if (!ensureSpiffsMounted()) {
+    return false;
+  }
+  File file = SPIFFS.open(BAG_CONFIG_FILE, FILE_WRITE);
+  if (!file) {
+    Serial.println("Failed to open bag config file for writing!");
+    return false;
+  }
+  file.println(bagID);    // Line 1: Bag Record ID
+  file.println(bagName);  // Line 2: Bag Name (for display)
+  file.close();
+  currentAssignedBagID = bagID; // Update global variable
+  currentAssignedBagName = bagName;
+  Serial.println("Bag config saved to SPIFFS.");
+  return true;
+}
+
+bool loadCurrentBagID() {
+  if (!ensureSpiffsMounted() || !SPIFFS.exists(BAG_CONFIG_FILE)) {
+    Serial.println("Bag config file not found. No active bag set.");
+    currentAssignedBagID = "";
+    currentAssignedBagName = "";
+    return false;
+  }
+
+  File file = SPIFFS.open(BAG_CONFIG_FILE, FILE_READ);
+  if (!file) {
+    Serial.println("Failed to open bag config file for reading!");
+    currentAssignedBagID = "";
+    currentAssignedBagName = "";
+    return false;
+  }
+
+  if (file.available()) {
+    currentAssignedBagID = file.readStringUntil('\n');
+    currentAssignedBagID.trim();
+  } else {
+    currentAssignedBagID = "";
+  }
+  
+  if (file.available()) {
+    currentAssignedBagName = file.readStringUntil('\n');
+    currentAssignedBagName.trim();
+  } else {
+    currentAssignedBagName = ""; // If name wasn't saved or file is old format
+  }
+  
+  file.close();
+
+  if (!currentAssignedBagID.isEmpty()) {
+    Serial.printf("Loaded active bag from SPIFFS: ID=%s, Name=%s\n", currentAssignedBagID.c_str(), currentAssignedBagName.c_str());
+    return true;
+  } else {
+    Serial.println("No active bag ID found in config file.");
+    currentAssignedBagName = ""; // Ensure name is also cleared if ID is missing
+    return false;
+  }
+}
+
+//==============================================================================
+// RTC SNAPSHOT (SURVIVES DEEP SLEEP)
+//==============================================================================
+// Just before deep sleep the active bag and the equipment table (UID index and
+// repack bitsets included) are copied into RTC slow memory, so a button wake
+// rebuilds them with a few memcpy's instead of mounting SPIFFS and reading the
+// cache. Layout after the header:
+//   UidKey uids[count] | AirtableRecordId recordIds[count] | uint16_t nameOffsets[count]
+//   uint16_t uidOrder[count] | uint32_t usedInitially[words] | uint32_t foundInRepack[words]
+//   char nameArena[arenaBytes] | "bagID\0bagName\0"
+// The CRC32 covers the header up to the crc field and the body. Lists that do not
+// fit in RTC_SNAPSHOT_BYTES are simply loaded from flash after the wake.
+#define RTC_SNAPSHOT_MAGIC          0x50534747UL // "GGSP"
+#define RTC_SNAPSHOT_VERSION        1
+struct RtcSnapshotHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t count;
+  uint16_t arenaBytes;
+  uint16_t usedInitiallyCount;
+  uint16_t foundCount;
+  uint16_t missingCount;
+  uint32_t bodyBytes;
+  uint32_t crc;
+};
+RTC_DATA_ATTR uint32_t rtcSnapshot[RTC_SNAPSHOT_BYTES / sizeof(uint32_t)]; // Word-aligned for the header
+
+uint32_t rtcSnapshotCrc(const RtcSnapshotHeader& header, const uint8_t* body) {
+  uint32_t crc = crc32Update(0, &header, offsetof(RtcSnapshotHeader, crc));
+  return crc32Update(crc, body, header.bodyBytes);
+}
+
+void invalidateRtcSnapshot() {
+  ((RtcSnapshotHeader*)rtcSnapshot)->magic = 0;
+}
+
+bool saveRtcSnapshot() {
+  invalidateRtcSnapshot();
+  if (currentAssignedBagID.isEmpty()) {
+    return false;
+  }
+  uint16_t count = equipment.count;
+  size_t bitsetBytes = BITSET_WORDS(count) * sizeof(uint32_t);
+  const void* sections[] = { equipment.uids, equipment.recordIds, equipment.nameOffsets, equipment.uidOrder,
+                             equipment.usedInitially, equipment.foundInRepack, equipment.nameArena,
+                             currentAssignedBagID.c_str(), currentAssignedBagName.c_str() };
+  const size_t sectionSizes[] = { count * sizeof(UidKey), count * sizeof(AirtableRecordId), count * sizeof(uint16_t),
+                                  count * sizeof(uint16_t), bitsetBytes, bitsetBytes, equipment.arenaUsed,
+                                  currentAssignedBagID.length() + 1, currentAssignedBagName.length() + 1 };
+  size_t bodyBytes = 0;
+  for (size_t i = 0; i < 9; i++) {
+    bodyBytes += sectionSizes[i];
+  }
+  if (sizeof(RtcSnapshotHeader) + bodyBytes > sizeof(rtcSnapshot)) {
+    Serial.printf("Equipment list too large for the RTC snapshot (%u bytes), reloading from flash on wake.\n",
+                  (unsigned)(sizeof(RtcSnapshotHeader) + bodyBytes));
+    return false;
+  }
+
+  RtcSnapshotHeader header = {};
+  header.magic = RTC_SNAPSHOT_MAGIC;
+  header.version = RTC_SNAPSHOT_VERSION;
+  header.count = count;
+  header.arenaBytes = equipment.arenaUsed;
+  header.usedInitiallyCount = equipment.usedInitiallyCount;
+  header.foundCount = equipment.foundCount;
+  header.missingCount = equipment.missingCount;
+  header.bodyBytes = bodyBytes;
+  uint8_t* body = (uint8_t*)rtcSnapshot + sizeof(RtcSnapshotHeader);
+  uint8_t* out = body;
+  for (size_t i = 0; i < 9; i++) {
+    if (sectionSizes[i] > 0) {
+      memcpy(out, sections[i], sectionSizes[i]);
+      out += sectionSizes[i];
+    }
+  }
+  header.crc = rtcSnapshotCrc(header, body);
+  memcpy(rtcSnapshot, &header, sizeof(header)); // Magic last, the snapshot is only valid once complete
+  Serial.printf("RTC snapshot saved (%u items, %u bytes).\n", count, (unsigned)(sizeof(header) + bodyBytes));
+  return true;
+}
+
+// Rebuilds the active bag and the equipment table from the snapshot. False if it
+// is missing or fails its checksum; the caller then falls back to SPIFFS.
+bool restoreRtcSnapshot() {
+  const RtcSnapshotHeader& header = *(const RtcSnapshotHeader*)rtcSnapshot;
+  const uint8_t* body = (const uint8_t*)rtcSnapshot + sizeof(RtcSnapshotHeader);
+  if (header.magic != RTC_SNAPSHOT_MAGIC || header.version != RTC_SNAPSHOT_VERSION ||
+      header.count > MAX_EXPECTED_ITEMS || sizeof(RtcSnapshotHeader) + header.bodyBytes > sizeof(rtcSnapshot) ||
+      rtcSnapshotCrc(header, body) != header.crc) {
+    Serial.println("No valid RTC snapshot, loading from SPIFFS.");
+    return false;
+  }
+
+  uint16_t count = header.count;
+  size_t bitsetBytes = BITSET_WORDS(count) * sizeof(uint32_t);
+  size_t tableBytes = count * (sizeof(UidKey) + sizeof(AirtableRecordId) + 2 * sizeof(uint16_t)) +
+                      2 * bitsetBytes + header.arenaBytes;
+  if (tableBytes >= header.bodyBytes) {
+    return false;
+  }
+  const char* bagStrings = (const char*)body + tableBytes;
+  size_t bagBytes = header.bodyBytes - tableBytes;
+  size_t bagIdLength = strnlen(bagStrings, bagBytes);
+  if (bagIdLength + 1 >= bagBytes || bagStrings[bagBytes - 1] != '\0' ||
+      !equipmentTableReserve(equipment, count, header.arenaBytes)) {
+    return false;
+  }
+
+  void* sections[] = { equipment.uids, equipment.recordIds, equipment.nameOffsets, equipment.uidOrder,
+                       equipment.usedInitially, equipment.foundInRepack, equipment.nameArena };
+  const size_t sectionSizes[] = { count * sizeof(UidKey), count * sizeof(AirtableRecordId), count * sizeof(uint16_t),
+                                  count * sizeof(uint16_t), bitsetBytes, bitsetBytes, header.arenaBytes };
+  const uint8_t* in = body;
+  for (size_t i = 0; i < 7; i++) {
+    if (sectionSizes[i] > 0) {
+      memcpy(sections[i], in, sectionSizes[i]);
+      in += sectionSizes[i];
+    }
+  }
+  equipment.count = count;
+  equipment.arenaUsed = header.arenaBytes;
+  equipment.usedInitiallyCount = header.usedInitiallyCount;
+  equipment.foundCount = header.foundCount;
+  equipment.missingCount = header.missingCount;
+  currentAssignedBagID = bagStrings;
+  currentAssignedBagName = bagStrings + bagIdLength + 1;
+  Serial.printf("Restored bag %s and %u items from the RTC snapshot.\n", currentAssignedBagName.c_str(), count);
+  return true;
+}
+
+//==============================================================================
+// TIME INITIALIZATION (NTP)
+//==============================================================================
+void initTime() {
+  Serial.println("Configuring time from NTP server...");
   // configTime(gmtOffset_sec, daylightOffset_sec, ntpServer1, ntpServer2, ntpServer3);
   configTime(gmtOffset_sec, daylightOffset_sec, ntpServer); // Simpler version for one server
   
@@ -375,6 +1503,23 @@ void initTime() {
   // oledShowStatusMessage("Time Synced!", String(timeStr), "", false, 2000);
 }
 
+// Current UTC epoch seconds, or 0 while NTP has not set the clock yet.
+time_t syncClockNow() {
+  time_t now;
+  struct tm timeinfo;
+  time(&now);
+  gmtime_r(&now, &timeinfo);
+  return (timeinfo.tm_year > (2000 - 1900)) ? now : 0;
+}
+
+// Formats UTC epoch seconds as YYYY-MM-DDTHH:MM:SSZ for Airtable.
+#define ISO_TIMESTAMP_SIZE          21
+void formatIsoTimestamp(time_t t, char* outIso) {
+  struct tm utc;
+  gmtime_r(&t, &utc);
+  strftime(outIso, ISO_TIMESTAMP_SIZE, "%Y-%m-%dT%H:%M:%SZ", &utc);
+}
+
 //==============================================================================
 // WIFI OPERATIONS
 //==============================================================================
@@ -423,7 +1568,10 @@ void connectWiFi() {
 
 }
 
+void airtableClose();
+
 void disconnectWiFi() {
+  airtableClose(); // The kept-alive Airtable socket dies with the link anyway
   if (WiFi.status() == WL_CONNECTED) {
     WiFi.disconnect(true); // true = also erase WiFi config from RAM for this session
     Serial.println("WiFi disconnected.");
@@ -437,150 +1585,646 @@ void disconnectWiFi() {
 // AIRTABLE OPERATIONS (Replaces Google Sheets Operations)
 //==============================================================================
 
-// Helper to construct the Airtable API URL
-String getAirtableApiUrl() {
-  String tableNameEncoded = urlEncode(AIRTABLE_TABLE_NAME); // URL encode the table name
-  return "https://api.airtable.com/v0/" + String(AIRTABLE_BASE_ID) + "/" + tableNameEncoded;
+// One HTTPClient and TLS client shared by every Airtable call. With keep-alive the
+// connection to api.airtable.com stays open between requests, so the replace flow
+// (GET record id + PATCH + GET list) pays for one TLS handshake instead of three.
+// Only used from the network task.
+WiFiClientSecure airtableTlsClient;
+HTTPClient airtableHttp;
+
+// Starts a request on the shared connection; reconnects by itself if Airtable
+// closed it. Callers end with http.end(), which keeps the socket open for reuse
+// when the response allowed it, and should read the body so the stream is clean.
+bool airtableBegin(const String& url) {
+  airtableTlsClient.setInsecure(); // No CA pinned, same as HTTPClient::begin(url) did
+  airtableHttp.setReuse(true);
+  if (!airtableHttp.begin(airtableTlsClient, url)) {
+    return false;
+  }
+  airtableHttp.setTimeout(HTTP_TIMEOUT_MS);
+  airtableHttp.addHeader("Authorization", "Bearer " + String(AIRTABLE_API_KEY));
+  static const char* responseHeaders[] = { "Transfer-Encoding" };
+  airtableHttp.collectHeaders(responseHeaders, 1);
+  return true;
 }
 
-bool fetchEquipmentList_Airtable() {
-  if (currentAssignedBagID.isEmpty()) {
-    Serial.println("No active bag set. Cannot fetch equipment list.");
-    oledShowStatusMessage("No Active Bag!", "Set in Admin Menu", "", false, 3000);
-    return false;
+
+// Drops the kept-alive connection, e.g. before WiFi goes down.
+void airtableClose() {
+  airtableHttp.end();
+  airtableTlsClient.stop();
+}
+
+// Presents an HTTP response body as a plain Stream for ArduinoJson: strips chunked
+// transfer framing and stops at Content-Length, so the parser never sees framing
+// bytes and drain() leaves a kept-alive connection at the start of the next response.
+class HttpBodyStream : public Stream {
+ public:
+  HttpBodyStream(Stream& source, bool chunked, int contentLength)
+      : source(source), chunked(chunked), remaining(chunked ? 0 : contentLength) {
+    setTimeout(0); // The source stream already waits up to HTTP_TIMEOUT_MS per byte
   }
 
-  if (WiFi.status() != WL_CONNECTED) {
-    connectWiFi();
-    if (WiFi.status() != WL_CONNECTED) {
-      oledShowStatusMessage("Fetch Fail:", "No WiFi", "", false, 3000);
-      return false;
+  int available() override {
+    if (peeked >= 0) return 1;
+    if (finished) return 0;
+    return source.available() > 0 ? 1 : 0;
+  }
+
+  int peek() override {
+    if (peeked < 0) {
+      peeked = readBodyByte();
     }
+    return peeked;
   }
 
-  oledShowStatusMessage("Fetching List...", "For: " + currentAssignedBagName.substring(0,16), "From Airtable", "", true);
-  Serial.println("Fetching equipment list from Airtable for bag ID: " + currentAssignedBagID);
-  currentMaxItems = 0; // Clear current list
+  int read() override {
+    if (peeked >= 0) {
+      int c = peeked;
+      peeked = -1;
+      return c;
+    }
+    return readBodyByte();
+  }
 
-  String filterFormula = "filterByFormula=({Assigned Bag}='"; // <--- CHANGE "Assigned Bag" if your field name is different
-  // filterFormula += currentAssignedBagID;
-  filterFormula += urlEncode(currentAssignedBagName);
-  filterFormula += "')";
-  
-  String equipmentTableNameEncoded = urlEncode(AIRTABLE_TABLE_NAME); // AIRTABLE_TABLE_NAME should be "Equipment Pieces" or your equivalent
-  String url = "https://api.airtable.com/v0/" + String(AIRTABLE_BASE_ID) + "/" + equipmentTableNameEncoded +
-               "?" + filterFormula + 
-               "&fields%5B%5D=UID&fields%5B%5D=Item%20Name"; // Assuming fields in "Equipment Pieces"
+  size_t write(uint8_t) override { return 0; }
+  void flush() override {}
 
-  Serial.println("Airtable Fetch URL: " + url);
+  // Consumes whatever is left of the body.
+  void drain() {
+    while (read() >= 0) {
+    }
+  }
 
+ private:
+  int readSourceByte() {
+    char c;
+    return source.readBytes(&c, 1) == 1 ? (uint8_t)c : -1;
+  }
 
-  bool success = false;
-  HTTPClient http;
+  // Reads the next chunk-size line ("1A3;ext\r\n"), and the trailer after the last chunk.
+  bool readChunkHeader() {
+    if (chunkStarted) { // CRLF closing the previous chunk
+      readSourceByte();
+      readSourceByte();
+    }
+    chunkStarted = true;
+    long size = 0;
+    bool inExtension = false;
+    for (;;) {
+      int c = readSourceByte();
+      if (c < 0) return false;
+      if (c == '\n') break;
+      if (c == ';') inExtension = true;
+      if (inExtension || c == '\r') continue;
+      int digit = (c >= '0' && c <= '9') ? c - '0' : ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') ? (c | 0x20) - 'a' + 10 : -1;
+      if (digit < 0) return false;
+      size = size * 16 + digit;
+    }
+    if (size == 0) { // Last chunk: skip trailer lines up to the empty one
+      int lineLength = 0;
+      for (int c = readSourceByte(); c >= 0; c = readSourceByte()) {
+        if (c == '\n') {
+          if (lineLength == 0) break;
+          lineLength = 0;
+        } else if (c != '\r') {
+          lineLength++;
+        }
+      }
+      return false;
+    }
+    remaining = size;
+    return true;
+  }
 
-  if (http.begin(url)) { // HTTPS by default if URL starts with https://
-    http.addHeader("Authorization", "Bearer " + String(AIRTABLE_API_KEY));
-    http.setTimeout(HTTP_TIMEOUT_MS);
-    int httpCode = http.GET();
-    Serial.printf("Airtable (Equipment) GET request, HTTP Code: %d\n", httpCode);
+  int readBodyByte() {
+    if (finished) return -1;
+    if (chunked && remaining == 0 && !readChunkHeader()) {
+      finished = true;
+      return -1;
+    }
+    if (!chunked && remaining == 0) { // Content-Length reached
+      finished = true;
+      return -1;
+    }
+    int c = readSourceByte();
+    if (c < 0) {
+      finished = true; // Timeout or connection closed (no length: body ends at close)
+      return -1;
+    }
+    if (remaining > 0) remaining--;
+    return c;
+  }
 
-    if (httpCode == HTTP_CODE_OK) {
-      String payload = http.getString();
-      // Serial.println("Airtable Payload: " + payload); // For debugging
-      
-      // Adjust JsonDocument size based on expected payload size
-      // For ~20 items, UID (14char) + Name (avg 20char) + JSON overhead
-      // (14+20+~20overhead)*20 = 34*20*1.5 (safety) ~ 1KB. Add more for records, fields, id, createdTime.
-      // Each record has roughly: {"id":"recXXX","createdTime":"XXX","fields":{"UID":"XXX","Item Name":"XXX"}} ~100-150 bytes
-      // For MAX_EXPECTED_ITEMS = 20, try 20 * 150 bytes + overall structure = 3KB to 4KB
-      DynamicJsonDocument doc(4096); // Increased size
-      DeserializationError error = deserializeJson(doc, payload);
-
-      if (error) {
-        Serial.printf("JSON Deserialization Failed: %s. Payload: %s\n", error.c_str(), payload.substring(0, 200).c_str());
-        oledShowStatusMessage("Fetch Error:", "JSON Parse Fail", error.c_str(), false, 3000);
-      } else {
-        JsonArray records = doc["records"].as<JsonArray>();
-        if (records.isNull()) {
-            Serial.printf("Fetched JSON 'records' field is not an array or missing. Payload: %s\n", payload.substring(0, 200).c_str());
-            oledShowStatusMessage("Fetch Error:", "No 'records' array", "", false, 3000);
-        } else {
-          int count = 0;
-          for (JsonObject record : records) {
-            if (count >= MAX_EXPECTED_ITEMS) {
-              Serial.println("Max expected items reached, stopping parse.");
-              break;
-            }
-            // --- IMPORTANT: Use the EXACT field names from your Airtable Base ---
-            const char* uid_str = record["fields"]["UID"]; 
-            const char* name_str = record["fields"]["Item Name"]; // If your primary field is "Name", use record["fields"]["Name"]
-
-            if (uid_str && name_str) {
-              currentExpectedUIDStrings[count] = String(uid_str);
-              currentExpectedItemNames[count] = String(name_str);
-              Serial.printf("Loaded: UID=%s, Name=%s\n", uid_str, name_str);
-              count++;
-            } else {
-              Serial.println("Skipping item with missing UID or Item Name in JSON.");
-              if (!uid_str) Serial.println("  UID field is missing or null.");
-              if (!name_str) Serial.println("  Item Name field is missing or null.");
-            }
-          }
-          currentMaxItems = count;
-          Serial.printf("Loaded %d items from Airtable.\n", count);
-          String itemsMessage = String(count) + " items found.";
-          oledShowStatusMessage("Fetch OK!", itemsMessage, "", false, 2000);
-          success = true; 
-          saveListToSPIFFS(); 
-        }
+  Stream& source;
+  bool chunked;
+  long remaining;         // Bytes left in the chunk / body, -1 = until the connection closes
+  bool chunkStarted = false;
+  bool finished = false;
+  int peeked = -1;
+};
+
+// Body of the response to the last request, for streamed parsing.
+HttpBodyStream airtableResponseBody() {
+  bool chunked = airtableHttp.header("Transfer-Encoding").equalsIgnoreCase("chunked");
+  return HttpBodyStream(airtableHttp.getStream(), chunked, airtableHttp.getSize());
+}
+
+// What an AirtableRecordHandler wants after a record. ABORT fails the whole fetch,
+// for a handler that could not keep the record (out of memory, list too large).
+enum AirtableRecordAction {
+  AIRTABLE_RECORD_NEXT,
+  AIRTABLE_RECORD_STOP,  // Enough records, the rest of the response is skipped
+  AIRTABLE_RECORD_ABORT
+};
+
+// Called for each record of an Airtable list response.
+typedef AirtableRecordAction (*AirtableRecordHandler)(JsonObject record, void* context);
+
+enum AirtableFetchResult {
+  AIRTABLE_FETCH_OK,
+  AIRTABLE_FETCH_BEGIN_FAILED,
+  AIRTABLE_FETCH_HTTP_ERROR,  // See outHttpCode
+  AIRTABLE_FETCH_PARSE_ERROR,
+  AIRTABLE_FETCH_ABORTED      // The record handler gave up, what it collected is partial
+};
+
+int skipJsonSpaces(Stream& stream) {
+  int c;
+  while ((c = stream.peek()) >= 0 && isspace(c)) {
+    stream.read();
+  }
+  return c;
+}
+
+// Reads the "offset" paging token that follows the records array, if any.
+void readAirtableOffset(Stream& body, String& outOffset) {
+  if (!body.find("\"offset\"") || !body.find(":")) {
+    return; // Last page
+  }
+  JsonDocument offsetValue;
+  skipJsonSpaces(body);
+  if (!deserializeJson(offsetValue, body) && offsetValue.is<const char*>()) {
+    outOffset = offsetValue.as<const char*>();
+  }
+}
+
+// Walks the "records" array of an Airtable response ({"records":[{...},...]}) one
+// record at a time. Each record is deserialized on its own, keeping only what
+// 'filter' selects, so peak heap follows the largest record, not the response.
+// outOffset (optional) receives the next-page token; it stays empty on the last
+// page or when onRecord stopped early. Returns AIRTABLE_FETCH_OK, _PARSE_ERROR or
+// _ABORTED.
+AirtableFetchResult airtableForEachRecord(Stream& body, JsonDocument& filter, AirtableRecordHandler onRecord,
+                                          void* context, String* outOffset = nullptr) {
+  if (outOffset) {
+    *outOffset = "";
+  }
+  if (!body.find("\"records\"") || !body.find("[")) {
+    Serial.println("Airtable response has no 'records' array.");
+    return AIRTABLE_FETCH_PARSE_ERROR;
+  }
+  if (skipJsonSpaces(body) == ']') {
+    body.read();
+    if (outOffset) {
+      readAirtableOffset(body, *outOffset);
+    }
+    return AIRTABLE_FETCH_OK; // Empty list
+  }
+
+  JsonDocument record;
+  for (;;) {
+    DeserializationError error = deserializeJson(record, body, DeserializationOption::Filter(filter));
+    if (error) {
+      Serial.printf("Airtable record JSON parse failed: %s\n", error.c_str());
+      return AIRTABLE_FETCH_PARSE_ERROR;
+    }
+    AirtableRecordAction action = onRecord(record.as<JsonObject>(), context);
+    if (action == AIRTABLE_RECORD_ABORT) {
+      return AIRTABLE_FETCH_ABORTED;
+    }
+    if (action == AIRTABLE_RECORD_STOP) {
+      return AIRTABLE_FETCH_OK;
+    }
+    int separator = skipJsonSpaces(body);
+    body.read();
+    if (separator == ']') {
+      if (outOffset) {
+        readAirtableOffset(body, *outOffset);
       }
-    } else {
-      Serial.printf("Airtable GET request failed, HTTP Code: %d\n", httpCode);
-      String errorPayload = http.getString(); // Get error response
+      return AIRTABLE_FETCH_OK;
+    }
+    if (separator != ',') {
+      Serial.println("Airtable 'records' array is malformed.");
+      return AIRTABLE_FETCH_PARSE_ERROR;
+    }
+  }
+}
+
+// GETs listUrl (which already has a '?' query) and follows Airtable's 'offset'
+// tokens (100 records per page) until the last page, handing every record to
+// onRecord as it is parsed. The next page can only be requested once the current
+// one is read to the end, since its token comes after the records.
+AirtableFetchResult airtableFetchAllPages(const String& listUrl, JsonDocument& filter, AirtableRecordHandler onRecord,
+                                          void* context, int& outHttpCode) {
+  String offset = "";
+  int page = 0;
+  do {
+    String url = listUrl;
+    if (!offset.isEmpty()) {
+      url += "&offset=" + urlEncode(offset);
+    }
+    if (!airtableBegin(url)) {
+      return AIRTABLE_FETCH_BEGIN_FAILED;
+    }
+    outHttpCode = airtableHttp.GET();
+    page++;
+    Serial.printf("Airtable GET page %d, HTTP Code: %d\n", page, outHttpCode);
+    if (outHttpCode != HTTP_CODE_OK) {
+      String errorPayload = airtableHttp.getString(); // Get error response
       Serial.println("Error payload: " + errorPayload);
+      airtableHttp.end();
+      return AIRTABLE_FETCH_HTTP_ERROR;
+    }
+
+    HttpBodyStream body = airtableResponseBody();
+    AirtableFetchResult parsed = airtableForEachRecord(body, filter, onRecord, context, &offset);
+    body.drain();
+    airtableHttp.end();
+    if (parsed != AIRTABLE_FETCH_OK) {
+      return parsed;
+    }
+  } while (!offset.isEmpty());
+  return AIRTABLE_FETCH_OK;
+}
+
+// Helper to construct the Airtable API URL
+String getAirtableApiUrl() {
+  String tableNameEncoded = urlEncode(AIRTABLE_TABLE_NAME); // URL encode the table name
+  return "https://api.airtable.com/v0/" + String(AIRTABLE_BASE_ID) + "/" + tableNameEncoded;
+}
+
+// AirtableRecordHandler for the equipment list, grows the staging table (at
+// 'context') as records arrive. The current list stays intact until every page is in,
+// and a list that does not fit is aborted rather than kept cut short.
+AirtableRecordAction addEquipmentRecord(JsonObject record, void* context) {
+  EquipmentTable& staging = *(EquipmentTable*)context;
+  const char* recordId = record["id"];
+  const char* uid_str = record["fields"]["UID"]; 
+  const char* name_str = record["fields"]["Item Name"];
+
+  if (!uid_str || !name_str) {
+    Serial.println("Skipping item with missing UID or Item Name in JSON.");
+    if (!uid_str) Serial.println("  UID field is missing or null.");
+    if (!name_str) Serial.println("  Item Name field is missing or null.");
+    return AIRTABLE_RECORD_NEXT;
+  }
+  if (staging.count >= MAX_EXPECTED_ITEMS) {
+    Serial.printf("Bag has more than %d items, fetch aborted.\n", MAX_EXPECTED_ITEMS);
+    return AIRTABLE_RECORD_ABORT;
+  }
+  if (!equipmentTableEnsureRoom(staging, strlen(name_str))) {
+    return AIRTABLE_RECORD_ABORT;
+  }
+  if (equipmentTableAdd(staging, uid_str, strlen(uid_str), name_str, strlen(name_str), recordId)) { // Skips bad UIDs
+    Serial.printf("Loaded: UID=%s, Name=%s\n", uid_str, name_str);
+  }
+  return AIRTABLE_RECORD_NEXT;
+}
+
+// Downloads the whole list for the active bag, page by page.
+bool fetchEquipmentListFull_Airtable() {
+  oledShowStatusMessage("Fetching List...", "For: " + currentAssignedBagName.substring(0,16), "From Airtable", "", true);
+  Serial.println("Fetching equipment list from Airtable for bag ID: " + currentAssignedBagID);
+
+  String filterFormula = "filterByFormula=({Assigned Bag}='"; // <--- CHANGE "Assigned Bag" if your field name is different
+  // filterFormula += currentAssignedBagID;
+  filterFormula += urlEncode(currentAssignedBagName);
+  filterFormula += "')";
+  
+  String equipmentTableNameEncoded = urlEncode(AIRTABLE_TABLE_NAME); // AIRTABLE_TABLE_NAME should be "Equipment Pieces" or your equivalent
+  String url = "https://api.airtable.com/v0/" + String(AIRTABLE_BASE_ID) + "/" + equipmentTableNameEncoded +
+               "?" + filterFormula + 
+               "&fields%5B%5D=UID&fields%5B%5D=Item%20Name"; // Assuming fields in "Equipment Pieces"
+
+  Serial.println("Airtable Fetch URL: " + url);
+
+  // Records are parsed straight off the socket; only the id, UID and Item Name are kept
+  // --- IMPORTANT: Use the EXACT field names from your Airtable Base ---
+  JsonDocument filter;
+  filter["id"] = true;
+  filter["fields"]["UID"] = true;
+  filter["fields"]["Item Name"] = true; // If your primary field is "Name", use "Name"
+
+  EquipmentTable staging = {};
+  int httpCode = 0;
+  AirtableFetchResult result = airtableFetchAllPages(url, filter, addEquipmentRecord, &staging, httpCode);
+
+  if (result != AIRTABLE_FETCH_OK) {
+    bool tooManyItems = staging.count >= MAX_EXPECTED_ITEMS;
+    equipmentTableFree(staging); // Don't keep (or cache) a half-read list
+    if (result == AIRTABLE_FETCH_BEGIN_FAILED) {
+      Serial.println("HTTPClient begin() failed for Airtable URL.");
+      oledShowStatusMessage("Fetch Error:", "HTTP Begin Fail", "", false, 3000);
+    } else if (result == AIRTABLE_FETCH_HTTP_ERROR) {
+      Serial.printf("Airtable GET request failed, HTTP Code: %d\n", httpCode);
       oledShowStatusMessage("Fetch Fail", "HTTP Err: " + String(httpCode), "", false, 3000);
+    } else if (result == AIRTABLE_FETCH_ABORTED) {
+      oledShowStatusMessage("Fetch Error:", tooManyItems ? "Too many items" : "Out of memory", "", false, 3000);
+    } else {
+      oledShowStatusMessage("Fetch Error:", "JSON Parse Fail", "", false, 3000);
     }
-    http.end();
-  } else {
+    return false;
+  }
+
+  // Every page arrived: swap the staging table in and cache it
+  equipmentTableFinalize(staging);
+  equipmentTableFree(equipment);
+  equipment = staging;
+  saveListToSPIFFS();
+
+  int count = equipment.count;
+  Serial.printf("Loaded %d items from Airtable.\n", count);
+  String itemsMessage = String(count) + " items found.";
+  oledShowStatusMessage("Fetch OK!", itemsMessage, "", false, 2000);
+  return true;
+}
+
+
+// Records changed since the last sync. Changed records still assigned to the bag
+// are upserts; changed records that left the bag become tombstones (removals).
+struct EquipmentDelta {
+  EquipmentTable upserts;
+  AirtableRecordId* removals;
+  uint16_t removalCount;
+  uint16_t removalCapacity;
+};
+
+int compareRecordIds(const void* a, const void* b) {
+  return strcmp(((const AirtableRecordId*)a)->id, ((const AirtableRecordId*)b)->id);
+}
+
+// "Assigned Bag" is the bag name for a text field, or a list of bag record ids for
+// a linked-record field.
+bool recordIsInActiveBag(JsonVariantConst assignedBag) {
+  if (assignedBag.is<const char*>()) {
+    return currentAssignedBagName == assignedBag.as<const char*>();
+  }
+  for (JsonVariantConst bag : assignedBag.as<JsonArrayConst>()) {
+    const char* bagId = bag.as<const char*>();
+    if (bagId && currentAssignedBagID == bagId) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// AirtableRecordHandler sorting each changed record into the upserts or removals.
+// A change it cannot keep aborts the sync, so the stamp never covers a lost change.
+AirtableRecordAction collectEquipmentChange(JsonObject record, void* context) {
+  EquipmentDelta& delta = *(EquipmentDelta*)context;
+  const char* recordId = record["id"];
+  const char* uid_str = record["fields"]["UID"];
+  const char* name_str = record["fields"]["Item Name"];
+  if (!recordId) {
+    return AIRTABLE_RECORD_NEXT;
+  }
+
+  UidKey key;
+  if (recordIsInActiveBag(record["fields"]["Assigned Bag"]) && uid_str && name_str &&
+      uidKeyFromHex(uid_str, strlen(uid_str), key)) {
+    if (delta.upserts.count >= MAX_EXPECTED_ITEMS) {
+      Serial.printf("More than %d changed items, sync aborted.\n", MAX_EXPECTED_ITEMS);
+      return AIRTABLE_RECORD_ABORT;
+    }
+    if (!equipmentTableEnsureRoom(delta.upserts, strlen(name_str)) ||
+        !equipmentTableAdd(delta.upserts, uid_str, strlen(uid_str), name_str, strlen(name_str), recordId)) {
+      return AIRTABLE_RECORD_ABORT;
+    }
+    Serial.printf("Changed: UID=%s, Name=%s\n", uid_str, name_str);
+    return AIRTABLE_RECORD_NEXT;
+  }
+
+  // Moved to another bag, or no longer complete or valid: drop it locally (as a full
+  // fetch would)
+  if (delta.removalCount == delta.removalCapacity) {
+    uint16_t capacity = delta.removalCapacity > 0 ? delta.removalCapacity * 2 : 8;
+    AirtableRecordId* removals = (AirtableRecordId*)realloc(delta.removals, capacity * sizeof(AirtableRecordId));
+    if (!removals) {
+      Serial.println("Out of memory for removed equipment records!");
+      return AIRTABLE_RECORD_ABORT;
+    }
+    delta.removals = removals;
+    delta.removalCapacity = capacity;
+  }
+  strlcpy(delta.removals[delta.removalCount].id, recordId, sizeof(delta.removals[0].id));
+  delta.removalCount++;
+  return AIRTABLE_RECORD_NEXT;
+}
+
+// Builds the merged list into 'out': local items not touched by the delta, then
+// the upserts. Repack flags are reset, as with a full fetch. The delta's record ids
+// are sorted once, so each local item is checked with a binary search. Fails, with
+// 'out' empty, when memory runs out or the merged list would not fit.
+bool mergeEquipmentDelta(const EquipmentDelta& delta, EquipmentTable& out) {
+  size_t touchedCount = (size_t)delta.upserts.count + delta.removalCount;
+  AirtableRecordId* touched = (AirtableRecordId*)malloc(touchedCount * sizeof(AirtableRecordId));
+  if (!touched) {
+    return false;
+  }
+  if (delta.upserts.count > 0) {
+    memcpy(touched, delta.upserts.recordIds, delta.upserts.count * sizeof(AirtableRecordId));
+  }
+  if (delta.removalCount > 0) {
+    memcpy(touched + delta.upserts.count, delta.removals, delta.removalCount * sizeof(AirtableRecordId));
+  }
+  qsort(touched, touchedCount, sizeof(AirtableRecordId), compareRecordIds);
+
+  // Upserts of local items take their place, so the sum is an upper bound
+  size_t items = min((size_t)equipment.count + delta.upserts.count, (size_t)MAX_EXPECTED_ITEMS);
+  if (!equipmentTableReserve(out, items, (size_t)equipment.arenaUsed + delta.upserts.arenaUsed)) {
+    free(touched);
+    return false;
+  }
+  char uidHex[UID_HEX_BUFFER_SIZE];
+  bool complete = true;
+  for (uint16_t i = 0; i < equipment.count && complete; i++) {
+    if (bsearch(&equipment.recordIds[i], touched, touchedCount, sizeof(AirtableRecordId), compareRecordIds)) {
+      continue;
+    }
+    equipmentUidHex(i, uidHex);
+    const char* name = equipmentName(i);
+    complete = equipmentTableAdd(out, uidHex, strlen(uidHex), name, strlen(name), equipment.recordIds[i].id);
+  }
+  free(touched);
+  for (uint16_t j = 0; j < delta.upserts.count && complete; j++) {
+    uidBytesToHex(delta.upserts.uids[j].bytes, delta.upserts.uids[j].length, uidHex);
+    const char* name = delta.upserts.nameArena + delta.upserts.nameOffsets[j];
+    complete = equipmentTableAdd(out, uidHex, strlen(uidHex), name, strlen(name), delta.upserts.recordIds[j].id);
+  }
+  if (!complete) {
+    Serial.println("Merged list does not fit, sync aborted.");
+    equipmentTableFree(out);
+    return false;
+  }
+  equipmentTableFinalize(out);
+  return true;
+}
+
+// Asks Airtable only for equipment records whose UID, name or bag changed after
+// 'since', in the active bag or moved between bags (so items that left the active
+// bag are seen too), and merges them into the list. Edits to other fields, like
+// the journal's "Last Scanned" stamps, don't make a record part of the delta.
+bool syncEquipmentDelta_Airtable(time_t since) {
+  oledShowStatusMessage("Syncing List...", "For: " + currentAssignedBagName.substring(0,16), "From Airtable", true);
+
+  char sinceIso[ISO_TIMESTAMP_SIZE];
+  formatIsoTimestamp(since, sinceIso);
+  Serial.printf("Syncing equipment changes since %s for bag ID: %s\n", sinceIso, currentAssignedBagID.c_str());
+
+  // <--- CHANGE "UID", "Item Name" and "Assigned Bag" if your field names are different
+  String formula = "AND(IS_AFTER(LAST_MODIFIED_TIME({UID},{Item Name},{Assigned Bag}),'" + String(sinceIso) + "')," +
+                   "OR({Assigned Bag}='" + currentAssignedBagName + "'," +
+                   "IS_AFTER(LAST_MODIFIED_TIME({Assigned Bag}),'" + String(sinceIso) + "')))";
+  String url = getAirtableApiUrl() + "?filterByFormula=" + urlEncode(formula) +
+               "&fields%5B%5D=UID&fields%5B%5D=Item%20Name&fields%5B%5D=Assigned%20Bag"; // <--- CHANGE "Assigned Bag" if your field name is different
+
+  JsonDocument filter;
+  filter["id"] = true;
+  filter["fields"]["UID"] = true;
+  filter["fields"]["Item Name"] = true;
+  filter["fields"]["Assigned Bag"] = true;
+
+  EquipmentDelta delta = {};
+  int httpCode = 0;
+  AirtableFetchResult result = airtableFetchAllPages(url, filter, collectEquipmentChange, &delta, httpCode);
+
+  bool success = false;
+  if (result == AIRTABLE_FETCH_BEGIN_FAILED) {
     Serial.println("HTTPClient begin() failed for Airtable URL.");
-    oledShowStatusMessage("Fetch Error:", "HTTP Begin Fail", "", false, 3000);
+    oledShowStatusMessage("Sync Error:", "HTTP Begin Fail", "", false, 3000);
+  } else if (result == AIRTABLE_FETCH_HTTP_ERROR) {
+    Serial.printf("Airtable sync request failed, HTTP Code: %d\n", httpCode);
+    oledShowStatusMessage("Sync Fail", "HTTP Err: " + String(httpCode), "", false, 3000);
+  } else if (result == AIRTABLE_FETCH_PARSE_ERROR) {
+    oledShowStatusMessage("Sync Error:", "JSON Parse Fail", "", false, 3000);
+  } else if (result == AIRTABLE_FETCH_ABORTED) {
+    oledShowStatusMessage("Sync Error:", delta.upserts.count >= MAX_EXPECTED_ITEMS ? "Too many items" : "Out of memory",
+                          "", false, 3000);
+  } else if (delta.upserts.count == 0 && delta.removalCount == 0) {
+    Serial.println("Equipment list already up to date.");
+    oledShowStatusMessage("List Up To Date", String(equipment.count) + " items.", "", false, 2000);
+    success = true;
+  } else {
+    EquipmentTable merged = {};
+    if (mergeEquipmentDelta(delta, merged)) {
+      equipmentTableFree(equipment);
+      equipment = merged;
+      saveListToSPIFFS();
+      Serial.printf("Synced %u changed, %u removed record(s); %d items in list.\n",
+                    delta.upserts.count, delta.removalCount, equipment.count);
+      oledShowStatusMessage("Sync OK!", String(equipment.count) + " items.",
+                            String(delta.upserts.count + delta.removalCount) + " changes", false, 2000);
+      success = true;
+    } else {
+      oledShowStatusMessage("Sync Error:", "Merge failed", "", false, 3000);
+    }
   }
+
+  equipmentTableFree(delta.upserts);
+  free(delta.removals);
   return success;
 }
 
+bool fetchEquipmentList_Airtable() {
+  if (currentAssignedBagID.isEmpty()) {
+    Serial.println("No active bag set. Cannot fetch equipment list.");
+    oledShowStatusMessage("No Active Bag!", "Set in Admin Menu", "", false, 3000);
+    return false;
+  }
+
+  if (WiFi.status() != WL_CONNECTED) {
+    connectWiFi();
+    if (WiFi.status() != WL_CONNECTED) {
+      oledShowStatusMessage("Fetch Fail:", "No WiFi", "", false, 3000);
+      return false;
+    }
+  }
+
+  // Stable bags only download what changed since the last sync; a new bag, an empty
+  // or unloaded list, an old cache without record ids or an overdue full sync
+  // downloads everything.
+  time_t syncStartedAt = syncClockNow();
+  EquipmentSyncStamp stamp;
+  bool deltaPossible = syncStartedAt > 0 && equipmentHasRecordIds() && loadEquipmentSyncStamp(stamp) &&
+                       stamp.bagID == currentAssignedBagID &&
+                       (syncStartedAt - stamp.lastFullSync) < EQUIPMENT_FULL_SYNC_INTERVAL_S;
+  if (deltaPossible) {
+    if (!syncEquipmentDelta_Airtable(stamp.lastSync)) {
+      return false;
+    }
+  } else {
+    if (!fetchEquipmentListFull_Airtable()) {
+      return false;
+    }
+    stamp.lastFullSync = syncStartedAt;
+  }
+
+  if (syncStartedAt > 0 && equipmentCacheCurrent) {
+    stamp.bagID = currentAssignedBagID;
+    stamp.lastSync = syncStartedAt;
+    saveEquipmentSyncStamp(stamp);
+  } else {
+    discardEquipmentSyncStamp(); // No clock or no cache: the next sync must be a full one
+  }
+  return true;
+}
+
+// AirtableRecordHandler storing the first record's id in the String at 'context'.
+AirtableRecordAction takeFirstRecordId(JsonObject record, void* context) {
+  const char* id = record["id"];
+  if (id) {
+    *(String*)context = id;
+  }
+  return AIRTABLE_RECORD_STOP; // One is enough
+}
+
+// AirtableRecordHandler counting the records at 'context' (an int).
+AirtableRecordAction countRecord(JsonObject record, void* context) {
+  (*(int*)context)++;
+  return AIRTABLE_RECORD_NEXT;
+}
 
 // To update a record in Airtable, we usually need its Airtable Record ID.
 // So, first we fetch the Record ID using the targetUID (NFC UID).
-String getAirtableRecordIdByUID(const String& nfcUID) {
+// Returns false if the request failed; true with an empty outRecordId if no record has that UID.
+bool getAirtableRecordIdByUID(const String& nfcUID, String& outRecordId) {
+  outRecordId = "";
   if (WiFi.status() != WL_CONNECTED) {
-    // connectWiFi(); // Assuming WiFi is connected by calling function
-    if (WiFi.status() != WL_CONNECTED) return "";
+    return false; // Assuming WiFi is connected by calling function
   }
 
-  String recordId = "";
   // URL encode the NFC UID for the formula
   String filterFormula = "filterByFormula=({UID}='" + urlEncode(nfcUID) + "')"; 
   String url = getAirtableApiUrl() + "?" + filterFormula + "&fields%5B%5D=UID"; // Only need UID to confirm, Airtable sends ID anyway
 
   Serial.printf("Getting Record ID for UID: %s\n", nfcUID.c_str());
   
-  HTTPClient http;
-  if (http.begin(url)) {
-    http.addHeader("Authorization", "Bearer " + String(AIRTABLE_API_KEY));
-    http.setTimeout(HTTP_TIMEOUT_MS);
+  bool success = false;
+  HTTPClient& http = airtableHttp;
+  if (airtableBegin(url)) {
     int httpCode = http.GET();
 
     if (httpCode == HTTP_CODE_OK) {
-      String payload = http.getString();
-      DynamicJsonDocument doc(1024); // Smaller doc for finding one record
-      DeserializationError error = deserializeJson(doc, payload);
-      if (!error && doc["records"] && doc["records"].is<JsonArray>() && doc["records"].size() > 0) {
-        recordId = doc["records"][0]["id"].as<String>();
-        Serial.println("Found Record ID: " + recordId);
+      JsonDocument filter;
+      filter["id"] = true;
+      HttpBodyStream body = airtableResponseBody();
+      success = airtableForEachRecord(body, filter, takeFirstRecordId, &outRecordId) == AIRTABLE_FETCH_OK;
+      body.drain();
+      if (!outRecordId.isEmpty()) {
+        Serial.println("Found Record ID: " + outRecordId);
       } else {
         Serial.println("Record not found by UID or JSON error.");
-        if(error) Serial.println(error.c_str());
-        Serial.println(payload);
       }
     } else {
       Serial.printf("Failed to get Record ID, HTTP: %d\n", httpCode);
@@ -591,285 +2235,1093 @@ String getAirtableRecordIdByUID(const String& nfcUID) {
   } else {
      Serial.println("HTTPClient begin() failed for getAirtableRecordIdByUID.");
   }
-  return recordId;
+  return success;
+}
+
+// Looks the record id up in the cached equipment list (filled by every fetch), and
+// only asks Airtable when the UID is not there or was cached without its id.
+bool resolveRecordIdForUid(const String& uidHex, String& outRecordId) {
+  UidKey key;
+  if (uidKeyFromHex(uidHex.c_str(), uidHex.length(), key)) {
+    int i = findItemIndexByUid(key.bytes, key.length);
+    if (i >= 0 && equipment.recordIds[i].id[0] != '\0') {
+      outRecordId = equipment.recordIds[i].id;
+      return true;
+    }
+  }
+  return getAirtableRecordIdByUID(uidHex, outRecordId);
+}
+
+// PATCHes 'payload' ({"records":[...]}, at most 10 records) to tableUrl. Returns
+// the number of records Airtable reports back, or -1 if the request failed.
+int airtablePatchRecords(const String& tableUrl, JsonDocument& payload) {
+  String postData;
+  serializeJson(payload, postData);
+  Serial.println("Airtable PATCH data: " + postData);
+
+  int updatedRecords = -1;
+  HTTPClient& http = airtableHttp;
+  if (airtableBegin(tableUrl)) {
+    http.addHeader("Content-Type", "application/json");
+
+    // Airtable uses PATCH for updating records
+    int httpCode = http.PATCH(postData); 
+    Serial.printf("Airtable PATCH request, HTTP Code: %d\n", httpCode);
+
+    if (httpCode == HTTP_CODE_OK) {
+      JsonDocument filter;
+      filter["id"] = true;
+      updatedRecords = 0;
+      HttpBodyStream body = airtableResponseBody();
+      airtableForEachRecord(body, filter, countRecord, &updatedRecords);
+      body.drain();
+      Serial.printf("Airtable Response: %d record(s) updated\n", updatedRecords);
+    } else {
+      String errorStr = http.getString();
+      Serial.printf("Airtable PATCH request failed. Response: %s\n", errorStr.c_str());
+    }
+    http.end();
+  } else {
+    Serial.println("HTTPClient begin() failed for Airtable PATCH.");
+  }
+  return updatedRecords;
 }
 
-bool sendAirtableUpdateRequest(const String& targetNFC_UID, const String& newNFC_UID, const String& newItemName) {
+// Updates any number of records ([{"id":…,"fields":{…}}, …]) on tableUrl with one
+// PATCH per AIRTABLE_BATCH_SIZE records, all over the shared keep-alive connection.
+// Stops at the first failed request; true if every record was updated.
+bool airtableBatchUpdate(const String& tableUrl, JsonArrayConst records) {
+  size_t total = records.size();
+  for (size_t first = 0; first < total; first += AIRTABLE_BATCH_SIZE) {
+    JsonDocument payload;
+    JsonArray batch = payload["records"].to<JsonArray>();
+    for (size_t i = first; i < total && i < first + AIRTABLE_BATCH_SIZE; i++) {
+      batch.add(records[i]);
+    }
+    if (airtablePatchRecords(tableUrl, payload) != (int)batch.size()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// AirtableRecordHandler for the bag list.
+AirtableRecordAction addBagRecord(JsonObject record, void* context) {
+  if (availableBagCount >= MAX_BAGS_TO_LIST) {
+    Serial.println("Max bags to list reached.");
+    return AIRTABLE_RECORD_STOP;
+  }
+  const char* bagNameStr = record["fields"]["Bag Name"];
+  const char* bagIdStr = record["id"];
+
+  if (bagNameStr && bagIdStr) {
+    availableBagNames[availableBagCount] = String(bagNameStr);
+    availableBagIDs[availableBagCount] = String(bagIdStr);
+    Serial.printf("Found Bag: Name=%s, ID=%s\n", bagNameStr, bagIdStr);
+    availableBagCount++;
+  } else {
+    Serial.println("Skipping bag with missing Name or ID in JSON.");
+  }
+  return AIRTABLE_RECORD_NEXT;
+}
+
+bool fetchAvailableBags_Airtable() {
   if (WiFi.status() != WL_CONNECTED) {
-    connectWiFi();
+    connectWiFi(); // Ensure WiFi is up, this also calls initTime()
     if (WiFi.status() != WL_CONNECTED) {
-      oledShowStatusMessage("Update Fail:", "No WiFi", "", false, 3000);
+      oledShowStatusMessage("Bag Fetch Fail:", "No WiFi", "", false, 3000);
       return false;
     }
   }
 
-  // Ensure time is somewhat valid if we are going to send a date
-  struct tm timeinfo_check;
-  if(!getLocalTime(&timeinfo_check, 1000) || timeinfo_check.tm_year < (2000-1900)){ // 1s timeout to get time
-      Serial.println("NTP time not yet available for update. Trying to sync...");
-      initTime(); // Try one more time to sync
-      if(!getLocalTime(&timeinfo_check, 1000) || timeinfo_check.tm_year < (2000-1900)){
-          oledShowStatusMessage("Update Warning:", "Accurate date", "unavailable.", false, 3000);
-          // Decide if you want to proceed without a valid date or abort
-          // For now, we'll proceed, and the date might be old/incorrect if NTP failed.
+  oledShowStatusMessage("Fetching Bags...", "From Airtable", "", true);
+  Serial.println("Fetching available bags from Airtable 'Bags' table...");
+  availableBagCount = 0; // Clear current list
+
+  // Construct URL for the "Bags" table - IMPORTANT: Use the EXACT name of your "Bags" table.
+  // If your Bags table is NOT named "Bags", change it here.
+  String bagsTableNameEncoded = urlEncode("Bags"); // <--- CHANGE "Bags" IF YOUR TABLE HAS A DIFFERENT NAME
+  String url = "https://api.airtable.com/v0/" + String(AIRTABLE_BASE_ID) + "/" + bagsTableNameEncoded +
+               "?fields%5B%5D=Bag%20Name&view=Grid%20view"; // Assuming primary field is "Bag Name"
+               // If your primary field in "Bags" table is different, change "Bag%20Name"
+
+  JsonDocument filter;
+  filter["id"] = true; // This is the Airtable Record ID
+  filter["fields"]["Bag Name"] = true; // <--- CHANGE "Bag Name" if your primary field has a different name
+
+  int httpCode = 0;
+  AirtableFetchResult result = airtableFetchAllPages(url, filter, addBagRecord, nullptr, httpCode);
+  if (result == AIRTABLE_FETCH_BEGIN_FAILED) {
+    Serial.println("HTTPClient begin() failed for Airtable (Bags) URL.");
+    oledShowStatusMessage("Bag Fetch Err:", "HTTP Begin Fail", "", false, 3000);
+    return false;
+  }
+  if (result == AIRTABLE_FETCH_HTTP_ERROR) {
+    Serial.printf("Airtable (Bags) GET request failed, HTTP Code: %d\n", httpCode);
+    oledShowStatusMessage("Bag Fetch Fail", "HTTP Err: " + String(httpCode), "", false, 3000);
+    return false;
+  }
+  if (result == AIRTABLE_FETCH_PARSE_ERROR) {
+    oledShowStatusMessage("Bag Fetch Error:", "JSON Parse Fail", "", false, 3000);
+    return false;
+  }
+
+  Serial.printf("Loaded %d available bags from Airtable.\n", availableBagCount);
+  if (availableBagCount == 0) {
+    oledShowStatusMessage("No Bags Found", "Check Airtable", "'Bags' Table", false, 3000);
+    return false;
+  }
+  oledShowStatusMessage("Bag List OK!", String(availableBagCount) + " bags found.", "", false, 2000);
+  return true;
+}
+
+//==============================================================================
+// AIRTABLE JOURNAL (OFFLINE WRITE-AHEAD QUEUE)
+//==============================================================================
+// Every mutation meant for Airtable is first appended to a JSON-lines journal on
+// flash, so nothing is lost while WiFi is off (the normal case outside admin mode)
+// or a request fails. journalFlush() replays it in order once the network task
+// has a connection, up to AIRTABLE_BATCH_SIZE records per request, and drops each
+// batch from the journal only after Airtable accepted it.
+// Each entry carries an idempotency key ("k"). Equipment updates set absolute
+// values on a record, and session outcomes are upserted on their key, so a batch
+// that is replayed after a crash or a lost response changes nothing.
+//
+//   {"k":"…","op":"replace","at":…,"old":"UID","new":"UID","name":"Item Name"}
+//   {"k":"…","op":"seen","at":…,"uids":["UID",…]}             // Last Scanned stamps, up to AIRTABLE_BATCH_SIZE
+//   {"k":"…","op":"session","at":…,"bag":"…","out":N,"in":N,"missing":N}
+// Older journals may still hold "seen" entries with a single "uid".
+SemaphoreHandle_t journalMutex = NULL; // Appends come from the UI task, flushes from the network task
+
+// Stamps 'entry' with a fresh idempotency key and the time, and appends it as one
+// line. 'journalBytes' follows the file size across several writes to one open
+// file. False if the journal is full. Caller holds journalMutex.
+bool journalWriteEntry(File& file, size_t& journalBytes, JsonDocument& entry) {
+  if (journalBytes >= AIRTABLE_JOURNAL_MAX_BYTES) {
+    Serial.println("Airtable journal full, update dropped.");
+    return false;
+  }
+  char key[17];
+  snprintf(key, sizeof(key), "%08lx%08lx", (unsigned long)esp_random(), (unsigned long)esp_random());
+  entry["k"] = key;
+  entry["at"] = (long long)syncClockNow(); // 0 if the clock is not set yet, stamped at flush time then
+  journalBytes += serializeJson(entry, file);
+  journalBytes += file.print('\n');
+  return true;
+}
+
+// Finishes a compaction cut short by a power loss (see journalDropPrefix()): the
+// journal is missing while the previous one, and maybe the compacted one, exist.
+// Caller holds journalMutex.
+void journalRecover() {
+  if (!SPIFFS.exists(AIRTABLE_JOURNAL_OLD_FILE)) {
+    return;
+  }
+  if (!SPIFFS.exists(AIRTABLE_JOURNAL_FILE)) {
+    // The compacted journal is only complete once the previous one was moved aside
+    const char* source = SPIFFS.exists(AIRTABLE_JOURNAL_TEMP_FILE) ? AIRTABLE_JOURNAL_TEMP_FILE : AIRTABLE_JOURNAL_OLD_FILE;
+    if (!SPIFFS.rename(source, AIRTABLE_JOURNAL_FILE)) {
+      Serial.println("Failed to restore the Airtable journal!");
+      return;
+    }
+    Serial.println("Airtable journal restored after an interrupted compaction.");
+  }
+  SPIFFS.remove(AIRTABLE_JOURNAL_OLD_FILE);
+}
+
+// Shown once the journal lock is released, so a flush is never held up by the OLED.
+void journalShowFull() {
+  oledShowStatusMessage("Journal Full!", "Update not saved", "Sync via Admin Menu", false, 3000);
+}
+
+bool journalAppend(JsonDocument& entry) {
+  if (!ensureSpiffsMounted()) {
+    return false;
+  }
+  xSemaphoreTake(journalMutex, portMAX_DELAY);
+  journalRecover();
+  File file = SPIFFS.open(AIRTABLE_JOURNAL_FILE, FILE_APPEND);
+  bool appended = false;
+  bool full = false;
+  if (!file) {
+    Serial.println("Failed to open Airtable journal for appending!");
+  } else {
+    size_t journalBytes = file.size();
+    appended = journalWriteEntry(file, journalBytes, entry);
+    full = !appended;
+    file.close();
+  }
+  xSemaphoreGive(journalMutex);
+  if (full) {
+    journalShowFull();
+  }
+  return appended;
+}
+
+void journalReplaceTag(const String& oldUid, const String& newUid, const String& newName) {
+  JsonDocument entry;
+  entry["op"] = "replace";
+  entry["old"] = oldUid;
+  entry["new"] = newUid;
+  entry["name"] = newName;
+  journalAppend(entry);
+}
+
+// The items scanned back this session, taken from the found bitset once it
+// completes, as "seen" entries of up to AIRTABLE_BATCH_SIZE UIDs: each becomes one
+// PATCH, and a full bag costs ~24 bytes of journal per item instead of a line each.
+// Written with a single open/close, so scanning itself never touches flash.
+void journalSessionSeen() {
+  if (equipment.foundCount == 0 || !ensureSpiffsMounted()) {
+    return;
+  }
+  bool full = false;
+  xSemaphoreTake(journalMutex, portMAX_DELAY);
+  journalRecover();
+  File file = SPIFFS.open(AIRTABLE_JOURNAL_FILE, FILE_APPEND);
+  if (!file) {
+    Serial.println("Failed to open Airtable journal for appending!");
+  } else {
+    size_t journalBytes = file.size();
+    char uidHex[UID_HEX_BUFFER_SIZE];
+    JsonDocument entry;
+    JsonArray uids;
+    for (uint16_t i = 0; i < equipment.count && !full; i++) {
+      if (!bitsetTest(equipment.foundInRepack, i)) {
+        continue;
       }
+      if (uids.isNull()) {
+        entry.clear();
+        entry["op"] = "seen";
+        uids = entry["uids"].to<JsonArray>();
+      }
+      equipmentUidHex(i, uidHex);
+      uids.add(uidHex);
+      if (uids.size() == AIRTABLE_BATCH_SIZE) {
+        full = !journalWriteEntry(file, journalBytes, entry);
+        uids = JsonArray();
+      }
+    }
+    if (!full && !uids.isNull()) {
+      full = !journalWriteEntry(file, journalBytes, entry);
+    }
+    file.close();
   }
+  xSemaphoreGive(journalMutex);
+  if (full) {
+    journalShowFull();
+  }
+}
 
-  String recordIdToUpdate = getAirtableRecordIdByUID(targetNFC_UID);
-  if (recordIdToUpdate.isEmpty()) {
-    Serial.println("Update failed: Could not find Airtable Record ID for target UID: " + targetNFC_UID);
-    oledShowStatusMessage("Update Fail", "Old UID not found", targetNFC_UID.substring(0,8), false, 3000);
+void journalSessionOutcome(int itemsOut, int itemsIn, int itemsMissing) {
+  JsonDocument entry;
+  entry["op"] = "session";
+  entry["bag"] = currentAssignedBagName;
+  entry["out"] = itemsOut;
+  entry["in"] = itemsIn;
+  entry["missing"] = itemsMissing;
+  journalAppend(entry);
+}
+
+bool journalOpTargetsSessions(const char* op) {
+  return op && strcmp(op, "session") == 0;
+}
+
+// Airtable records an entry updates: one per UID of a "seen" entry, else one.
+size_t journalEntryRecords(JsonObjectConst entry) {
+  JsonArrayConst uids = entry["uids"];
+  return uids.isNull() ? 1 : uids.size();
+}
+
+// Reads the next batch: consecutive entries going to the same table and updating
+// up to AIRTABLE_BATCH_SIZE records (an oversized entry goes alone). outBytes is how
+// much of the journal the batch covers, including unreadable lines (torn by a
+// power cut) which are skipped. Caller holds journalMutex.
+bool journalReadBatch(JsonDocument& outBatch, size_t& outBytes) {
+  outBatch.clear();
+  outBytes = 0;
+  journalRecover();
+  File file = SPIFFS.open(AIRTABLE_JOURNAL_FILE, FILE_READ);
+  if (!file || file.isDirectory()) {
     return false;
   }
+  JsonArray entries = outBatch.to<JsonArray>();
+  bool sessions = false;
+  size_t records = 0;
+  while (file.available() && records < AIRTABLE_BATCH_SIZE) {
+    size_t lineStart = file.position();
+    String line = file.readStringUntil('\n');
+    JsonDocument entry;
+    if (deserializeJson(entry, line) || !entry["op"].is<const char*>()) {
+      Serial.println("Skipping unreadable Airtable journal entry: " + line);
+      outBytes = file.position();
+      continue;
+    }
+    bool entryForSessions = journalOpTargetsSessions(entry["op"]);
+    size_t entryRecords = journalEntryRecords(entry.as<JsonObjectConst>());
+    if (entries.size() > 0 && (entryForSessions != sessions || records + entryRecords > AIRTABLE_BATCH_SIZE)) {
+      file.seek(lineStart); // Belongs to the next batch
+      break;
+    }
+    sessions = entryForSessions;
+    records += entryRecords;
+    entries.add(entry);
+    outBytes = file.position();
+  }
+  file.close();
+  return outBytes > 0;
+}
 
-  String oledLine2 = targetNFC_UID.substring(0, 6) + "->" + newNFC_UID.substring(0, 6);
-  String oledLine3 = newItemName.substring(0, 18);
-  oledShowStatusMessage("Updating Airtable", oledLine2, oledLine3, true);
-  Serial.printf("Updating Airtable Record ID %s: TargetOldUID:%s, NewUID:%s, NewName:%s\n", 
-                recordIdToUpdate.c_str(), targetNFC_UID.c_str(), newNFC_UID.c_str(), newItemName.c_str());
-  
-  HTTPClient http;
-  bool success = false;
-  String url = getAirtableApiUrl(); // Base URL for PATCH operations on multiple records
-
-  // Construct JSON payload for PATCH request
-  // For updating specific records, the API expects an array of objects, each with "id" and "fields"
-  DynamicJsonDocument updatePayload(512); // Sufficient for one record update
-  JsonArray recordsArray = updatePayload.createNestedArray("records");
-  JsonObject recordObject = recordsArray.createNestedObject();
-  recordObject["id"] = recordIdToUpdate;
-  JsonObject fieldsObject = recordObject.createNestedObject("fields");
-  // --- IMPORTANT: Use the EXACT field names from your Airtable Base ---
-  fieldsObject["UID"] = newNFC_UID;
-  fieldsObject["Item Name"] = newItemName; // If your primary field is "Name", use "Name"
+// Removes the first 'bytes' of the journal. The rest is copied to a temp file,
+// the journal is moved aside and the temp file takes its place; the previous
+// journal is only deleted once that worked, and journalRecover() completes the
+// swap after a power loss. On failure the journal is left as it was and the
+// (idempotent) batch is replayed. Caller holds journalMutex.
+void journalDropPrefix(size_t bytes) {
+  File file = SPIFFS.open(AIRTABLE_JOURNAL_FILE, FILE_READ);
+  if (!file) {
+    return;
+  }
+  if (bytes >= file.size()) {
+    file.close();
+    SPIFFS.remove(AIRTABLE_JOURNAL_FILE);
+    return;
+  }
+  File rest = SPIFFS.open(AIRTABLE_JOURNAL_TEMP_FILE, FILE_WRITE);
+  if (!rest) {
+    file.close();
+    Serial.println("Failed to compact Airtable journal, the batch will be replayed.");
+    return;
+  }
+  file.seek(bytes);
+  uint8_t chunk[64];
+  size_t chunkLength;
+  bool copied = true;
+  while (copied && (chunkLength = file.read(chunk, sizeof(chunk))) > 0) {
+    copied = rest.write(chunk, chunkLength) == chunkLength;
+  }
+  file.close();
+  rest.close();
+  if (!copied || !SPIFFS.rename(AIRTABLE_JOURNAL_FILE, AIRTABLE_JOURNAL_OLD_FILE)) {
+    SPIFFS.remove(AIRTABLE_JOURNAL_TEMP_FILE);
+    Serial.println("Failed to compact Airtable journal, the batch will be replayed.");
+    return;
+  }
+  if (!SPIFFS.rename(AIRTABLE_JOURNAL_TEMP_FILE, AIRTABLE_JOURNAL_FILE)) {
+    SPIFFS.rename(AIRTABLE_JOURNAL_OLD_FILE, AIRTABLE_JOURNAL_FILE); // Put the previous journal back
+    SPIFFS.remove(AIRTABLE_JOURNAL_TEMP_FILE);
+    Serial.println("Failed to compact Airtable journal, the batch will be replayed.");
+    return;
+  }
+  SPIFFS.remove(AIRTABLE_JOURNAL_OLD_FILE);
+}
 
-  time_t now;
-  struct tm timeinfo;
-  time(&now); // Gets current time (seconds since epoch, depends on system time being set)
-  localtime_r(&now, &timeinfo);
-
-  char isoTimestamp[25];
-  // Format: YYYY-MM-DDTHH:MM:SSZ
-  // strftime is powerful for this if time is set correctly (e.g., by NTP)
-  if (timeinfo.tm_year > (2000 - 1900)) { // Basic check if time seems somewhat valid
-      strftime(isoTimestamp, sizeof(isoTimestamp), "%Y-%m-%dT%H:%M:%SZ", &timeinfo);
-      fieldsObject["Last Scanned"] = isoTimestamp;
-      Serial.println("Adding Last Scanned: " + String(isoTimestamp));
+// Finds or adds the PATCH record for recordId, so two entries for the same item in
+// one batch become one record (later fields win).
+JsonObject patchRecordFields(JsonArray records, const String& recordId) {
+  for (JsonObject record : records) {
+    if (recordId == record["id"].as<const char*>()) {
+      return record["fields"];
+    }
+  }
+  JsonObject record = records.add<JsonObject>();
+  record["id"] = recordId;
+  return record["fields"].to<JsonObject>();
+}
+
+// Adds the PATCH fields for one UID of 'entry' (the old UID of a replacement) to
+// 'records'. A replacement whose old UID has no record can never be applied: it is
+// dropped, counted in droppedReplaces and shown to the admin. False on network
+// trouble, when the whole batch is retried later.
+bool journalAddEquipmentUpdate(JsonArray records, JsonObject entry, const String& uid, time_t flushTime,
+                               int& droppedReplaces) {
+  bool isReplace = strcmp(entry["op"], "replace") == 0;
+  String recordId;
+  if (!resolveRecordIdForUid(uid, recordId)) {
+    return false;
+  }
+  if (recordId.isEmpty()) {
+    String newRecordId;
+    if (isReplace && resolveRecordIdForUid(entry["new"].as<String>(), newRecordId) && !newRecordId.isEmpty()) {
+      Serial.printf("Journal %s: replacement already applied.\n", entry["k"].as<const char*>());
+    } else {
+      Serial.printf("Journal %s: no Airtable record for UID %s, entry dropped.\n", entry["k"].as<const char*>(), uid.c_str());
+      if (isReplace) {
+        droppedReplaces++;
+        oledShowStatusMessage("Update Fail", "Old UID not found", uid.substring(0, 8), false, 3000);
+      }
+    }
+    return true;
+  }
+
+  JsonObject fields = patchRecordFields(records, recordId);
+  if (isReplace) {
+    // --- IMPORTANT: Use the EXACT field names from your Airtable Base ---
+    fields["UID"] = entry["new"];
+    fields["Item Name"] = entry["name"]; // If your primary field is "Name", use "Name"
+  }
+  time_t at = entry["at"].as<long long>() > 0 ? (time_t)entry["at"].as<long long>() : flushTime;
+  if (at > 0) {
+    char isoTimestamp[ISO_TIMESTAMP_SIZE];
+    formatIsoTimestamp(at, isoTimestamp);
+    fields["Last Scanned"] = isoTimestamp;
+  }
+  return true;
+}
+
+// Equipment updates: resolve each UID to its record (locally when possible), then
+// one PATCH for the batch.
+bool journalSendEquipmentBatch(JsonArray entries, int& droppedReplaces) {
+  JsonDocument payload;
+  JsonArray records = payload["records"].to<JsonArray>();
+  time_t flushTime = syncClockNow();
+
+  for (JsonObject entry : entries) {
+    JsonArray uids = entry["uids"];
+    if (!uids.isNull()) {
+      for (JsonVariant uid : uids) {
+        if (!journalAddEquipmentUpdate(records, entry, uid.as<String>(), flushTime, droppedReplaces)) {
+          return false;
+        }
+      }
+      continue;
+    }
+    bool isReplace = strcmp(entry["op"], "replace") == 0;
+    String uid = isReplace ? entry["old"].as<String>() : entry["uid"].as<String>();
+    if (!journalAddEquipmentUpdate(records, entry, uid, flushTime, droppedReplaces)) {
+      return false;
+    }
+  }
+
+  return airtableBatchUpdate(getAirtableApiUrl(), records);
+}
+
+// Session outcomes: upserted on "Session Key" so a replayed batch doesn't duplicate rows.
+bool journalSendSessionBatch(JsonArray entries) {
+  JsonDocument payload;
+  payload["performUpsert"]["fieldsToMergeOn"].add("Session Key");
+  JsonArray records = payload["records"].to<JsonArray>();
+
+  for (JsonObject entry : entries) {
+    // --- IMPORTANT: Use the EXACT field names from your Airtable Base ---
+    JsonObject fields = records.add<JsonObject>()["fields"].to<JsonObject>();
+    fields["Session Key"] = entry["k"];
+    fields["Bag"] = entry["bag"];
+    fields["Items Out"] = entry["out"];
+    fields["Items Returned"] = entry["in"];
+    fields["Items Missing"] = entry["missing"];
+    if (entry["at"].as<long long>() > 0) {
+      char isoTimestamp[ISO_TIMESTAMP_SIZE];
+      formatIsoTimestamp((time_t)entry["at"].as<long long>(), isoTimestamp);
+      fields["Finished"] = isoTimestamp;
+    }
+  }
+
+  String url = "https://api.airtable.com/v0/" + String(AIRTABLE_BASE_ID) + "/" + urlEncode(AIRTABLE_SESSIONS_TABLE);
+  return airtablePatchRecords(url, payload) == (int)records.size();
+}
+
+// Network task only. Sends the journal in order and stops at the first failed batch,
+// which stays queued for the next flush. True once the journal is empty.
+// outDroppedReplaces (optional) counts replacements Airtable had no record for.
+bool journalFlush(int* outDroppedReplaces = nullptr) {
+  int droppedReplaces = 0;
+  if (outDroppedReplaces) {
+    *outDroppedReplaces = 0;
+  }
+  if (WiFi.status() != WL_CONNECTED || !ensureSpiffsMounted()) {
+    return false;
+  }
+  int batches = 0;
+  for (;;) {
+    JsonDocument batch;
+    size_t batchBytes = 0;
+    xSemaphoreTake(journalMutex, portMAX_DELAY);
+    bool haveBatch = journalReadBatch(batch, batchBytes);
+    xSemaphoreGive(journalMutex);
+    if (!haveBatch) {
+      if (batches > 0) {
+        Serial.printf("Airtable journal flushed (%d batch(es)).\n", batches);
+      }
+      return true;
+    }
+
+    JsonArray entries = batch.as<JsonArray>();
+    bool sent = entries.size() == 0 || // Only unreadable lines
+                (journalOpTargetsSessions(entries[0]["op"]) ? journalSendSessionBatch(entries)
+                                                            : journalSendEquipmentBatch(entries, droppedReplaces));
+    if (outDroppedReplaces) {
+      *outDroppedReplaces = droppedReplaces;
+    }
+    if (!sent) {
+      Serial.println("Airtable journal flush failed, remaining updates stay queued.");
+      return false;
+    }
+
+    xSemaphoreTake(journalMutex, portMAX_DELAY);
+    journalDropPrefix(batchBytes);
+    xSemaphoreGive(journalMutex);
+    batches++;
+  }
+}
+
+//==============================================================================
+// NETWORK TASK
+//==============================================================================
+// WiFi, NTP and every Airtable call run on their own task so the UI keeps drawing
+// and reading buttons while a request is in flight. The admin states post a job
+// and poll for its result. While a job runs the network task owns the equipment
+// list and bag globals; the waiting states do not touch them.
+enum NetJobType {
+  NET_JOB_CONNECT_WIFI,
+  NET_JOB_DISCONNECT_WIFI,
+  NET_JOB_FETCH_EQUIPMENT,
+  NET_JOB_FETCH_BAGS,
+  NET_JOB_REPLACE_TAG     // Uses the admin_* replacement globals
+};
+
+struct NetJob {
+  NetJobType type;
+};
+
+struct NetResult {
+  NetJobType type;
+  bool success;
+};
+
+QueueHandle_t netJobQueue = NULL;
+QueueHandle_t netResultQueue = NULL;
+
+bool netConnectForAdmin() {
+  if (WiFi.status() != WL_CONNECTED) {
+    connectWiFi(); // This function handles its own OLED status messages during connection
   } else {
-      Serial.println("Time not set, cannot generate ISO timestamp for Last Scanned.");
-      // Optionally, you could send a fixed past date or omit the field
-      // fieldsObject["Last Scanned"] = "1970-01-01T00:00:00Z"; // Or handle as needed
+    Serial.println("WiFi already connected.");
+    initTime();
+    oledShowStatusMessage("Admin Mode", "WiFi Ready", "", false, 1500); // Brief confirmation
   }
 
-  String postData;
-  serializeJson(updatePayload, postData);
-  Serial.println("Airtable Update POST data: " + postData);
-  
-  if (http.begin(url)) {
-    http.addHeader("Authorization", "Bearer " + String(AIRTABLE_API_KEY));
-    http.addHeader("Content-Type", "application/json");
-    http.setTimeout(HTTP_TIMEOUT_MS);
+  if (WiFi.status() != WL_CONNECTED) {
+    return false;
+  }
+  struct tm timeinfo_check;
+  if(!getLocalTime(&timeinfo_check, 1000) || timeinfo_check.tm_year < (2000-1900)){
+      Serial.println("Warning: Admin mode entered, NTP time might not be fully synced yet.");
+      // No need for an OLED warning here unless it blocks critical functionality.
+  }
+  journalFlush(); // Scans and sessions recorded while offline
+  return true;
+}
 
-    // Airtable uses PATCH for updating records
-    int httpCode = http.PATCH(postData); 
-    Serial.printf("Airtable PATCH request, HTTP Code: %d\n", httpCode);
+// The replacement is already in the journal (queued by the UI); deliver it and refresh.
+bool netReplaceTag() {
+  oledShowStatusMessage("Updating Airtable", admin_TargetOldUID_str.substring(0, 6) + "->" + admin_NewUID_str.substring(0, 6),
+                        admin_NewEquipmentName_str.substring(0, 18), true);
+  int droppedReplaces = 0;
+  if (!journalFlush(&droppedReplaces)) {
+    Serial.println("Error reported during Airtable update, replacement stays queued.");
+    oledShowStatusMessage("Update Queued", "Airtable not reached", "Retried later", false, 3000);
+    return false;
+  }
+  if (droppedReplaces > 0) {
+    Serial.println("Airtable has no record for the old UID, replacement dropped."); // Toast shown by the flush
+    return false;
+  }
+  oledShowStatusMessage("Update Success!", "", "", false, 2000);
+  Serial.println("Airtable update reported success. Attempting to re-fetch local list...");
+  // fetchEquipmentList() will display its own messages
+  if (fetchEquipmentList_Airtable()) {
+    Serial.println("Local equipment list refreshed successfully after update.");
+  } else {
+    Serial.println("Error re-fetching list after update. Advise manual fetch.");
+    oledShowStatusMessage("Airtable Updated", "List fetch FAILED", "Fetch manually", false, 3000);
+  }
+  return true;
+}
 
-    if (httpCode == HTTP_CODE_OK) {
-      String responsePayload = http.getString();
-      Serial.printf("Airtable Response: %s\n", responsePayload.substring(0, min(300, (int)responsePayload.length())).c_str());
-      // Check if the response contains the updated record, indicating success
-      DynamicJsonDocument responseDoc(1024);
-      deserializeJson(responseDoc, responsePayload);
-      if (responseDoc["records"] && responseDoc["records"].size() > 0) {
-         success = true;
-         oledShowStatusMessage("Update Success!", "", "", false, 2000);
+uint8_t netJobsOutstanding = 0; // Started and not finished yet, keeps the CPU out of light sleep
+
+void networkTask(void* parameter) {
+  NetJob job;
+  for (;;) {
+    if (xQueueReceive(netJobQueue, &job, portMAX_DELAY) != pdPASS) {
+      continue;
+    }
+    NetResult result = { job.type, false };
+    switch (job.type) {
+      case NET_JOB_CONNECT_WIFI:    result.success = netConnectForAdmin();          break;
+      case NET_JOB_DISCONNECT_WIFI: // Fire and forget, no result
+        disconnectWiFi();
+        __atomic_sub_fetch(&netJobsOutstanding, 1, __ATOMIC_SEQ_CST);
+        continue;
+      case NET_JOB_FETCH_EQUIPMENT: result.success = fetchEquipmentList_Airtable(); break;
+      case NET_JOB_FETCH_BAGS:      result.success = fetchAvailableBags_Airtable(); break;
+      case NET_JOB_REPLACE_TAG:     result.success = netReplaceTag();               break;
+    }
+    xQueueSend(netResultQueue, &result, portMAX_DELAY);
+    __atomic_sub_fetch(&netJobsOutstanding, 1, __ATOMIC_SEQ_CST);
+    wakeUiTask();
+  }
+}
+
+bool netJobStart(NetJobType type) {
+  NetJob job = { type };
+  __atomic_add_fetch(&netJobsOutstanding, 1, __ATOMIC_SEQ_CST);
+  if (xQueueSend(netJobQueue, &job, 0) != pdPASS) {
+    __atomic_sub_fetch(&netJobsOutstanding, 1, __ATOMIC_SEQ_CST);
+    Serial.println("Network job queue full, job not started.");
+    return false;
+  }
+  return true;
+}
+
+// Non-blocking. True once the result for 'type' is in; stale results of other job
+// types are dropped on the way.
+bool netJobPoll(NetJobType type, bool& outSuccess) {
+  NetResult result;
+  while (xQueueReceive(netResultQueue, &result, 0) == pdPASS) {
+    if (result.type == type) {
+      outSuccess = result.success;
+      return true;
+    }
+  }
+  return false;
+}
+
+//==============================================================================
+// NFC SCAN ENGINE
+//==============================================================================
+// The PN532 is armed with InListPassiveTarget and left to look for a card on its
+// own. It pulls IRQ low once the response is ready, and the ISR wakes the NFC task
+// so the I2C traffic only happens when a tag is actually present. Each detection
+// becomes an event on a FreeRTOS queue that the state handlers pop via readTagDetails().
+// During repack up to two tags are inlisted per detection, then released (HLTA)
+// so the next detection only sees the gear that has not been inventoried yet.
+struct NfcTagEvent {
+  uint8_t uid[UID_MAX_LENGTH]; // Max 7-byte UID for MIFARE tags
+  uint8_t uidLength;
+  uint8_t generation;       // Scan request the event belongs to, see nfcEngineSetEnabled()
+  char ndefName[32];        // NDEF Text Record, empty if none found
+  unsigned long detectedAt; // millis() of the IRQ edge
+};
+
+enum NfcEngineState {
+  NFC_ENGINE_IDLE,    // Not armed, (re)arm on next service
+  NFC_ENGINE_ARMED,   // Detection command running on the PN532
+  NFC_ENGINE_HOLDOFF  // Single-tag read done, re-arm at nfcRearmAt
+};
+
+// Tags detected lately; when full, a new tag replaces the least recently seen. A tag left on the pad is
+// detected again on every re-arm; while its entry is fresh that is "still present"
+// and no event is raised. Once it has not been seen for NFC_TAG_GONE_MS it has
+// left, and putting it back counts as a new arrival.
+enum NfcPresence {
+  NFC_TAG_ARRIVED,
+  NFC_TAG_STILL_PRESENT
+};
+struct NfcRecentTag {
+  UidKey uid;
+  unsigned long lastSeenAt;
+};
+
+// What is read from a tag after its UID. Every step beyond the UID costs InDataExchange
+// round-trips while the tag has to stay on the pad, so states ask only for what they use.
+enum NfcScanProfile {
+  NFC_SCAN_UID_ONLY,  // Anticollision only, no InDataExchange at all
+  NFC_SCAN_UID_NDEF,  // + pages 4-11 (2 READs) for the NDEF Text Record name
+  NFC_SCAN_FULL_DUMP  // + NTAG213 user memory (pages 4-39, 9 READs), hex dump on Serial
+};
+#define NTAG_USER_FIRST_PAGE        4
+#define NTAG_NDEF_PAGES             8       // Enough for a short Text Record
+#define NTAG213_USER_PAGES          36
+
+QueueHandle_t nfcEventQueue = NULL;
+// Owned by the NFC task
+bool nfcReaderReady = false;       // PN532 configured, see nfcReaderInit()
+bool nfcReaderInitAtStart = false; // Cold boot: configure the reader while setup() loads the list
+volatile NfcEngineState nfcEngineState = NFC_ENGINE_IDLE; // Also read by the light sleep scheduler
+volatile unsigned long nfcRearmAt = 0;
+bool nfcEngineEnabled = false;
+uint8_t nfcEngineMaxTargets = 1;   // Tags inlisted per detection (1 or PN532_MAX_TARGETS)
+NfcScanProfile nfcEngineProfile = NFC_SCAN_UID_ONLY;
+uint8_t nfcAppliedGeneration = 0;
+NfcRecentTag nfcRecentTags[NFC_RECENT_UID_SLOTS];
+uint8_t nfcRecentCount = 0;
+// Scan request posted by the UI task, applied by the NFC task
+portMUX_TYPE nfcRequestMux = portMUX_INITIALIZER_UNLOCKED;
+bool nfcRequestedEnabled = false;
+uint8_t nfcRequestedMaxTargets = 1;
+NfcScanProfile nfcRequestedProfile = NFC_SCAN_UID_ONLY;
+volatile uint8_t nfcRequestedGeneration = 0;
+volatile bool nfcIrqPending = false;
+volatile unsigned long nfcIrqTime = 0;
+
+void IRAM_ATTR onNfcIrq() {
+  nfcIrqPending = true;
+  nfcIrqTime = millis();
+  if (nfcTaskHandle != NULL) {
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(nfcTaskHandle, &higherPriorityTaskWoken);
+    portYIELD_FROM_ISR(higherPriorityTaskWoken);
+  }
+}
+
+// Basic NDEF parsing: looking for a Text Record (Type 'T') in NTAG pages 4-11.
+// This is a simplified parser and might not cover all NDEF text record variations.
+void parseNdefTextRecord(const uint8_t* pageBuffer, char* outName, size_t outNameSize) {
+  int recordOffset = 0; // Start of NDEF data within pageBuffer
+  outName[0] = '\0';
+
+  // Check for NDEF Message TLV (0x03)
+  if (pageBuffer[0] == 0x03) {
+    uint8_t ndefMessageLength = pageBuffer[1];
+    if (ndefMessageLength == 0xFF) { // Extended length format (not fully handled here)
+      // recordOffset = 4; // Skip 0x03 FF LL1 LL2
+      Serial.println("NDEF extended length format detected, parsing might be incomplete.");
+      // For simplicity, we'll proceed assuming short length or first record starts after TLV
+       recordOffset = 2; // Best guess for now
+    } else {
+      recordOffset = 2; // Skip 0x03 LEN
+    }
+  }
+  // Else, assume NDEF record starts at pageBuffer[0] if no Message TLV
+
+  // Now at 'recordOffset', expect the first NDEF Record Header
+  // (MB ME SR TNF) TypeLen PayloadLen Type StatusByte Lang... Text...
+  if (recordOffset < 28 && (pageBuffer[recordOffset] & 0x07) == 0x01) { // TNF = 0x01 (Well Known Type)
+    uint8_t typeLength = pageBuffer[recordOffset + 1];
+    uint8_t payloadLength = pageBuffer[recordOffset + 2]; // Note: can be 4 bytes if SR=0
+
+    // Check if it's a Text Record ('T')
+    if ((recordOffset + 3 + typeLength) < 32 && typeLength == 1 && pageBuffer[recordOffset + 3] == 'T') {
+      int textPayloadFieldOffset = recordOffset + 3 + typeLength; // Start of Text Payload Field (Status Byte)
+      uint8_t statusByte = pageBuffer[textPayloadFieldOffset];
+      uint8_t langCodeLength = statusByte & 0x3F; // Bits 0-5 of Status Byte
+      
+      int actualTextStartOffset = textPayloadFieldOffset + 1 + langCodeLength;
+      int actualTextLength = payloadLength - (1 + langCodeLength); // PayloadLen - StatusByte - LangCode
+
+      if (actualTextStartOffset < 32 && actualTextLength > 0 && (actualTextStartOffset + actualTextLength) <= 32) {
+        // Ensure copyLength doesn't exceed buffer or available data
+        int copyLength = min(actualTextLength, (int)(outNameSize - 1));
+        copyLength = min(copyLength, (int)(32 - actualTextStartOffset));
+
+        if (copyLength > 0) {
+          memcpy(outName, &pageBuffer[actualTextStartOffset], copyLength);
+          outName[copyLength] = '\0'; // Null-terminate the string
+          Serial.printf("NDEF Text Record found: %s\n", outName);
+        }
       } else {
-         oledShowStatusMessage("Update OK?", "Resp. unclear", "", false, 3000);
-         Serial.println("Update response OK, but record data not as expected in response.");
+        Serial.println("NDEF Text Record size/offset issue.");
       }
     } else {
-      String errorStr = http.getString();
-      Serial.printf("Airtable PATCH request failed. Response: %s\n", errorStr.c_str());
-      oledShowStatusMessage("Update Failed", "HTTP Err: " + String(httpCode), errorStr.substring(0,16), false, 4000);
+      Serial.println("NDEF Record is not a Text Record or type length mismatch.");
     }
-    http.end();
   } else {
-    Serial.println("HTTPClient begin() failed for Airtable PATCH.");
-    oledShowStatusMessage("Update Error", "HTTP Begin Fail", "", false, 3000);
+    Serial.println("No Well-Known NDEF Record found at expected offset or buffer too small.");
   }
-  return success;
 }
 
-bool fetchAvailableBags_Airtable() {
-  if (WiFi.status() != WL_CONNECTED) {
-    connectWiFi(); // Ensure WiFi is up, this also calls initTime()
-    if (WiFi.status() != WL_CONNECTED) {
-      oledShowStatusMessage("Bag Fetch Fail:", "No WiFi", "", false, 3000);
-      return false;
-    }
+void nfcEventQueuePush(const NfcTagEvent& event) {
+  if (xQueueSend(nfcEventQueue, &event, 0) != pdPASS) { // Full: drop the oldest event
+    NfcTagEvent dropped;
+    xQueueReceive(nfcEventQueue, &dropped, 0);
+    xQueueSend(nfcEventQueue, &event, 0);
+    Serial.println("NFC event queue full, oldest tag event dropped.");
+  }
+  wakeUiTask();
+}
+
+// Events from an earlier scan request are discarded here, so tags seen in a previous
+// state never leak into the next one even if the NFC task queued them late.
+bool nfcEventQueuePop(NfcTagEvent& outEvent) {
+  while (xQueueReceive(nfcEventQueue, &outEvent, 0) == pdPASS) {
+    if (outEvent.generation == nfcRequestedGeneration) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Forgets tags not seen for NFC_TAG_GONE_MS.
+void nfcRecentExpire(unsigned long now) {
+  uint8_t kept = 0;
+  for (uint8_t i = 0; i < nfcRecentCount; i++) {
+    if ((now - nfcRecentTags[i].lastSeenAt) < NFC_TAG_GONE_MS) {
+      nfcRecentTags[kept++] = nfcRecentTags[i];
+#ifdef DEBUG_NFC_VERBOSE
+    } else {
+      char uidHex[UID_HEX_BUFFER_SIZE];
+      uidBytesToHex(nfcRecentTags[i].uid.bytes, nfcRecentTags[i].uid.length, uidHex);
+      Serial.printf("NFC: Tag %s left\n", uidHex);
+#endif
+    }
+  }
+  nfcRecentCount = kept;
+}
+
+NfcPresence nfcRecentSeen(const uint8_t* uid, uint8_t uidLength, unsigned long now) {
+  for (uint8_t i = 0; i < nfcRecentCount; i++) {
+    NfcRecentTag& recent = nfcRecentTags[i];
+    if (recent.uid.length == uidLength && memcmp(recent.uid.bytes, uid, uidLength) == 0) {
+      bool stillPresent = (now - recent.lastSeenAt) < NFC_TAG_GONE_MS; // Not swept yet but already gone
+      recent.lastSeenAt = now;
+      return stillPresent ? NFC_TAG_STILL_PRESENT : NFC_TAG_ARRIVED;
+    }
+  }
+  uint8_t slot = nfcRecentCount;
+  if (nfcRecentCount < NFC_RECENT_UID_SLOTS) {
+    nfcRecentCount++;
+  } else {
+    slot = 0;
+    for (uint8_t i = 1; i < NFC_RECENT_UID_SLOTS; i++) {
+      if ((now - nfcRecentTags[i].lastSeenAt) > (now - nfcRecentTags[slot].lastSeenAt)) {
+        slot = i;
+      }
+    }
+  }
+  nfcRecentTags[slot].uid.length = uidLength;
+  memcpy(nfcRecentTags[slot].uid.bytes, uid, uidLength);
+  nfcRecentTags[slot].lastSeenAt = now;
+  return NFC_TAG_ARRIVED;
+}
+
+// NFC task side, with the I2C mutex held. Runs on the first scan request after a
+// wake (or straight away on a cold boot), so a wake to the menu never waits for it.
+bool nfcReaderInit() {
+  nfc.begin();
+  uint32_t nfc_firmware_version = nfc.getFirmwareVersion();
+  if (!nfc_firmware_version) {
+    Serial.println("CRITICAL: PN532 NFC reader not found or failed to initialize.");
+    oledShowStatusMessage("Error:", "NFC FAIL!", "", false, 3000);
+    return false;
+  }
+  Serial.printf("Found PN5%X NFC chip. Firmware ver. %d.%d\n",
+                (nfc_firmware_version >> 24) & 0xFF,
+                (nfc_firmware_version >> 16) & 0xFF,
+                (nfc_firmware_version >> 8) & 0xFF);
+  nfc.SAMConfig(); // Configure Secure Access Module
+  Serial.println("NFC Reader Ready.");
+  nfcReaderReady = true;
+  return true;
+}
+
+void nfcEngineSetup() {
+  nfcEventQueue = xQueueCreate(NFC_EVENT_QUEUE_SIZE, sizeof(NfcTagEvent));
+  pinMode(PN532_IRQ, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(PN532_IRQ), onNfcIrq, FALLING);
+}
+
+// States that expect tags keep the engine armed. Everywhere else the PN532 idles.
+bool nfcStateWantsScanning(SystemState state) {
+  return state == REPACKING_SCAN ||
+         state == ADMIN_MODE_UNLOCK ||
+         state == ADMIN_REPLACE_SCAN_OLD ||
+         state == ADMIN_REPLACE_SCAN_NEW;
+}
+
+// Only the repack inventory benefits from reading several tags at once; the admin
+// states want exactly the one tag the user is holding.
+uint8_t nfcMaxTargetsForState(SystemState state) {
+  return (state == REPACKING_SCAN) ? PN532_MAX_TARGETS : 1;
+}
+
+// Repack, admin unlock and the old tag of a replacement are matched on UID alone.
+// Only a new replacement tag brings the item name (NDEF) into the list.
+NfcScanProfile nfcScanProfileForState(SystemState state) {
+  if (state == ADMIN_REPLACE_SCAN_NEW) {
+#ifdef DEBUG_NFC_VERBOSE
+    return NFC_SCAN_FULL_DUMP;
+#else
+    return NFC_SCAN_UID_NDEF;
+#endif
+  }
+  return NFC_SCAN_UID_ONLY;
+}
+
+// UI task side: posts the new scan request and wakes the NFC task, which aborts
+// any running detection before switching over.
+void nfcEngineSetEnabled(bool enabled, uint8_t maxTargets, NfcScanProfile profile) {
+  portENTER_CRITICAL(&nfcRequestMux);
+  nfcRequestedEnabled = enabled;
+  nfcRequestedMaxTargets = maxTargets;
+  nfcRequestedProfile = profile;
+  nfcRequestedGeneration++;
+  portEXIT_CRITICAL(&nfcRequestMux);
+  if (nfcTaskHandle != NULL) {
+    xTaskNotifyGive(nfcTaskHandle);
   }
+}
 
-  oledShowStatusMessage("Fetching Bags...", "From Airtable", "", true);
-  Serial.println("Fetching available bags from Airtable 'Bags' table...");
-  availableBagCount = 0; // Clear current list
-
-  // Construct URL for the "Bags" table - IMPORTANT: Use the EXACT name of your "Bags" table.
-  // If your Bags table is NOT named "Bags", change it here.
-  String bagsTableNameEncoded = urlEncode("Bags"); // <--- CHANGE "Bags" IF YOUR TABLE HAS A DIFFERENT NAME
-  String url = "https://api.airtable.com/v0/" + String(AIRTABLE_BASE_ID) + "/" + bagsTableNameEncoded +
-               "?fields%5B%5D=Bag%20Name&view=Grid%20view"; // Assuming primary field is "Bag Name"
-               // If your primary field in "Bags" table is different, change "Bag%20Name"
+// NFC task side. Called with the I2C mutex held.
+void nfcEngineApplyRequest() {
+  if (nfcAppliedGeneration == nfcRequestedGeneration) {
+    return;
+  }
+  portENTER_CRITICAL(&nfcRequestMux);
+  bool enabled = nfcRequestedEnabled;
+  uint8_t maxTargets = nfcRequestedMaxTargets;
+  NfcScanProfile profile = nfcRequestedProfile;
+  uint8_t generation = nfcRequestedGeneration;
+  portEXIT_CRITICAL(&nfcRequestMux);
+
+  if (nfcEngineState == NFC_ENGINE_ARMED) {
+    nfc.abortCommand(); // Stop the pending InListPassiveTarget
+  }
+  if (enabled && !nfcReaderReady && !nfcReaderInit()) {
+    enabled = false; // Retried with the next scan request
+  }
+  nfcEngineEnabled = enabled;
+  nfcEngineMaxTargets = maxTargets;
+  nfcEngineProfile = profile;
+  nfcEngineState = NFC_ENGINE_IDLE;
+  nfcRecentCount = 0; // A tag already on the pad counts as new in the next state
+  nfcAppliedGeneration = generation;
+}
 
-  bool success = false;
-  HTTPClient http;
+// Called by the NFC task with the I2C mutex held. Never waits for a card, only talks
+// to the PN532 when arming or when IRQ says a response is ready.
+void nfcEngineService() {
+  if (!nfcEngineEnabled) {
+    return;
+  }
+  nfcRecentExpire(millis());
 
-  if (http.begin(url)) {
-    http.addHeader("Authorization", "Bearer " + String(AIRTABLE_API_KEY));
-    http.setTimeout(HTTP_TIMEOUT_MS);
-    int httpCode = http.GET();
-    Serial.printf("Airtable (Bags) GET request, HTTP Code: %d\n", httpCode);
+  switch (nfcEngineState) {
+    case NFC_ENGINE_HOLDOFF:
+      if ((long)(millis() - nfcRearmAt) < 0) {
+        break;
+      }
+      nfcEngineState = NFC_ENGINE_IDLE;
+      // Fall through
+    case NFC_ENGINE_IDLE:
+      if (nfc.startPassiveTargetIDDetection(PN532_MIFARE_ISO14443A, nfcEngineMaxTargets)) {
+        nfcIrqPending = false; // Edge from the ACK frame, not a card
+        nfcEngineState = NFC_ENGINE_ARMED;
+      } else {
+        Serial.println("NFC: Failed to arm tag detection, retrying.");
+      }
+      break;
 
-    if (httpCode == HTTP_CODE_OK) {
-      String payload = http.getString();
-      DynamicJsonDocument doc(2048); // Adjust size if you have many bags or very long names
-      DeserializationError error = deserializeJson(doc, payload);
+    case NFC_ENGINE_ARMED: {
+      // Level check as well, an edge can be missed while interrupts are masked
+      if (!nfcIrqPending && digitalRead(PN532_IRQ) != LOW) {
+        break;
+      }
+      unsigned long irqTime = nfcIrqPending ? nfcIrqTime : millis();
+      nfcIrqPending = false;
+
+      uint8_t uids[PN532_MAX_TARGETS][7];
+      uint8_t uidLengths[PN532_MAX_TARGETS];
+      uint8_t targetsFound = nfc.readDetectedPassiveTargetIDs(uids, uidLengths, nfcEngineMaxTargets);
+      if (targetsFound == 0) {
+        nfcEngineState = NFC_ENGINE_IDLE; // Bad response or collision, just re-arm
+        break;
+      }
 
-      if (error) {
-        Serial.printf("Bags JSON Deserialization Failed: %s\n", error.c_str());
-        oledShowStatusMessage("Bag Fetch Error:", "JSON Parse Fail", error.c_str(), false, 3000);
-      } else {
-        JsonArray records = doc["records"].as<JsonArray>();
-        if (records.isNull()) {
-            Serial.println("Fetched Bags JSON 'records' field is not an array or missing.");
-            oledShowStatusMessage("Bag Fetch Error:", "No 'records' array", "", false, 3000);
-        } else {
-          for (JsonObject record : records) {
-            if (availableBagCount >= MAX_BAGS_TO_LIST) {
-              Serial.println("Max bags to list reached.");
-              break;
-            }
-            const char* bagNameStr = record["fields"]["Bag Name"]; // <--- CHANGE "Bag Name" if your primary field has a different name
-            const char* bagIdStr = record["id"]; // This is the Airtable Record ID
-
-            if (bagNameStr && bagIdStr) {
-              availableBagNames[availableBagCount] = String(bagNameStr);
-              availableBagIDs[availableBagCount] = String(bagIdStr);
-              Serial.printf("Found Bag: Name=%s, ID=%s\n", bagNameStr, bagIdStr);
-              availableBagCount++;
-            } else {
-              Serial.println("Skipping bag with missing Name or ID in JSON.");
+      for (uint8_t t = 0; t < targetsFound; t++) {
+        if (nfcRecentSeen(uids[t], uidLengths[t], millis()) == NFC_TAG_STILL_PRESENT) {
+          continue; // Duplicate read of a tag that never left, no event and no page reads
+        }
+        NfcTagEvent event;
+        memcpy(event.uid, uids[t], uidLengths[t]);
+        event.uidLength = uidLengths[t];
+        event.generation = nfcAppliedGeneration;
+        event.ndefName[0] = '\0';
+        event.detectedAt = irqTime;
+
+        // NTAG2xx keep NDEF data from page 4, 4 bytes per page. Every READ returns
+        // 4 pages, so the name costs 2 PN532 round-trips and a full dump 9.
+        // Page reads always address Tg 1, so only the first tag gets a name.
+        if (t == 0 && nfcEngineProfile != NFC_SCAN_UID_ONLY) {
+          uint8_t pageBuffer[NTAG213_USER_PAGES * 4];
+          uint8_t pages = (nfcEngineProfile == NFC_SCAN_FULL_DUMP) ? NTAG213_USER_PAGES : NTAG_NDEF_PAGES;
+          if (nfc.ntag2xx_ReadPages(NTAG_USER_FIRST_PAGE, pages, pageBuffer)) {
+            parseNdefTextRecord(pageBuffer, event.ndefName, sizeof(event.ndefName));
+            if (nfcEngineProfile == NFC_SCAN_FULL_DUMP) {
+              Serial.printf("NFC: Pages %u-%u:\n", NTAG_USER_FIRST_PAGE, NTAG_USER_FIRST_PAGE + pages - 1);
+              nfc.PrintHexChar(pageBuffer, pages * 4);
             }
-          }
-          Serial.printf("Loaded %d available bags from Airtable.\n", availableBagCount);
-          if (availableBagCount > 0) {
-            oledShowStatusMessage("Bag List OK!", String(availableBagCount) + " bags found.", "", false, 2000);
-            success = true;
           } else {
-            oledShowStatusMessage("No Bags Found", "Check Airtable", "'Bags' Table", false, 3000);
+            Serial.printf("Failed to read NTAG pages %u-%u.\n", NTAG_USER_FIRST_PAGE, NTAG_USER_FIRST_PAGE + pages - 1);
           }
         }
+
+#ifdef DEBUG_NFC_VERBOSE
+        Serial.printf("NFC: Tag event (%u/%u) after %lu ms\n", t + 1, targetsFound, millis() - event.detectedAt);
+#endif
+        nfcEventQueuePush(event);
       }
-    } else {
-      Serial.printf("Airtable (Bags) GET request failed, HTTP Code: %d\n", httpCode);
-      oledShowStatusMessage("Bag Fetch Fail", "HTTP Err: " + String(httpCode), "", false, 3000);
+
+      if (nfcEngineMaxTargets > 1) {
+        // Anti-reselect: halt everything just inventoried so it stays quiet while
+        // the rest of the pile is read. Re-arm straight away: duplicates are filtered
+        // above, so the next tag swiped in is accepted without waiting.
+        nfc.inRelease(0);
+        nfcEngineState = NFC_ENGINE_IDLE;
+      } else {
+        // A single tag stays selected and would answer every re-arm at once while
+        // it rests on the pad, keeping the bus busy and the CPU out of light sleep.
+        // Waiting less than NFC_TAG_GONE_MS still sees it as present when it is.
+        nfcRearmAt = millis() + NFC_REARM_HOLDOFF_MS;
+        nfcEngineState = NFC_ENGINE_HOLDOFF;
+      }
+      break;
     }
-    http.end();
-  } else {
-    Serial.println("HTTPClient begin() failed for Airtable (Bags) URL.");
-    oledShowStatusMessage("Bag Fetch Err:", "HTTP Begin Fail", "", false, 3000);
   }
-  return success;
+}
+
+// True when the next service has to talk to the PN532: a new scan request, arming,
+// or a response signalled on IRQ. Otherwise the wake-up leaves the bus alone.
+bool nfcEngineNeedsBus() {
+  if (nfcAppliedGeneration != nfcRequestedGeneration) {
+    return true;
+  }
+  if (!nfcEngineEnabled) {
+    return false;
+  }
+  if (nfcEngineState == NFC_ENGINE_HOLDOFF) {
+    return (long)(millis() - nfcRearmAt) >= 0;
+  }
+  return nfcEngineState == NFC_ENGINE_IDLE || nfcIrqPending || digitalRead(PN532_IRQ) == LOW;
+}
+
+// Sleeps until the IRQ ISR or a new scan request notifies it. The timeout covers
+// an IRQ edge that was missed while interrupts were masked.
+void nfcTask(void* parameter) {
+  if (nfcReaderInitAtStart) {
+    i2cBusAcquire(I2C_CLIENT_NFC);
+    nfcReaderInit();
+    i2cBusRelease();
+    bootStageDone("nfc init (nfc task)");
+  }
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(NFC_TASK_POLL_MS));
+    if (!nfcEngineNeedsBus()) {
+      continue;
+    }
+    i2cBusAcquire(I2C_CLIENT_NFC);
+    nfcEngineApplyRequest();
+    nfcEngineService();
+    i2cBusRelease();
+  }
 }
 
 //==============================================================================
 // NFC TAG READING
 //==============================================================================
+// Non-blocking: returns the next tag detected by the scan engine, if any.
 bool readTagDetails(String& outUidString, String& outNdefName) {
-  uint8_t uid[7]; // Max 7-byte UID for MIFARE tags
-  uint8_t uidLength;
-  bool nfcReadSuccess = false;
+  NfcTagEvent event;
   outUidString = "";
   outNdefName = "";
 
-  // Try to read a passive ISO14443A card
-  if (nfc.readPassiveTargetID(PN532_MIFARE_ISO14443A, uid, &uidLength, 50)) { // 50ms timeout
-    outUidString = uidBytesToHexString(uid, uidLength);
-    nfcReadSuccess = true; // At least UID was read
-
-    // Attempt to read NDEF data, specifically for NTAG2xx series
-    // NTAGs typically store NDEF data starting from page 4.
-    // Each page is 4 bytes. Read 8 pages (32 bytes) to capture a short NDEF message.
-    uint8_t pageBuffer[32]; 
-    bool allPagesReadOk = true;
-    for (int i = 0; i < 8; ++i) {
-      if (!nfc.ntag2xx_ReadPage(4 + i, pageBuffer + (i * 4))) {
-        allPagesReadOk = false;
-        Serial.println("Failed to read NTAG page: " + String(4 + i));
-        break;
-      }
-    }
-
-    if (allPagesReadOk) {
-      // Basic NDEF parsing: looking for a Text Record (Type 'T')
-      // This is a simplified parser and might not cover all NDEF text record variations.
-      int recordOffset = 0; // Start of NDEF data within pageBuffer
-
-      // Check for NDEF Message TLV (0x03)
-      if (pageBuffer[0] == 0x03) {
-        uint8_t ndefMessageLength = pageBuffer[1];
-        if (ndefMessageLength == 0xFF) { // Extended length format (not fully handled here)
-          // recordOffset = 4; // Skip 0x03 FF LL1 LL2
-          Serial.println("NDEF extended length format detected, parsing might be incomplete.");
-          // For simplicity, we'll proceed assuming short length or first record starts after TLV
-           recordOffset = 2; // Best guess for now
-        } else {
-          recordOffset = 2; // Skip 0x03 LEN
-        }
-      }
-      // Else, assume NDEF record starts at pageBuffer[0] if no Message TLV
-
-      // Now at 'recordOffset', expect the first NDEF Record Header
-      // (MB ME SR TNF) TypeLen PayloadLen Type StatusByte Lang... Text...
-      if (recordOffset < 28 && (pageBuffer[recordOffset] & 0x07) == 0x01) { // TNF = 0x01 (Well Known Type)
-        uint8_t typeLength = pageBuffer[recordOffset + 1];
-        uint8_t payloadLength = pageBuffer[recordOffset + 2]; // Note: can be 4 bytes if SR=0
-
-        // Check if it's a Text Record ('T')
-        if ((recordOffset + 3 + typeLength) < 32 && typeLength == 1 && pageBuffer[recordOffset + 3] == 'T') {
-          int textPayloadFieldOffset = recordOffset + 3 + typeLength; // Start of Text Payload Field (Status Byte)
-          uint8_t statusByte = pageBuffer[textPayloadFieldOffset];
-          uint8_t langCodeLength = statusByte & 0x3F; // Bits 0-5 of Status Byte
-          
-          int actualTextStartOffset = textPayloadFieldOffset + 1 + langCodeLength;
-          int actualTextLength = payloadLength - (1 + langCodeLength); // PayloadLen - StatusByte - LangCode
-
-          if (actualTextStartOffset < 32 && actualTextLength > 0 && (actualTextStartOffset + actualTextLength) <= 32) {
-            char nameBuffer[32]; // Temporary buffer for the text
-            // Ensure copyLength doesn't exceed buffer or available data
-            int copyLength = min(actualTextLength, (int)(sizeof(nameBuffer) - 1));
-            copyLength = min(copyLength, (int)(32 - actualTextStartOffset));
-
-            if (copyLength > 0) {
-              memcpy(nameBuffer, &pageBuffer[actualTextStartOffset], copyLength);
-              nameBuffer[copyLength] = '\0'; // Null-terminate the string
-              outNdefName = String(nameBuffer);
-              Serial.println("NDEF Text Record found: " + outNdefName);
-            }
-          } else {
-            Serial.println("NDEF Text Record size/offset issue.");
-          }
-        } else {
-          Serial.println("NDEF Record is not a Text Record or type length mismatch.");
-        }
-      } else {
-        Serial.println("No Well-Known NDEF Record found at expected offset or buffer too small.");
-      }
-    } else {
-      Serial.println("Failed to read sufficient NDEF pages for parsing.");
-    }
-  } // End of successful UID read
-  
-  return nfcReadSuccess; // True if UID was read, NDEF name is bonus
+  if (!nfcEventQueuePop(event)) {
+    return false;
+  }
+  outUidString = uidBytesToHexString(event.uid, event.uidLength);
+  outNdefName = String(event.ndefName);
+  return true; // True if UID was read, NDEF name is bonus
 }
 
 
@@ -877,77 +3329,69 @@ bool readTagDetails(String& outUidString, String& outNdefName) {
 // REPACK SESSION LOGIC
 //==============================================================================
 void markAllItemsUsedInitially() {
-  for (int i = 0; i < currentMaxItems; i++) {
-    usedTagsInitially[i] = true;
-    foundTagsDuringRepack[i] = false; // Reset found status for new repack
+  if (equipment.count > 0) {
+    bitsetSetAll(equipment.usedInitially, equipment.count);
+    bitsetClearAll(equipment.foundInRepack, equipment.count); // Reset found status for new repack
   }
+  equipment.usedInitiallyCount = equipment.count;
+  equipment.foundCount = 0;
+  equipment.missingCount = equipment.count;
   Serial.println("All items in list marked as 'Initially OUT' for repack session.");
   allRepackItemsScanned = false; // Reset this flag
 }
 
 void resetFoundTagsForRepack() {
-  for (int i = 0; i < currentMaxItems; i++) {
-    foundTagsDuringRepack[i] = false;
+  if (equipment.count > 0) {
+    bitsetClearAll(equipment.foundInRepack, equipment.count);
   }
+  equipment.foundCount = 0;
+  equipment.missingCount = equipment.usedInitiallyCount;
   allRepackItemsScanned = false;
   Serial.println("Found tags reset for current repack scanning phase.");
 }
 
 int usedTagsInitiallyCount() {
-  int count = 0;
-  for (int i = 0; i < currentMaxItems; i++) {
-    if (usedTagsInitially[i]) {
-      count++;
-    }
-  }
-  return count;
+  return equipment.usedInitiallyCount;
 }
 
-void processScannedRepackTag(const String& scannedUID) {
-  bool matched = false;
-  for (int i = 0; i < currentMaxItems; i++) {
-    if (compareUidStrings(scannedUID, currentExpectedUIDStrings[i])) {
-      matched = true;
-      String itemName = currentExpectedItemNames[i];
-      Serial.printf("Repack Scan: Matched '%s' (UID: %s)\n", itemName.c_str(), scannedUID.c_str());
-      oledShowStatusMessage("Scanned:", itemName.substring(0, 18), scannedUID.substring(0, 8) + "...", false, 1500);
-      
-      if (!foundTagsDuringRepack[i]) {
-        foundTagsDuringRepack[i] = true;
-      } else {
-        Serial.println("(Item already scanned in this repack session)");
-        oledShowStatusMessage("Already Scanned!", itemName.substring(0, 18), "", false, 1000);
+int missingRepackItemsCount() { // Initially "out" and not scanned back yet
+  return equipment.missingCount;
+}
+
+void processScannedRepackTag(const uint8_t* uid, uint8_t uidLength) {
+  char uidHex[UID_HEX_BUFFER_SIZE];
+  char uidShort[12]; // First 8 hex chars + "..."
+  uidBytesToHex(uid, uidLength, uidHex);
+  snprintf(uidShort, sizeof(uidShort), "%.8s...", uidHex);
+
+  int i = findItemIndexByUid(uid, uidLength);
+  if (i >= 0) {
+    String itemName = equipmentName(i);
+    if (!bitsetTest(equipment.foundInRepack, i)) {
+      Serial.printf("Repack Scan: Matched '%s' (UID: %s)\n", itemName.c_str(), uidHex);
+      oledShowStatusMessage("Scanned:", itemName.substring(0, 18), uidShort, false, 1500);
+      bitsetSet(equipment.foundInRepack, i);
+      equipment.foundCount++;
+      if (bitsetTest(equipment.usedInitially, i)) {
+        equipment.missingCount--; // Only items that were out can stop being missing
       }
-      break; // Found the item, no need to check further
+    } else {
+      Serial.printf("Repack Scan: '%s' already scanned in this session (UID: %s)\n", itemName.c_str(), uidHex);
+      oledShowStatusMessage("Already Scanned!", itemName.substring(0, 18), "", false, 1000);
     }
-  }
-
-  if (!matched) {
-    Serial.printf("Unknown Tag Scanned during Repack: %s\n", scannedUID.c_str());
-    oledShowStatusMessage("Unknown Tag!", scannedUID.substring(0, 8) + "...", "", false, 1500);
-  }
-
-  // Check if all items that were initially marked as "used" are now "found"
-  bool allDone = true;
-  if (usedTagsInitiallyCount() == 0) { // If no items were meant to be repacked
-      allDone = (currentMaxItems > 0); // Considered done if list isn't empty but nothing was "out"
-                                       // or false if you want a specific "nothing to repack" state.
-                                       // Let's say, if nothing was out, it's not "all packed" in the typical sense.
-      allDone = false; 
   } else {
-      for (int i = 0; i < currentMaxItems; i++) {
-          if (usedTagsInitially[i] && !foundTagsDuringRepack[i]) {
-              allDone = false; // At least one "used" item is still missing
-              break;
-          }
-      }
+    Serial.printf("Unknown Tag Scanned during Repack: %s\n", uidHex);
+    oledShowStatusMessage("Unknown Tag!", uidShort, "", false, 1500);
   }
-  allRepackItemsScanned = allDone;
+
+  // All items that were initially marked as "used" are now "found". If nothing was
+  // out, it's not "all packed" in the typical sense.
+  allRepackItemsScanned = (equipment.usedInitiallyCount > 0 && equipment.missingCount == 0);
 }
 
 void printCurrentBagStatusToSerial() {
   Serial.println("--- Current Bag Status (Serial Log) ---");
-  if (currentMaxItems == 0) {
+  if (equipment.count == 0) {
     Serial.println("(No equipment list loaded)");
     return;
   }
@@ -955,56 +3399,50 @@ void printCurrentBagStatusToSerial() {
   int presentInBagCount = 0;
   int stillOutstandingCount = 0; 
   
-  for (int i = 0; i < currentMaxItems; i++) {
-    String itemStatusPrefix = "[AVAIL]"; // Default: available, not involved in current repack session
-    if (usedTagsInitially[i]) { // Was this item part of the initial "out" set?
-        if (foundTagsDuringRepack[i]) {
+  char uidHex[UID_HEX_BUFFER_SIZE];
+  for (uint16_t i = 0; i < equipment.count; i++) {
+    const char* itemStatusPrefix = "[AVAIL]"; // Default: available, not involved in current repack session
+    bool found = bitsetTest(equipment.foundInRepack, i);
+    if (bitsetTest(equipment.usedInitially, i)) { // Was this item part of the initial "out" set?
+        if (found) {
             itemStatusPrefix = "[IN]   "; // Was out, now scanned back in
             presentInBagCount++;
         } else {
             itemStatusPrefix = "[OUT]  "; // Was out, and still not scanned back
             stillOutstandingCount++;
         }
-    } else if (foundTagsDuringRepack[i]) { // Scanned, but wasn't initially marked "out"
+    } else if (found) { // Scanned, but wasn't initially marked "out"
         itemStatusPrefix = "[UNEXP]"; // Unexpectedly found (e.g., added without being on "out" list)
         presentInBagCount++; // Still counts as present
     }
-    Serial.println(itemStatusPrefix + " " + currentExpectedItemNames[i] + " (UID: " + currentExpectedUIDStrings[i] + ")");
+    equipmentUidHex(i, uidHex);
+    Serial.printf("%s %s (UID: %s)\n", itemStatusPrefix, equipmentName(i), uidHex);
   }
 
   Serial.printf("Summary: Scanned In: %d, Initially Used: %d, Still Outstanding: %d, Total List: %d\n",
-    presentInBagCount, usedTagsInitiallyCount(), stillOutstandingCount, currentMaxItems);
+    presentInBagCount, usedTagsInitiallyCount(), stillOutstandingCount, equipment.count);
   Serial.println("---------------------------------------");
 }
 
 void displayBagStatusSummaryOLED() {
-  if (currentMaxItems == 0) {
+  if (equipment.count == 0) {
     oledShowStatusMessage("Bag Status:", "No List!", "", true);
     return;
   }
 
-  int itemsScannedThisRepack = 0;
-  int itemsStillMissingFromInitial = 0;
+  int itemsScannedThisRepack = equipment.foundCount;
+  int itemsStillMissingFromInitial = missingRepackItemsCount();
   int initialItemsToFind = usedTagsInitiallyCount();
-
-  for (int i = 0; i < currentMaxItems; i++) {
-    if (foundTagsDuringRepack[i]) { 
-      itemsScannedThisRepack++;
-    }
-    if (usedTagsInitially[i] && !foundTagsDuringRepack[i]) {
-      itemsStillMissingFromInitial++;
-    }
-  }
   
   String line1 = "Repack: " + String(itemsScannedThisRepack) + "/" + String(initialItemsToFind);
   String line2 = "Missing: " + String(itemsStillMissingFromInitial);
-  String line3 = "Total List: " + String(currentMaxItems);
+  String line3 = "Total List: " + String(equipment.count);
   oledShowStatusMessage(line1, line2, line3, true); // Persistent display
 }
 
 void reportSessionOutcomeToSerial() {
   Serial.println("--- Repack Session Outcome ---");
-  if (currentMaxItems == 0) {
+  if (equipment.count == 0) {
     Serial.println("(No equipment list loaded for this session)");
     return;
   }
@@ -1019,9 +3457,11 @@ void reportSessionOutcomeToSerial() {
   int missingItemCount = 0;
   bool anyItemsMissing = false;
   Serial.println("Items NOT scanned back (that were initially 'OUT'):");
-  for (int i = 0; i < currentMaxItems; i++) {
-    if (usedTagsInitially[i] && !foundTagsDuringRepack[i]) {
-      Serial.println("- " + currentExpectedItemNames[i] + " (UID: " + currentExpectedUIDStrings[i] + ")");
+  char uidHex[UID_HEX_BUFFER_SIZE];
+  for (uint16_t i = 0; i < equipment.count; i++) {
+    if (bitsetTest(equipment.usedInitially, i) && !bitsetTest(equipment.foundInRepack, i)) {
+      equipmentUidHex(i, uidHex);
+      Serial.printf("- %s (UID: %s)\n", equipmentName(i), uidHex);
       missingItemCount++;
       anyItemsMissing = true;
     }
@@ -1036,22 +3476,13 @@ void reportSessionOutcomeToSerial() {
 }
 
 void displaySessionOutcomeOLED() {
-  int missingItemCount = 0;
-  bool anyMissing = false;
   int initialItemsOut = usedTagsInitiallyCount();
+  int missingItemCount = missingRepackItemsCount();
+  bool anyMissing = (missingItemCount > 0);
 
-  if (currentMaxItems > 0 && initialItemsOut > 0) {
-    for (int i = 0; i < currentMaxItems; i++) {
-      if (usedTagsInitially[i] && !foundTagsDuringRepack[i]) {
-        anyMissing = true;
-        missingItemCount++;
-      }
-    }
-  }
-
-  if (!anyMissing && currentMaxItems > 0 && initialItemsOut > 0) {
+  if (!anyMissing && equipment.count > 0 && initialItemsOut > 0) {
     oledShowStatusMessage("🎉 WELL DONE! 🎉", "All items packed!", "", true);
-  } else if (currentMaxItems == 0 || initialItemsOut == 0) {
+  } else if (equipment.count == 0 || initialItemsOut == 0) {
     oledShowStatusMessage("Session Done", "(No items out", "or list empty)", true);
   } else { // Items were out, and some are still missing
     String line2 = String(missingItemCount) + " item(s) still";
@@ -1071,9 +3502,9 @@ void displayCurrentMenuOnOLED() {
     // Assuming oledDisplayMenu is a generic function you still want to use for simple menus
     // It will handle its own title, items, count, and selection display
     oledDisplayMenu("MAIN MENU", items, 2, currentMenuSelection); 
-    // oledDisplayMenu should end with oledShow() and set redrawOled = false;
-    // If oledDisplayMenu doesn't set redrawOled, uncomment the line below
-    // redrawOled = false; 
+    // oledDisplayMenu ends with oledShow() but leaves the flag alone; left set,
+    // loop() would never reach uiIdleWait() while the menu is up
+    redrawOled = false;
 
   } else if (currentMenuScreen == ADMIN_MENU_SCREEN) {
     // --- Custom Drawing Logic for Admin Menu ---
@@ -1159,6 +3590,7 @@ void handleIdleMenuState() {
   }
 
   // Check for inactivity timeout to initiate deep sleep
+  uiWakeBy(lastActivityTime + DEEP_SLEEP_TIMEOUT_MS + 1);
   if ((millis() - lastActivityTime) > DEEP_SLEEP_TIMEOUT_MS) {
     Serial.println("IDLE_MENU: Inactivity timeout. Preparing for deep sleep.");
     
@@ -1167,11 +3599,13 @@ void handleIdleMenuState() {
     savedCurrentMenuScreen = currentMenuScreen; // Should be MAIN_MENU if in this state handler
     savedCurrentMenuSelection = currentMenuSelection;
     rtcDataIsValid = true; // Mark RTC data as valid for next wake-up
+    saveRtcSnapshot();     // Lets the wake skip SPIFFS
 
     oledClear();
     oledPrint(0, 0, "Sleeping...");
     oledShow();
     delay(1000); // Brief display of "Sleeping..."
+    i2cBusAcquire(I2C_CLIENT_OLED); // Held into sleep, keeps the NFC task off the bus
     display.ssd1306_command(SSD1306_DISPLAYOFF); // Turn off OLED panel to save power
 
     // Configure ESP32 to wake up on any button press (HIGH signal)
@@ -1189,21 +3623,21 @@ void handleRepackSessionStartConfirmState() {
     if (currentAssignedBagID.isEmpty()) {
       Serial.println("Repack Confirm: No equipment list loaded. C: Back to Menu.");
       oledShowStatusMessage("No Active Bag!", "Admin->Fetch", "C: Menu", true);
-    } else if (currentMaxItems == 0) { // Check if the list for the active bag is loaded/empty
+    } else if (equipment.count == 0) { // Check if the list for the active bag is loaded/empty
       Serial.println("Repack Confirm: Equipment list for " + currentAssignedBagName + " is empty. C: Back to Menu.");
       oledShowStatusMessage("List Empty For:", currentAssignedBagName.substring(0,18), "Fetch in Admin. C:Menu", true);
     } else {
       Serial.println("Repack Confirm: Start session for " + currentAssignedBagName + "? A=Yes, B=No/Back.");
       String line1 = "Start Repack for:";
       String line2 = currentAssignedBagName.substring(0,18); // Show current bag name
-      String line3 = String(currentMaxItems) + " items. A:Yes B:No"; // Removed "/Back" as B is just No
+      String line3 = String(equipment.count) + " items. A:Yes B:No"; // Removed "/Back" as B is just No
       oledShowStatusMessage(line1, line2, line3, true);
     }
     oledPromptDrawn = true;
     redrawOled = false;
   }
 
-  if (currentMaxItems == 0) { // Special case if no list is loaded
+  if (equipment.count == 0) { // Special case if no list is loaded
     if (isButtonPressed(BUTTON_C_PIN)) { // Only C (Back to Menu) is active
       currentState = IDLE_MENU;
       currentMenuScreen = MAIN_MENU; 
@@ -1242,6 +3676,7 @@ void handleSessionActiveState() {
 
   if (isButtonPressed(BUTTON_C_PIN)) { // Start Scanning
     resetFoundTagsForRepack();    // Prepare for new scan phase
+    perfSessionReset();
     currentState = REPACKING_SCAN;
     displayBagStatusSummaryOLED(); // Update OLED for the scanning phase
     oledPromptDrawn = false;
@@ -1251,7 +3686,6 @@ void handleSessionActiveState() {
 }
 
 void handleRepackingScanState() {
-  static unsigned long lastNfcPollTime = 0;
   static bool oledScreenDrawn = false; // Tracks if combined status/prompt is drawn
 
   if (!oledScreenDrawn || redrawOled) {
@@ -1264,29 +3698,30 @@ void handleRepackingScanState() {
     redrawOled = false;
   }
 
-  if ((millis() - lastNfcPollTime) >= NFC_POLLING_INTERVAL_MS) {
-    lastNfcPollTime = millis();
-    String uidScanned, nameScanned;
-    if (readTagDetails(uidScanned, nameScanned)) {
-      processScannedRepackTag(uidScanned); // Process the scanned tag
-      
-      // After processing, refresh the OLED to show updated status and re-draw prompt
-      displayBagStatusSummaryOLED();
-      oledPrint(0, SCREEN_HEIGHT - 10, "B: Manual Finish", 1, false);
-      oledShow();
-      
-      delay(TAG_READ_DELAY_MS); // Brief pause to prevent immediate re-scan of same tag
-      lastNfcPollTime = millis(); // Reset poll timer after handling a tag
-
-      // Check if all required items are packed
-      if (allRepackItemsScanned && usedTagsInitiallyCount() > 0) {
-        Serial.println("All initially 'OUT' items have been scanned back!");
-        oledShowStatusMessage("🎉 All Packed! 🎉", "All items found!", "", false, 2000);
-        currentState = REPACK_SESSION_COMPLETE;
-        oledScreenDrawn = false; // Reset for next state
-        redrawOled = true;
-        return; // Exit state handler early
-      }
+  NfcTagEvent tagEvent;
+  bool anyTagScanned = false;
+  perfScanBatchBegin();
+  while (nfcEventQueuePop(tagEvent)) { // Non-blocking, drains every tag of a multi-target read
+    perfScanSeen(tagEvent.detectedAt);
+    processScannedRepackTag(tagEvent.uid, tagEvent.uidLength); // Raw bytes, no hex String on the hot path
+    anyTagScanned = true;
+  }
+
+  if (anyTagScanned) {
+    // After processing, refresh the OLED to show updated status and re-draw prompt
+    displayBagStatusSummaryOLED();
+    oledPrint(0, SCREEN_HEIGHT - 10, "B: Manual Finish", 1, false);
+    oledShow();
+    perfScanBatchEnd();
+
+    // Check if all required items are packed
+    if (allRepackItemsScanned && usedTagsInitiallyCount() > 0) {
+      Serial.println("All initially 'OUT' items have been scanned back!");
+      oledShowStatusMessage("🎉 All Packed! 🎉", "All items found!", "", false, 2000);
+      currentState = REPACK_SESSION_COMPLETE;
+      oledScreenDrawn = false; // Reset for next state
+      redrawOled = true;
+      return; // Exit state handler early
     }
   }
 
@@ -1326,6 +3761,13 @@ void handleRepackSessionCompleteState() {
   static bool oledOutcomeDrawn = false; // Tracks if outcome message is on OLED
   static unsigned long entryTime = 0;   // Timestamp for auto-return timeout
 
+  if (!oledOutcomeDrawn) { // Once per session, this block also runs on every redraw
+    journalSessionSeen(); // "Last Scanned" of every item found goes upstream on the next flush
+    journalSessionOutcome(usedTagsInitiallyCount(), usedTagsInitiallyCount() - missingRepackItemsCount(),
+                          missingRepackItemsCount());
+    perfReportSession(equipment.foundCount);
+    entryTime = millis(); // Start timeout for auto-returning to main menu
+  }
   if (!oledOutcomeDrawn || redrawOled) {
     reportSessionOutcomeToSerial(); // Log detailed outcome to Serial
     displaySessionOutcomeOLED();    // Show summary outcome on OLED (this is persistent)
@@ -1337,10 +3779,12 @@ void handleRepackSessionCompleteState() {
 
     oledOutcomeDrawn = true;
     redrawOled = false;
-    entryTime = millis(); // Start timeout for auto-returning to main menu
   }
 
   // Check for user action or timeout
+  if (entryTime != 0) {
+    uiWakeBy(entryTime + WELL_DONE_TIMEOUT_MS + 1);
+  }
   if (isButtonPressed(BUTTON_C_PIN) || 
       ((millis() - entryTime) > WELL_DONE_TIMEOUT_MS && entryTime != 0)) {
     currentState = IDLE_MENU;
@@ -1376,13 +3820,12 @@ void handleAdminModeUnlockState() {
     } else if (!scannedUID.isEmpty()) { // A tag was scanned, but it's not the admin tag
       Serial.println("Wrong Tag Scanned for Admin Unlock: " + scannedUID);
       oledShowStatusMessage("Wrong Tag!", scannedUID.substring(0, 8) + "...", "Scan Admin Tag", false, 2000);
-      delay(TAG_READ_DELAY_MS); 
       // Force redraw of the prompt for another attempt
       oledPromptDrawn = false; 
       redrawOled = true; 
       unlockAttemptStartTime = millis(); // Reset timeout for the new attempt
     }
-    // If readTagDetails returns false, no tag was presented, just continue polling/timeout
+    // If readTagDetails returns false, no tag event is queued, just continue waiting/timeout
   }
 
   if (isButtonPressed(BUTTON_B_PIN)) { // User cancels unlock attempt
@@ -1396,6 +3839,7 @@ void handleAdminModeUnlockState() {
   }
 
   // Check for timeout waiting for admin tag
+  uiWakeBy(unlockAttemptStartTime + ADMIN_TAG_SCAN_TIMEOUT_MS + 1);
   if ((millis() - unlockAttemptStartTime) > ADMIN_TAG_SCAN_TIMEOUT_MS) {
     Serial.println("Timeout waiting for Admin Tag scan.");
     oledShowStatusMessage("Timeout!", "No Admin Tag", "", false, 2000);
@@ -1408,25 +3852,35 @@ void handleAdminModeUnlockState() {
 }
 
 void handleAdminModePrepareWifiState() {
-  // This is a transient state, primarily for initiating WiFi connection.
-  Serial.println("Admin Mode: Preparing WiFi connection...");
-  oledShowStatusMessage("Admin Mode", "Connecting WiFi...", "", true); // Show persistent message
+  // This is a transient state: the network task connects while the UI stays live.
+  static bool connectJobPending = false;
 
-  if (WiFi.status() != WL_CONNECTED) {
-    connectWiFi(); // This function handles its own OLED status messages during connection
-  } else {
-    Serial.println("WiFi already connected.");
-    initTime();
-    oledShowStatusMessage("Admin Mode", "WiFi Ready", "", false, 1500); // Brief confirmation
+  if (!connectJobPending) {
+    Serial.println("Admin Mode: Preparing WiFi connection...");
+    oledShowStatusMessage("Admin Mode", "Connecting WiFi...", "", true); // Show persistent message
+    redrawOled = false;
+    connectJobPending = netJobStart(NET_JOB_CONNECT_WIFI);
+    if (!connectJobPending) {
+      currentState = IDLE_MENU;
+      currentMenuScreen = MAIN_MENU;
+      currentMenuSelection = 0;
+      redrawOled = true;
+    }
+    return;
   }
 
-  if (WiFi.status() == WL_CONNECTED) {
-    struct tm timeinfo_check;
-    if(!getLocalTime(&timeinfo_check, 1000) || timeinfo_check.tm_year < (2000-1900)){
-        Serial.println("Warning: Admin mode entered, NTP time might not be fully synced yet.");
-        // No need for an OLED warning here unless it blocks critical functionality.
-    }
+  if (redrawOled) { // A toast from connectWiFi() just expired
+    oledShowStatusMessage("Admin Mode", "Connecting WiFi...", "", true);
+    redrawOled = false;
+  }
+
+  bool connected = false;
+  if (!netJobPoll(NET_JOB_CONNECT_WIFI, connected)) {
+    return;
+  }
+  connectJobPending = false;
 
+  if (connected) {
     Serial.println("WiFi connection successful for Admin Mode.");
     currentMenuScreen = ADMIN_MENU_SCREEN;
     currentMenuSelection = 0; // Default to first admin menu option
@@ -1442,6 +3896,27 @@ void handleAdminModePrepareWifiState() {
 }
 
 void handleAdminMenuState() {
+  static bool fetchJobPending = false;
+
+  if (fetchJobPending) { // Menu input is paused while the list is fetched
+    if (redrawOled) {
+      oledShowStatusMessage("Fetching List", "Please wait...", "", true);
+      redrawOled = false;
+    }
+    bool fetched = false;
+    if (!netJobPoll(NET_JOB_FETCH_EQUIPMENT, fetched)) {
+      return;
+    }
+    fetchJobPending = false;
+    if (fetched) {
+      Serial.println("Equipment list fetched successfully from Admin Menu for active bag.");
+    } else {
+      Serial.println("Failed to fetch equipment list from Admin Menu for active bag.");
+    }
+    // Stay in admin menu, redraw it (in case WiFi status changed or to clear fetch messages)
+    redrawOled = true;
+  }
+
   if (redrawOled) {
     displayCurrentMenuOnOLED(); // Displays admin menu with WiFi status
   }
@@ -1470,19 +3945,14 @@ void handleAdminMenuState() {
         // currentState remains ADMIN_MENU
         redrawOled = true; // Force redraw of admin menu
       } else {
-        if (fetchEquipmentList_Airtable()) { 
-          Serial.println("Equipment list fetched successfully from Admin Menu for active bag.");
-        } else {
-          Serial.println("Failed to fetch equipment list from Admin Menu for active bag.");
-        }
-        // Stay in admin menu, redraw it (in case WiFi status changed or to clear fetch messages)
-        // currentState remains ADMIN_MENU
+        // currentState remains ADMIN_MENU, the result is picked up above
+        fetchJobPending = netJobStart(NET_JOB_FETCH_EQUIPMENT);
         redrawOled = true; 
       }
     } else if (currentMenuSelection == 3) { // "Exit Admin"
       Serial.println("Exiting Admin Mode...");
       oledShowStatusMessage("Exiting Admin...", "", "", false, 1000);
-      disconnectWiFi(); 
+      netJobStart(NET_JOB_DISCONNECT_WIFI); // Fire and forget
       currentMenuScreen = MAIN_MENU;
       currentMenuSelection = 0;
       currentState = IDLE_MENU;
@@ -1506,12 +3976,17 @@ void handleAdminReplaceScanOldState() {
   if (readTagDetails(uidScanned, nameScanned)) { // Attempt to read tag
     if (!uidScanned.isEmpty()) {
       admin_TargetOldUID_str = uidScanned;
+      UidKey oldKey; // Read UID-only, so the name comes from the list
+      int oldItem = uidKeyFromHex(uidScanned.c_str(), uidScanned.length(), oldKey) ?
+                    findItemIndexByUid(oldKey.bytes, oldKey.length) : -1;
+      if (oldItem >= 0) {
+        nameScanned = equipmentName(oldItem);
+      }
       Serial.printf("ADMIN: OLD Tag Scanned: UID=%s, Name='%s'\n", uidScanned.c_str(), nameScanned.c_str());
       oledShowStatusMessage("OLD Tag OK:", uidScanned.substring(0, 8) + "...", nameScanned.substring(0, 18), false, 1500);
       currentState = ADMIN_REPLACE_SCAN_NEW;
       oledPromptDrawn = false;
       redrawOled = true;
-      delay(TAG_READ_DELAY_MS); // Brief pause before next screen
     }
   }
 
@@ -1545,7 +4020,6 @@ void handleAdminReplaceScanNewState() {
       if (admin_NewUID_str.equalsIgnoreCase(admin_TargetOldUID_str)) {
         Serial.println("Error: NEW Tag UID is identical to OLD Tag UID.");
         oledShowStatusMessage("Error: Same UID!", "Scan different NEW", "B: Cancel", false, 3000);
-        delay(TAG_READ_DELAY_MS); // Allow message to be seen
         // Force redraw of current prompt to re-scan
         oledPromptDrawn = false; 
         redrawOled = true; 
@@ -1555,7 +4029,6 @@ void handleAdminReplaceScanNewState() {
       if (admin_NewEquipmentName_str.isEmpty()) {
         Serial.println("Error: NEW Tag has no NDEF Name. Tag must be programmed with a name.");
         oledShowStatusMessage("Error: No Name!", "Program NEW Tag", "B: Cancel", false, 3000);
-        delay(TAG_READ_DELAY_MS);
         oledPromptDrawn = false;
         redrawOled = true;
         return; // Stay in this state
@@ -1566,7 +4039,6 @@ void handleAdminReplaceScanNewState() {
       currentState = ADMIN_REPLACE_CONFIRM;
       oledPromptDrawn = false;
       redrawOled = true;
-      delay(TAG_READ_DELAY_MS); 
     }
   }
 
@@ -1581,6 +4053,23 @@ void handleAdminReplaceScanNewState() {
 
 void handleAdminReplaceConfirmState() {
   static bool oledPromptDrawn = false;
+  static bool updateJobPending = false;
+
+  if (updateJobPending) { // The network task is updating Airtable and refreshing the list
+    if (redrawOled) {
+      oledShowStatusMessage("Updating Airtable", "Please wait...", "", true);
+      redrawOled = false;
+    }
+    bool updated = false;
+    if (!netJobPoll(NET_JOB_REPLACE_TAG, updated)) {
+      return;
+    }
+    updateJobPending = false;
+    currentState = ADMIN_MENU; // Return to Admin Menu regardless of update outcome
+    oledPromptDrawn = false;
+    redrawOled = true;
+    return;
+  }
 
   if (redrawOled || !oledPromptDrawn) {
     Serial.println("ADMIN REPLACE: Confirm Replacement Details");
@@ -1601,23 +4090,13 @@ void handleAdminReplaceConfirmState() {
   }
 
   if (isButtonPressed(BUTTON_A_PIN)) { // Confirm replacement
-    Serial.println("CONFIRMED. Sending update to Google Sheet...");
-    // sendSheetUpdateRequest() will display its own success/failure messages
-    if (sendAirtableUpdateRequest(admin_TargetOldUID_str, admin_NewUID_str, admin_NewEquipmentName_str)) {
-      Serial.println("Airtable update reported success. Attempting to re-fetch local list...");
-      // fetchEquipmentList() will display its own messages
-      if (fetchEquipmentList_Airtable()) {
-        Serial.println("Local equipment list refreshed successfully after update.");
-      } else {
-        Serial.println("Error re-fetching list after update. Advise manual fetch.");
-        oledShowStatusMessage("Airtable Updated", "List fetch FAILED", "Fetch manually", false, 3000);
-      }
-    } else {
-      Serial.println("Error reported during Airtable update.");
-      // Error message already shown by sendSheetUpdateRequest
+    Serial.println("CONFIRMED. Sending update to Airtable...");
+    journalReplaceTag(admin_TargetOldUID_str, admin_NewUID_str, admin_NewEquipmentName_str);
+    updateJobPending = netJobStart(NET_JOB_REPLACE_TAG);
+    if (!updateJobPending) {
+      currentState = ADMIN_MENU;
+      oledPromptDrawn = false;
     }
-    currentState = ADMIN_MENU; // Return to Admin Menu regardless of update outcome
-    oledPromptDrawn = false;
     redrawOled = true;
   } else if (isButtonPressed(BUTTON_B_PIN)) { // Cancel confirmation
     Serial.println("Admin Replace Confirm cancelled by user. Returning to Admin Menu.");
@@ -1629,9 +4108,33 @@ void handleAdminReplaceConfirmState() {
 }
 
 void handleAdminSetActiveBagFetchState() {
-  Serial.println("ADMIN_SET_ACTIVE_BAG_FETCH: Attempting to fetch list of bags.");
+  static bool fetchJobPending = false;
+
+  if (!fetchJobPending) {
+    Serial.println("ADMIN_SET_ACTIVE_BAG_FETCH: Attempting to fetch list of bags.");
+    oledShowStatusMessage("Fetching Bags", "Please wait...", "", true);
+    redrawOled = false;
+    fetchJobPending = netJobStart(NET_JOB_FETCH_BAGS);
+    if (!fetchJobPending) {
+      currentState = ADMIN_MENU;
+      redrawOled = true;
+    }
+    return;
+  }
+
+  if (redrawOled) {
+    oledShowStatusMessage("Fetching Bags", "Please wait...", "", true);
+    redrawOled = false;
+  }
+
+  bool fetched = false;
+  if (!netJobPoll(NET_JOB_FETCH_BAGS, fetched)) {
+    return;
+  }
+  fetchJobPending = false;
+
   // fetchAvailableBags_Airtable() handles its own OLED messages
-  if (fetchAvailableBags_Airtable()) {
+  if (fetched) {
     if (availableBagCount > 0) {
       currentState = ADMIN_SET_ACTIVE_BAG_SELECT;
       currentMenuSelection = 0; // Reset selection for the new list
@@ -1653,8 +4156,26 @@ void handleAdminSetActiveBagSelectState() {
   // For simplicity, we'll create a temporary array of const char* for oledDisplayMenu
   // This is a bit clunky but avoids complex dynamic const char* arrays.
   
+  static bool fetchJobPending = false;
+
+  if (fetchJobPending) { // Selection made, the list for the new bag is being fetched
+    if (redrawOled) {
+      oledShowStatusMessage("Active Bag Set:", currentAssignedBagName.substring(0,18), "Fetching list...", true);
+      redrawOled = false;
+    }
+    bool fetched = false; // Success/error message shown by fetchEquipmentList_Airtable
+    if (!netJobPoll(NET_JOB_FETCH_EQUIPMENT, fetched)) {
+      return;
+    }
+    fetchJobPending = false;
+    currentState = ADMIN_MENU; // Return to admin menu
+    redrawOled = true;
+    return;
+  }
+
   if (redrawOled) {
     oledDisplayMenu("SELECT ACTIVE BAG", availableBagNames, availableBagCount, currentMenuSelection);
+    redrawOled = false; // Left set, loop() would redraw on every pass and never idle
   }
 
   // Handle UP/DOWN for bag selection list
@@ -1678,10 +4199,10 @@ void handleAdminSetActiveBagSelectState() {
     
     if (saveCurrentBagID(selectedBagID, selectedBagName)) {
       oledShowStatusMessage("Active Bag Set:", selectedBagName.substring(0,18), "Fetching list...", true);
-      if (fetchEquipmentList_Airtable()) { // Fetch list for the new bag
-        // Success message shown by fetchEquipmentList_Airtable
-      } else {
-        // Error message shown by fetchEquipmentList_Airtable
+      redrawOled = false;
+      fetchJobPending = netJobStart(NET_JOB_FETCH_EQUIPMENT); // Fetch list for the new bag
+      if (fetchJobPending) {
+        return;
       }
     } else {
       oledShowStatusMessage("Error Saving Bag", "Config Write Fail", "", false, 3000);
@@ -1691,12 +4212,110 @@ void handleAdminSetActiveBagSelectState() {
   }
 }
 
+//==============================================================================
+// LIGHT SLEEP SCHEDULER
+//==============================================================================
+// After each pass the UI task sleeps until its next deadline: the toast on screen,
+// a state timeout (uiWakeBy), the NFC engine's re-arm or LIGHT_SLEEP_MAX_MS. When the rest of the system is
+// quiet as well, the whole chip light-sleeps instead of idling at full clock, woken
+// by the timer, a button going HIGH or the PN532 pulling IRQ low. Light sleep is
+// skipped while WiFi is up, a network job runs, the NFC task holds the bus or a
+// level is already asserted (held button, unread PN532 response).
+unsigned long uiIdleWaitMs() {
+  unsigned long now = millis();
+  long waitMs = LIGHT_SLEEP_MAX_MS;
+  if (uiHasDeadline) {
+    waitMs = min(waitMs, (long)(uiDeadline - now));
+  }
+  if (nfcEngineState == NFC_ENGINE_HOLDOFF) {
+    waitMs = min(waitMs, (long)(nfcRearmAt - now));
+  }
+  portENTER_CRITICAL(&toastMux);
+  if (toastActive) {
+    uint16_t limit = (toastCount > 0 && toastDurationMs > TOAST_MIN_DURATION_MS) ? TOAST_MIN_DURATION_MS : toastDurationMs;
+    waitMs = min(waitMs, (long)(toastShownAt + limit - now));
+  } else if (toastCount > 0) {
+    waitMs = 0;
+  }
+  portEXIT_CRITICAL(&toastMux);
+  return waitMs > 0 ? waitMs : 0;
+}
+
+bool lightSleepPinsIdle() {
+  for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+    if (digitalRead(buttonPins[i]) == HIGH) {
+      return false;
+    }
+  }
+  return digitalRead(PN532_IRQ) == HIGH;
+}
+
+// Called with the I2C mutex held, so the NFC task is not mid-exchange.
+void lightSleepFor(unsigned long sleepMs) {
+  for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+    gpio_intr_disable((gpio_num_t)buttonPins[i]); // Level wake-up types must not reach the edge ISRs
+    gpio_wakeup_enable((gpio_num_t)buttonPins[i], GPIO_INTR_HIGH_LEVEL);
+  }
+  gpio_intr_disable((gpio_num_t)PN532_IRQ);
+  gpio_wakeup_enable((gpio_num_t)PN532_IRQ, GPIO_INTR_LOW_LEVEL);
+  esp_sleep_enable_gpio_wakeup();
+  esp_sleep_enable_timer_wakeup((uint64_t)sleepMs * 1000ULL);
+  Serial.flush(); // The UART stops in light sleep
+
+  esp_light_sleep_start();
+
+  esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL); // Deep sleep sets its own (ext1)
+  // Edges during the sleep never reached the ISRs: replay a button that is down
+  // now, before its interrupt is back (the ring has one producer at a time).
+  unsigned long now = millis();
+  bool pressed = false;
+  for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+    gpio_wakeup_disable((gpio_num_t)buttonPins[i]);
+    if (digitalRead(buttonPins[i]) == HIGH) {
+      pressed |= buttonRecordPress(i, now);
+    }
+    gpio_set_intr_type((gpio_num_t)buttonPins[i], GPIO_INTR_ANYEDGE);
+    gpio_intr_enable((gpio_num_t)buttonPins[i]);
+  }
+  gpio_wakeup_disable((gpio_num_t)PN532_IRQ);
+  gpio_set_intr_type((gpio_num_t)PN532_IRQ, GPIO_INTR_NEGEDGE);
+  gpio_intr_enable((gpio_num_t)PN532_IRQ);
+  if (nfcTaskHandle != NULL) {
+    xTaskNotifyGive(nfcTaskHandle); // Checks the IRQ level itself
+  }
+  if (pressed) {
+    wakeUiTask();
+  }
+}
+
+void uiIdleWait() {
+  unsigned long waitMs = uiIdleWaitMs();
+  if (waitMs == 0 || ulTaskNotifyTake(pdTRUE, 0) > 0) {
+    return; // Due now, or an event came in during the pass
+  }
+  if (waitMs >= LIGHT_SLEEP_MIN_MS && WiFi.getMode() == WIFI_OFF &&
+      __atomic_load_n(&netJobsOutstanding, __ATOMIC_SEQ_CST) == 0 &&
+      xSemaphoreTake(i2cMutex, 0) == pdTRUE) { // Not a bus transaction, kept out of the stats
+    if (lightSleepPinsIdle()) {
+      lightSleepFor(waitMs);
+      xSemaphoreGive(i2cMutex);
+      return;
+    }
+    xSemaphoreGive(i2cMutex);
+  }
+  ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(min(waitMs, (unsigned long)UI_TASK_WAIT_MS)));
+}
+
 //==============================================================================
 // MAIN STATE MACHINE DISPATCHER
 //==============================================================================
 void runStateMachine() {
   SystemState stateBeforeRun = currentState; 
 
+  uiHasDeadline = false;
+  oledToastService(); // Expire/advance status toasts; may set redrawOled
+  buttonsPoll();       // Presses since the last pass, consumed by the handlers below
+
   switch (currentState) {
     case IDLE_MENU:                         handleIdleMenuState();                      break;
     case REPACK_SESSION_START_CONFIRM:      handleRepackSessionStartConfirmState();     break;
@@ -1726,69 +4345,67 @@ void runStateMachine() {
     Serial.printf("System State changed from %d to %d.\n", stateBeforeRun, currentState);
     lastActivityTime = millis(); // Reset inactivity timer on any state transition
     redrawOled = true;           // Ensure new state's screen is drawn
+    nfcEngineSetEnabled(nfcStateWantsScanning(currentState), nfcMaxTargetsForState(currentState),
+                        nfcScanProfileForState(currentState)); // Arm/idle the reader for the new state
   }
 }
 
+//==============================================================================
+// TASK STARTUP
+//==============================================================================
+void startBackgroundTasks() {
+  uiTaskHandle = xTaskGetCurrentTaskHandle(); // setup() runs on the Arduino loop task
+  netJobQueue = xQueueCreate(NET_JOB_QUEUE_SIZE, sizeof(NetJob));
+  netResultQueue = xQueueCreate(NET_JOB_QUEUE_SIZE, sizeof(NetResult));
+
+  xTaskCreatePinnedToCore(nfcTask, "nfc", NFC_TASK_STACK_SIZE, NULL, NFC_TASK_PRIORITY, &nfcTaskHandle, NFC_TASK_CORE);
+  xTaskCreatePinnedToCore(networkTask, "network", NETWORK_TASK_STACK_SIZE, NULL, NETWORK_TASK_PRIORITY, &networkTaskHandle, NETWORK_TASK_CORE);
+  Serial.println("NFC and network tasks started.");
+}
+
 //==============================================================================
 // ARDUINO SETUP FUNCTION
 //==============================================================================
 void setup() {
   Serial.begin(115200);
-  // Wait for Serial to initialize, but not indefinitely (e.g., if not connected to PC)
-  unsigned long serialStartTime = millis();
-  while (!Serial && (millis() - serialStartTime < 2000)) {
-    delay(10); 
+  // Determine the reason for waking up (or power-on)
+  esp_sleep_wakeup_cause_t wakeup_reason = esp_sleep_get_wakeup_cause();
+  bool buttonWake = (wakeup_reason == ESP_SLEEP_WAKEUP_EXT1);
+  if (!buttonWake) {
+    // Cold boot: give a PC monitor time to attach, but not indefinitely
+    unsigned long serialStartTime = millis();
+    while (!Serial && (millis() - serialStartTime < 2000)) {
+      delay(10);
+    }
+    delay(1000); // Additional small delay for serial stability
   }
-  delay(1000); // Additional small delay for serial stability
 
   esp_log_level_set("*", ESP_LOG_WARN); // Reduce default ESP-IDF log verbosity
   Serial.println("\n--- Goalie Gear Tracker (V5.3 - Deep Sleep, K&R Style) ---");
+  bootStageDone("serial");
 
-  // Determine the reason for waking up (or power-on)
-  esp_sleep_wakeup_cause_t wakeup_reason = esp_sleep_get_wakeup_cause();
-
-  // Initialize core peripherals needed on every boot/wake
+  // OLED first, it is what the user is waiting for
+  i2cMutex = xSemaphoreCreateMutex(); // Before the first OLED push
+  journalMutex = xSemaphoreCreateMutex();
+  spiffsMountMutex = xSemaphoreCreateMutex();
   Wire.begin(PN532_SDA, PN532_SCL);
-  if (!display.begin(SSD1306_SWITCHCAPVCC, OLED_I2C_ADDRESS)) {
+  i2cBusAcquire(I2C_CLIENT_OLED); // Sets the OLED clock
+  bool oledReady = display.begin(SSD1306_SWITCHCAPVCC, OLED_I2C_ADDRESS);
+  i2cBusRelease();
+  if (!oledReady) {
     Serial.println(F("CRITICAL: SSD1306 OLED initialization failed!"));
     // Consider a visual error or halt if display is essential
   } else {
     Serial.println("OLED display initialized OK.");
   }
+  bootStageDone("oled");
 
   setupButtons(); // Configure button GPIO pins
-
-  if (!SPIFFS.begin(true)) { // Mount SPIFFS (true = format if mount fails)
-    Serial.println("CRITICAL: SPIFFS Mount Failed!");
-  } else {
-    Serial.println("SPIFFS initialized OK.");
-  }
-  
-  // Ensure WiFi is in a known, low-power state initially
-  WiFi.mode(WIFI_STA);      // Set to Station mode
-  WiFi.disconnect(true);    // Disconnect and clear previous session config from RAM
-  delay(100);               // Allow WiFi to settle
-  Serial.println("WiFi module initialized to disconnected STA mode.");
-
-  // Initialize NFC reader
-  nfc.begin();
-  uint32_t nfc_firmware_version = nfc.getFirmwareVersion();
-  if (!nfc_firmware_version) {
-    Serial.println("CRITICAL: PN532 NFC reader not found or failed to initialize. Halting.");
-    oledShowStatusMessage("Error:", "NFC FAIL!", "", true); // Show on OLED
-    while (1) { // Halt indefinitely
-      delay(10); 
-    }
-  }
-  Serial.printf("Found PN5%X NFC chip. Firmware ver. %d.%d\n", 
-                (nfc_firmware_version >> 24) & 0xFF, 
-                (nfc_firmware_version >> 16) & 0xFF, 
-                (nfc_firmware_version >> 8) & 0xFF);
-  nfc.SAMConfig(); // Configure Secure Access Module
-  Serial.println("NFC Reader Ready.");
+  nfcEngineSetup(); // Event queue and IRQ line only, the PN532 itself is configured lazily
+  // WiFi stays off (its state after reset/deep sleep) until an admin flow connects
 
   // Restore state or initialize based on wakeup reason
-  if (wakeup_reason == ESP_SLEEP_WAKEUP_EXT1) {
+  if (buttonWake) {
     Serial.println("Wakeup source: External signal (Buttons via RTC_CNTL).");
     if (rtcDataIsValid) {
       Serial.println("Valid RTC data found. Restoring saved application state.");
@@ -1802,7 +4419,6 @@ void setup() {
       currentMenuScreen = MAIN_MENU;
       currentMenuSelection = 0;
     }
-    oledShowStatusMessage("Woke up!", "", "", false, 1000); // Brief "Woke up" message
   } else { // Cold boot or other reset type
     Serial.printf("Wakeup source: %d (Not button-triggered deep sleep wake).\n", wakeup_reason);
     currentState = IDLE_MENU;
@@ -1811,50 +4427,54 @@ void setup() {
     rtcDataIsValid = false; // Ensure RTC data is marked invalid on a cold boot
     oledShowStatusMessage("Goalie Tracker", "V5.3 Starting...", "", false, 2000);
   }
-  
-  // Load equipment list from SPIFFS on both cold boot and wake-up.
-  // This ensures the list reflects any changes made before a potential sleep.
- if (loadCurrentBagID()) {
-    Serial.println("Active bag loaded: " + currentAssignedBagName + " (ID: " + currentAssignedBagID + ")");
-  } else {
-    Serial.println("No active bag configured on device. Please set one in Admin Menu.");
-    // Optionally, display this on OLED briefly if currentState is IDLE_MENU
-    if (currentState == IDLE_MENU) {
-        //oledShowStatusMessage("No Active Bag", "Set in Admin", "", false, 2500);
-        // Be careful with timing here, as IDLE_MENU will redraw soon.
+
+  // Tasks start before the flash load so a cold boot configures the PN532 meanwhile
+  nfcReaderInitAtStart = !buttonWake;
+  startBackgroundTasks();
+  bootStageDone("state + tasks");
+
+  // A button wake restores the bag and list from RTC memory; SPIFFS is only mounted
+  // (by the first file operation) on a cold boot or when the snapshot is unusable.
+  bool restoredFromRtc = buttonWake && restoreRtcSnapshot();
+  invalidateRtcSnapshot(); // Only valid for the wake it was taken for
+  if (!restoredFromRtc) {
+    if (loadCurrentBagID()) {
+      Serial.println("Active bag loaded: " + currentAssignedBagName + " (ID: " + currentAssignedBagID + ")");
+    } else {
+      Serial.println("No active bag configured on device. Please set one in Admin Menu.");
     }
-  }
-  
-  // Load equipment list for the active bag from SPIFFS (if bag is set)
-  // The existing loadListFromSPIFFS() will load whatever was last saved.
-  // If a new bag was just set and its list fetched, SPIFFS is already up-to-date.
-  // If booting and a bag ID is loaded, the SPIFFS list should correspond to it.
-  if (!currentAssignedBagID.isEmpty()) {
-    loadListFromSPIFFS(); // This loads the equipment for the active bag
-    if (currentMaxItems == 0 && wakeup_reason != ESP_SLEEP_WAKEUP_EXT1){
-        Serial.println("(Equipment list for active bag is empty in SPIFFS. Use Admin->Fetch.)");
+
+    // Load equipment list for the active bag from SPIFFS (if bag is set)
+    // If a new bag was just set and its list fetched, SPIFFS is already up-to-date.
+    // If booting and a bag ID is loaded, the SPIFFS list should correspond to it.
+    if (!currentAssignedBagID.isEmpty()) {
+      loadListFromSPIFFS(); // This loads the equipment for the active bag
+      if (equipment.count == 0 && !buttonWake) {
+          Serial.println("(Equipment list for active bag is empty in SPIFFS. Use Admin->Fetch.)");
+      }
+    } else {
+        equipmentTableFree(equipment); // Ensure list is empty if no bag is set
     }
-  } else {
-      currentMaxItems = 0; // Ensure list is empty if no bag is set
-      // Consider clearing the equipment_list.csv or handling this state explicitly
-      // SPIFFS.remove(EQUIPMENT_LIST_FILE); // If you want to ensure it's clean
   }
+  bootStageDone(restoredFromRtc ? "bag + list (RTC)" : "bag + list (SPIFFS)");
 
   redrawOled = true;           // Ensure screen is drawn on the first pass of loop()
   lastActivityTime = millis(); // Initialize inactivity timer
+  nfcEngineSetEnabled(nfcStateWantsScanning(currentState), nfcMaxTargetsForState(currentState),
+                      nfcScanProfileForState(currentState)); // A restored state may expect tags
 
   Serial.println("Setup Complete. Initial State: " + String(currentState));
-  if (currentMaxItems == 0 && wakeup_reason != ESP_SLEEP_WAKEUP_EXT1) {
+  if (equipment.count == 0 && !buttonWake) {
     Serial.println("(No equipment list loaded from SPIFFS. Use Admin->Fetch.)");
-  } else if (currentMaxItems > 0 && currentState == IDLE_MENU) {
-    // Optionally, show initial bag status if list is loaded and starting in idle menu
-    // displayBagStatusSummaryOLED(); 
-    // delay(1500);
-    // redrawOled = true; // Ensure menu redraws correctly after status display
   }
 }
 
 void loop() {
-  runStateMachine();
-  yield(); // Allow ESP32 background tasks (like WiFi stack) to run
+  runStateMachine(); // UI/render task; tag reads and network calls run on their own tasks
+  if (!bootTimingsLogged) {
+    bootLogTimings(); // First pass drew the initial screen
+  }
+  if (!redrawOled) {
+    uiIdleWait(); // Nothing left to draw: sleep until the next event or deadline
+  }
 }
\ No newline at end of file
@@ -0,0 +1,350 @@
+// Pins, interrupts, sleep, Serial, wall clock, random numbers and the heap figures
+// of the ESP32 core, on the host.
+#include <esp_log.h>
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+#include <rom/crc.h>
+
+#include "HostFakesInternal.h"
+
+extern "C" {
+void hostHeapStats(uint64_t* allocations, uint64_t* frees, size_t* bytesInUse, size_t* peakBytes);
+void hostHeapResetPeak(void);
+}
+
+HardwareSerial Serial;
+EspClass ESP;
+volatile uint32_t hostGpioOutRegister[2];
+volatile uint32_t hostGpioInRegister[2];
+
+namespace {
+
+const int kUndriven = -1;
+const uint32_t kHeapSize = 320 * 1024; // What an ESP32 without PSRAM reports at boot
+
+// Zero-initialised PODs: the firmware's static constructors call pinMode() before
+// any of this code has run.
+struct Pin {
+  uint8_t mode;
+  bool driven; // By something outside the chip, see setPinLevel()
+  uint8_t external;
+  uint8_t output;
+  void (*isr)();
+  int interruptMode;
+  bool interruptEnabled;
+  int wakeLevel; // 0 none, 1 low, 2 high
+};
+Pin pins[NUM_DIGITAL_PINS];
+
+std::string serialCapture;
+esp_sleep_wakeup_cause_t wakeupCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+bool timerWakeEnabled = false;
+uint64_t timerWakeUs = 0;
+bool gpioWakeEnabled = false;
+hostfake::SleepStats sleeps;
+time_t wallClockBase = 0;
+uint64_t wallClockSetAtUs = 0;
+long gmtOffset = 0;
+uint32_t randomState = 0x12345678;
+size_t heapBaseline = 0;
+
+int levelOf(uint8_t pin) {
+  const Pin& p = pins[pin];
+  if (p.mode == OUTPUT) return p.output;
+  if (p.driven) return p.external;
+  if ((p.mode & PULLUP) == PULLUP) return HIGH;
+  return LOW;
+}
+
+// Runs the ISR for a level change the way the GPIO matrix would.
+void applyPinChange(uint8_t pin, int before) {
+  int after = levelOf(pin);
+  const Pin& p = pins[pin];
+  if (after == before || p.isr == nullptr || !p.interruptEnabled) return;
+  bool fire = p.interruptMode == CHANGE || (p.interruptMode == RISING && after == HIGH) ||
+              (p.interruptMode == FALLING && after == LOW);
+  if (fire) p.isr();
+}
+
+bool pinWakePending() {
+  if (!gpioWakeEnabled) return false;
+  for (uint8_t pin = 0; pin < NUM_DIGITAL_PINS; pin++) {
+    if (pins[pin].wakeLevel != 0 && levelOf(pin) == pins[pin].wakeLevel - 1) return true;
+  }
+  return false;
+}
+
+size_t heapUsedSinceReset(size_t bytesInUse) { return bytesInUse > heapBaseline ? bytesInUse - heapBaseline : 0; }
+
+} // namespace
+
+//------------------------------------------------------------------------------
+// GPIO
+//------------------------------------------------------------------------------
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (pin >= NUM_DIGITAL_PINS) return;
+  int before = levelOf(pin);
+  pins[pin].mode = mode;
+  applyPinChange(pin, before);
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  if (pin >= NUM_DIGITAL_PINS) return;
+  int before = levelOf(pin);
+  pins[pin].output = val ? HIGH : LOW;
+  applyPinChange(pin, before);
+}
+
+int digitalRead(uint8_t pin) { return pin < NUM_DIGITAL_PINS ? levelOf(pin) : LOW; }
+
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode) {
+  if (pin >= NUM_DIGITAL_PINS) return;
+  pins[pin].isr = isr;
+  pins[pin].interruptMode = mode;
+  pins[pin].interruptEnabled = true;
+}
+
+void detachInterrupt(uint8_t pin) {
+  if (pin >= NUM_DIGITAL_PINS) return;
+  pins[pin].isr = nullptr;
+  pins[pin].interruptEnabled = false;
+}
+
+esp_err_t gpio_set_intr_type(gpio_num_t gpio, gpio_int_type_t type) {
+  static const int modes[] = {0, RISING, FALLING, CHANGE, ONLOW, ONHIGH};
+  pins[gpio].interruptMode = modes[type];
+  return ESP_OK;
+}
+
+esp_err_t gpio_intr_enable(gpio_num_t gpio) {
+  pins[gpio].interruptEnabled = true;
+  return ESP_OK;
+}
+
+esp_err_t gpio_intr_disable(gpio_num_t gpio) {
+  pins[gpio].interruptEnabled = false;
+  return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_enable(gpio_num_t gpio, gpio_int_type_t type) {
+  if (type != GPIO_INTR_LOW_LEVEL && type != GPIO_INTR_HIGH_LEVEL) return ESP_FAIL;
+  pins[gpio].wakeLevel = (type == GPIO_INTR_HIGH_LEVEL ? HIGH : LOW) + 1;
+  return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_disable(gpio_num_t gpio) {
+  pins[gpio].wakeLevel = 0;
+  return ESP_OK;
+}
+
+//------------------------------------------------------------------------------
+// Sleep
+//------------------------------------------------------------------------------
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() { return wakeupCause; }
+
+esp_err_t esp_sleep_enable_ext1_wakeup(uint64_t mask, esp_sleep_ext1_wakeup_mode_t mode) {
+  (void)mask;
+  (void)mode;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t timeInUs) {
+  timerWakeEnabled = true;
+  timerWakeUs = timeInUs;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup() {
+  gpioWakeEnabled = true;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_disable_wakeup_source(esp_sleep_wakeup_cause_t source) {
+  if (source == ESP_SLEEP_WAKEUP_ALL || source == ESP_SLEEP_WAKEUP_TIMER) timerWakeEnabled = false;
+  if (source == ESP_SLEEP_WAKEUP_ALL || source == ESP_SLEEP_WAKEUP_GPIO) gpioWakeEnabled = false;
+  return ESP_OK;
+}
+
+// Both cores stop, so no other task runs until a wake-up source fires.
+esp_err_t esp_light_sleep_start() {
+  uint64_t start = hostfake::nowMicros();
+  hostfake::detail::freezeOthers(xTaskGetCurrentTaskHandle());
+  bool byPin = hostfake::detail::block(pinWakePending,
+                                       timerWakeEnabled ? start + timerWakeUs : hostfake::detail::kNever);
+  hostfake::detail::freezeOthers(nullptr);
+  wakeupCause = byPin ? ESP_SLEEP_WAKEUP_GPIO : ESP_SLEEP_WAKEUP_TIMER;
+  sleeps.lightSleeps++;
+  sleeps.lightSleepUs += hostfake::nowMicros() - start;
+  return ESP_OK;
+}
+
+void esp_deep_sleep_start() {
+  sleeps.deepSleeps++;
+  throw hostfake::DeepSleep();
+}
+
+//------------------------------------------------------------------------------
+// Serial, time, random, heap
+//------------------------------------------------------------------------------
+size_t HardwareSerial::write(uint8_t c) {
+  serialCapture += (char)c;
+  return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  serialCapture.append((const char*)buffer, size);
+  return size;
+}
+
+// Replaces the C library's time(): seconds since boot until setWallClock(), as on
+// a chip that has not reached an NTP server.
+extern "C" time_t time(time_t* out) noexcept {
+  time_t now = wallClockBase + (time_t)((hostfake::nowMicros() - wallClockSetAtUs) / 1000000ULL);
+  if (out != nullptr) *out = now;
+  return now;
+}
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1, const char* server2,
+                const char* server3) {
+  (void)server1;
+  (void)server2;
+  (void)server3;
+  gmtOffset = gmtOffsetSec + daylightOffsetSec;
+}
+
+// Same loop as the core: poll every 10 ms until the clock looks synced.
+bool getLocalTime(struct tm* info, uint32_t ms) {
+  uint32_t start = millis();
+  for (;;) {
+    time_t now = time(nullptr) + gmtOffset;
+    gmtime_r(&now, info);
+    if (info->tm_year > (2016 - 1900)) return true;
+    if (millis() - start > ms) return false;
+    delay(10);
+  }
+}
+
+uint32_t esp_random() {
+  randomState = randomState * 1664525u + 1013904223u;
+  return randomState;
+}
+
+long random(long max) { return max > 0 ? (long)(esp_random() % (uint32_t)max) : 0; }
+
+long random(long min, long max) { return min >= max ? min : min + random(max - min); }
+
+void randomSeed(unsigned long seed) {
+  if (seed != 0) randomState = (uint32_t)seed;
+}
+
+uint32_t EspClass::getHeapSize() { return kHeapSize; }
+
+uint32_t EspClass::getFreeHeap() {
+  hostfake::HeapStats stats = hostfake::heapStats();
+  size_t used = heapUsedSinceReset(stats.bytesInUse);
+  return used < kHeapSize ? kHeapSize - (uint32_t)used : 0;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+  hostfake::HeapStats stats = hostfake::heapStats();
+  size_t used = heapUsedSinceReset(stats.peakBytes);
+  return used < kHeapSize ? kHeapSize - (uint32_t)used : 0;
+}
+
+uint32_t EspClass::getMaxAllocHeap() { return getFreeHeap(); }
+
+void EspClass::restart() {
+  fprintf(stderr, "hostfake: ESP.restart()\n");
+  abort();
+}
+
+#ifdef HOSTFAKES_STRLCPY
+size_t strlcpy(char* dst, const char* src, size_t size) {
+  size_t length = strlen(src);
+  if (size > 0) {
+    size_t n = length < size - 1 ? length : size - 1;
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+  }
+  return length;
+}
+#endif
+
+uint32_t crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len) {
+  crc = ~crc;
+  while (len--) {
+    crc ^= *buf++;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+  }
+  return ~crc;
+}
+
+//------------------------------------------------------------------------------
+// Control API
+//------------------------------------------------------------------------------
+namespace hostfake {
+
+void setPinLevel(uint8_t pin, int level) {
+  if (pin >= NUM_DIGITAL_PINS) return;
+  int before = levelOf(pin);
+  pins[pin].driven = level != kUndriven;
+  pins[pin].external = level == HIGH ? HIGH : LOW;
+  applyPinChange(pin, before);
+}
+
+int pinLevel(uint8_t pin) { return digitalRead(pin); }
+
+void setWakeupCause(esp_sleep_wakeup_cause_t cause) { wakeupCause = cause; }
+
+const SleepStats& sleepStats() { return sleeps; }
+
+std::string& serialOutput() { return serialCapture; }
+
+void seedRandom(uint32_t seed) { randomState = seed; }
+
+void setWallClock(time_t epochSeconds) {
+  wallClockBase = epochSeconds;
+  wallClockSetAtUs = nowMicros();
+}
+
+HeapStats heapStats() {
+  HeapStats stats;
+  hostHeapStats(&stats.allocations, &stats.frees, &stats.bytesInUse, &stats.peakBytes);
+  return stats;
+}
+
+void reset() {
+  detail::endOtherTasks();
+  detail::resetClock();
+  detail::resetPins();
+  detail::resetSerial();
+  detail::resetWire();
+  detail::resetSpiffs();
+  detail::resetNetwork();
+}
+
+namespace detail {
+
+void resetPins() {
+  memset(pins, 0, sizeof(pins));
+  wakeupCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+  timerWakeEnabled = false;
+  gpioWakeEnabled = false;
+  sleeps = SleepStats();
+  wallClockBase = 0;
+  wallClockSetAtUs = 0;
+  gmtOffset = 0;
+  randomState = 0x12345678;
+}
+
+void resetSerial() {
+  serialCapture.clear();
+  serialCapture.shrink_to_fit();
+  hostHeapResetPeak();
+  heapBaseline = heapStats().bytesInUse;
+}
+
+} // namespace detail
+} // namespace hostfake
@@ -0,0 +1,85 @@
+// fs::FS and fs::File over an in-memory file table (Spiffs.cpp). Files are shared:
+// a handle still reads what it had after the path is removed or renamed.
+#pragma once
+
+#include <Arduino.h>
+
+#include <memory>
+#include <string>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+struct FileNode;
+
+class File : public Stream {
+ public:
+  File() {}
+  File(std::shared_ptr<FileNode> node, const std::string& path, char mode);
+
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int peek() override;
+  void flush() override {}
+  size_t read(uint8_t* buffer, size_t size);
+  size_t readBytes(char* buffer, size_t length) override { return read((uint8_t*)buffer, length); }
+  using Stream::readBytes;
+  bool seek(uint32_t pos, SeekMode mode);
+  bool seek(uint32_t pos) { return seek(pos, SeekSet); }
+  size_t position() const { return pos; }
+  size_t size() const;
+  void close() { node.reset(); }
+  explicit operator bool() const { return node != nullptr; }
+  bool isDirectory() const { return false; }
+  const char* path() const { return filePath.c_str(); }
+  const char* name() const;
+  File openNextFile(const char* mode = FILE_READ) {
+    (void)mode;
+    return File();
+  }
+
+ private:
+  std::shared_ptr<FileNode> node;
+  std::string filePath;
+  char fileMode = 'r';
+  size_t pos = 0;
+};
+
+class FS {
+ public:
+  File open(const char* path, const char* mode = FILE_READ, const bool create = false);
+  File open(const String& path, const char* mode = FILE_READ, const bool create = false) {
+    return open(path.c_str(), mode, create);
+  }
+  bool exists(const char* path);
+  bool exists(const String& path) { return exists(path.c_str()); }
+  bool remove(const char* path);
+  bool remove(const String& path) { return remove(path.c_str()); }
+  bool rename(const char* pathFrom, const char* pathTo);
+  bool rename(const String& pathFrom, const String& pathTo) { return rename(pathFrom.c_str(), pathTo.c_str()); }
+  bool mkdir(const char* path) {
+    (void)path;
+    return true;
+  }
+  bool rmdir(const char* path) {
+    (void)path;
+    return true;
+  }
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+using fs::SeekCur;
+using fs::SeekEnd;
+using fs::SeekMode;
+using fs::SeekSet;
@@ -0,0 +1,71 @@
+// HTTPClient answering from the queue in hostfake::queueHttpResponse() and
+// recording every request in hostfake::httpRequests().
+#pragma once
+
+#include <Arduino.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "WiFi.h"
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_NO_STREAM (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM (-8)
+#define HTTPC_ERROR_ENCODING (-9)
+#define HTTPC_ERROR_STREAM_WRITE (-10)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+typedef enum {
+  HTTP_CODE_OK = 200,
+  HTTP_CODE_CREATED = 201,
+  HTTP_CODE_NO_CONTENT = 204,
+  HTTP_CODE_BAD_REQUEST = 400,
+  HTTP_CODE_UNAUTHORIZED = 401,
+  HTTP_CODE_FORBIDDEN = 403,
+  HTTP_CODE_NOT_FOUND = 404,
+  HTTP_CODE_UNPROCESSABLE_ENTITY = 422,
+  HTTP_CODE_TOO_MANY_REQUESTS = 429,
+  HTTP_CODE_INTERNAL_SERVER_ERROR = 500,
+  HTTP_CODE_SERVICE_UNAVAILABLE = 503,
+} t_http_codes;
+
+class HTTPClient {
+ public:
+  bool begin(WiFiClient& client, const String& url);
+  bool begin(const String& url);
+  void end();
+  void setReuse(bool reuse) { this->reuse = reuse; }
+  void setTimeout(uint16_t timeout) { this->timeout = timeout; }
+  void addHeader(const String& name, const String& value, bool first = false, bool replace = true);
+  void collectHeaders(const char* headerKeys[], const size_t headerKeysCount);
+  String header(const char* name);
+
+  int GET();
+  int POST(const String& payload);
+  int PATCH(const String& payload);
+  int sendRequest(const char* type, const String& payload);
+
+  int getSize() { return size; }
+  WiFiClient& getStream() { return *client; }
+  WiFiClient* getStreamPtr() { return client; }
+  String getString();
+
+ private:
+  WiFiClient* client = nullptr;
+  WiFiClient ownClient;
+  String url;
+  std::vector<std::pair<std::string, std::string>> headers;
+  std::vector<std::string> collected;
+  bool reuse = true;
+  uint16_t timeout = 5000;
+  bool chunked = false;
+  bool serverClose = false;
+  int size = -1;
+};
@@ -0,0 +1,95 @@
+/* Counts heap traffic by wrapping glibc's allocator. Written in C so the
+ * definitions match the C declarations of malloc and friends exactly. Elsewhere
+ * the counters simply stay at zero. */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(__GLIBC__)
+#include <errno.h>
+#include <malloc.h>
+
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void* __libc_memalign(size_t alignment, size_t size);
+extern void __libc_free(void* ptr);
+
+static uint64_t allocations;
+static uint64_t frees;
+static size_t bytesInUse;
+static size_t peakBytes;
+
+static void* noteAlloc(void* ptr) {
+  if (ptr != NULL) {
+    __atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+    size_t used = __atomic_add_fetch(&bytesInUse, malloc_usable_size(ptr), __ATOMIC_RELAXED);
+    if (used > peakBytes) peakBytes = used;
+  }
+  return ptr;
+}
+
+static void noteFree(void* ptr) {
+  if (ptr != NULL) {
+    __atomic_add_fetch(&frees, 1, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&bytesInUse, malloc_usable_size(ptr), __ATOMIC_RELAXED);
+  }
+}
+
+void* malloc(size_t size) { return noteAlloc(__libc_malloc(size)); }
+
+void* calloc(size_t count, size_t size) { return noteAlloc(__libc_calloc(count, size)); }
+
+void* realloc(void* ptr, size_t size) {
+  if (ptr == NULL) return malloc(size);
+  if (size == 0) {
+    free(ptr);
+    return NULL;
+  }
+  size_t before = malloc_usable_size(ptr);
+  void* moved = __libc_realloc(ptr, size);
+  if (moved != NULL) { /* Counted as a free and a new allocation */
+    __atomic_sub_fetch(&bytesInUse, before, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&frees, 1, __ATOMIC_RELAXED);
+    noteAlloc(moved);
+  }
+  return moved;
+}
+
+void free(void* ptr) {
+  noteFree(ptr);
+  __libc_free(ptr);
+}
+
+void* memalign(size_t alignment, size_t size) { return noteAlloc(__libc_memalign(alignment, size)); }
+
+void* aligned_alloc(size_t alignment, size_t size) { return memalign(alignment, size); }
+
+int posix_memalign(void** out, size_t alignment, size_t size) {
+  void* ptr = memalign(alignment, size);
+  if (ptr == NULL) return ENOMEM;
+  *out = ptr;
+  return 0;
+}
+
+void hostHeapStats(uint64_t* outAllocations, uint64_t* outFrees, size_t* outBytesInUse, size_t* outPeakBytes) {
+  *outAllocations = allocations;
+  *outFrees = frees;
+  *outBytesInUse = bytesInUse;
+  *outPeakBytes = peakBytes;
+}
+
+void hostHeapResetPeak(void) { peakBytes = bytesInUse; }
+
+#else
+
+void hostHeapStats(uint64_t* outAllocations, uint64_t* outFrees, size_t* outBytesInUse, size_t* outPeakBytes) {
+  *outAllocations = 0;
+  *outFrees = 0;
+  *outBytesInUse = 0;
+  *outPeakBytes = 0;
+}
+
+void hostHeapResetPeak(void) {}
+
+#endif
@@ -0,0 +1,246 @@
+// Control side of the host fakes: the virtual clock, pins, the simulated I2C bus
+// with its PN532 and SSD1306, SPIFFS contents, scripted HTTP responses and the heap
+// counters. Tests and the bench set the stage through these and then run the
+// firmware's own code.
+#pragma once
+
+#include <Arduino.h>
+
+#include <deque>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace hostfake {
+
+// Puts every fake back to power-on: clock at 0, pins high-Z, no files, no queued
+// HTTP responses, empty Serial capture, tags out of the field. Tasks other than the
+// caller are ended (their FreeRTOS objects stay allocated, the firmware's handles
+// to them are the caller's to reset).
+void reset();
+
+//------------------------------------------------------------------------------
+// Clock and scheduler
+//------------------------------------------------------------------------------
+uint64_t nowMicros();
+// Runs 'action' from the scheduler once the clock reaches now + delayUs, like an
+// interrupt: it may change pins and give notifications but must not block.
+void scheduleAfter(uint64_t delayUs, std::function<void()> action);
+// Blocks the calling task until 'done' holds or timeoutMs passes; the other tasks
+// run meanwhile. Returns done().
+bool runUntil(const std::function<bool()>& done, uint32_t timeoutMs);
+// What time() reports; 0 (the default) reads as a clock that was never synced.
+void setWallClock(time_t epochSeconds);
+// Thrown by esp_deep_sleep_start(): a test sees the firmware power down.
+struct DeepSleep {};
+
+TaskHandle_t findTask(const char* name);
+
+//------------------------------------------------------------------------------
+// Pins and sleep
+//------------------------------------------------------------------------------
+// Drives an input from outside (a button, the PN532 IRQ line); attached ISRs see
+// the edge right away.
+void setPinLevel(uint8_t pin, int level);
+int pinLevel(uint8_t pin);
+void setWakeupCause(esp_sleep_wakeup_cause_t cause);
+
+struct SleepStats {
+  uint32_t lightSleeps;
+  uint64_t lightSleepUs;
+  uint32_t deepSleeps;
+};
+const SleepStats& sleepStats();
+
+//------------------------------------------------------------------------------
+// Serial, random numbers, heap
+//------------------------------------------------------------------------------
+std::string& serialOutput();
+void seedRandom(uint32_t seed);
+
+// Counts every malloc/new on the host since start-up, whoever made it.
+struct HeapStats {
+  uint64_t allocations;
+  uint64_t frees;
+  size_t bytesInUse;
+  size_t peakBytes;
+};
+HeapStats heapStats();
+
+//------------------------------------------------------------------------------
+// I2C bus
+//------------------------------------------------------------------------------
+class I2cDevice {
+ public:
+  virtual ~I2cDevice() {}
+  // One master write, START to STOP.
+  virtual void onWrite(const uint8_t* data, size_t length) = 0;
+  // One master read; fills 'data' with what the device shifts out.
+  virtual void onRead(uint8_t* data, size_t length) = 0;
+};
+void attachI2cDevice(uint8_t address, I2cDevice* device);
+
+// Bus time is (1 + bytes) * 9 bit times at the current clock per transaction.
+struct I2cStats {
+  uint32_t transactions;
+  uint32_t nacks;
+  uint64_t bytes; // Address bytes included
+  uint64_t busyUs;
+  uint32_t clockChanges;
+};
+I2cStats& i2cStats();
+
+// PN532 in I2C mode answering the commands the firmware sends: GetFirmwareVersion,
+// SAMConfiguration, InListPassiveTarget (106 kbps type A), InDataExchange with
+// NTAG READ and InRelease. Responses are framed and timed like the chip's, and the
+// IRQ line goes low while a frame is waiting.
+class Pn532Sim : public I2cDevice {
+ public:
+  static const uint8_t kAddress = 0x24;
+  // Chip-side delays, from the PN532 user manual and bench measurements.
+  static const uint32_t kAckUs = 600;
+  static const uint32_t kCommandUs = 1000;
+  static const uint32_t kDetectUs = 4000;       // REQA to the first target's UID
+  static const uint32_t kExtraTargetUs = 2000;  // Each further target in the same field
+  static const uint32_t kReadUs = 3000;         // NTAG READ of 16 bytes
+
+  void resetChip();
+  // Connects the chip's IRQ output to a pin, which it then drives.
+  void wireIrq(int8_t pin) {
+    irqPin = pin;
+    setIrq(ready ? LOW : HIGH);
+  }
+
+  // A tag enters the field. 'pages' is the NTAG memory from page 0 (may be empty).
+  void placeTag(const std::vector<uint8_t>& uid, const std::vector<uint8_t>& pages = std::vector<uint8_t>());
+  // A tag leaves the field; it answers REQA again the next time it is placed.
+  void removeTag(const std::vector<uint8_t>& uid);
+  void removeAllTags();
+  // Sends 'frame' (a complete 00 00 FF ... frame) as the response to the next
+  // InListPassiveTarget instead of one built from the field, for parser tests.
+  void injectDetectionResponse(const std::vector<uint8_t>& frame);
+
+  uint32_t detections() const { return detectionCount; }
+  uint32_t commands() const { return commandCount; }
+  bool detectionArmed() const { return armed; }
+
+  void onWrite(const uint8_t* data, size_t length) override;
+  void onRead(uint8_t* data, size_t length) override;
+
+ private:
+  struct Tag {
+    std::vector<uint8_t> uid;
+    std::vector<uint8_t> pages;
+    bool halted;
+    bool inlisted;
+  };
+
+  void execute();
+  void respond(uint8_t command, const std::vector<uint8_t>& payload, uint32_t afterUs);
+  void setOutput(const std::vector<uint8_t>& frame);
+  void setIrq(int level);
+  void tryDetect();
+  Tag* findTag(const std::vector<uint8_t>& uid);
+  Tag* inlistedTarget(uint8_t tg);
+
+  std::vector<Tag> tags;
+  std::vector<uint8_t> command;      // Host frame data: D4 cmd params
+  std::vector<uint8_t> output;       // Frame the host reads next (without the status byte)
+  std::vector<uint8_t> injected;
+  bool ready = false;
+  bool commandPending = false;       // ACK was read, response not sent yet
+  bool armed = false;                // InListPassiveTarget waits for a tag
+  uint8_t maxTargets = 1;
+  uint32_t epoch = 0;                // Bumped on abort, cancels scheduled responses
+  uint32_t detectionCount = 0;
+  uint32_t commandCount = 0;
+  int8_t irqPin = -1;
+};
+Pn532Sim& pn532();
+
+// SSD1306 at 0x3C: takes everything and counts it.
+class Ssd1306Sim : public I2cDevice {
+ public:
+  static const uint8_t kAddress = 0x3C;
+  uint64_t commandBytes = 0;
+  uint64_t dataBytes = 0;
+  uint32_t writes = 0;
+
+  void onWrite(const uint8_t* data, size_t length) override;
+  void onRead(uint8_t* data, size_t length) override;
+};
+Ssd1306Sim& ssd1306();
+
+//------------------------------------------------------------------------------
+// SPIFFS
+//------------------------------------------------------------------------------
+void writeFile(const char* path, const std::string& contents);
+bool readFile(const char* path, std::string* contents);
+bool fileExists(const char* path);
+// Writes that would take the used bytes past this fail short, as on a full flash.
+void setFlashCapacity(size_t bytes);
+
+//------------------------------------------------------------------------------
+// WiFi and HTTP
+//------------------------------------------------------------------------------
+// When false, WiFi.begin() never gets to WL_CONNECTED.
+void setWifiAvailable(bool available);
+
+struct HttpResponse {
+  int status;
+  std::string body;
+  bool chunked;
+  size_t chunkSize; // Bytes per chunk when chunked
+  bool closeConnection = false; // Sent with "Connection: close": the socket ends with the response
+};
+// Answers the next request in order. With nothing queued a request fails with
+// HTTPC_ERROR_CONNECTION_REFUSED.
+void queueHttpResponse(const HttpResponse& response);
+
+struct HttpRequest {
+  std::string method;
+  std::string url;
+  std::string body;
+  std::vector<std::pair<std::string, std::string>> headers;
+};
+std::vector<HttpRequest>& httpRequests();
+// Connections (TCP plus TLS handshake) opened so far: a request on a client that is
+// not connected opens one, a kept-alive one is reused.
+uint32_t httpConnects();
+
+// Wraps an HTTP body in chunked transfer coding.
+std::string chunkedEncode(const std::string& body, size_t chunkSize);
+
+// A Stream over a string, for code that parses what a socket would deliver.
+class MemoryStream : public Stream {
+ public:
+  explicit MemoryStream(const std::string& contents = std::string()) : data(contents) {}
+  void setContents(const std::string& contents) {
+    data = contents;
+    position = 0;
+  }
+  size_t remaining() const { return data.size() - position; }
+
+  int available() override { return (int)remaining(); }
+  int read() override { return position < data.size() ? (uint8_t)data[position++] : -1; }
+  int peek() override { return position < data.size() ? (uint8_t)data[position] : -1; }
+  size_t readBytes(char* buffer, size_t length) override {
+    size_t n = std::min(length, remaining());
+    memcpy(buffer, data.data() + position, n);
+    position += n;
+    return n;
+  }
+  using Stream::readBytes;
+  size_t write(uint8_t c) override {
+    data += (char)c;
+    return 1;
+  }
+  using Print::write;
+
+ private:
+  std::string data;
+  size_t position = 0;
+};
+
+} // namespace hostfake
@@ -0,0 +1,30 @@
+// Shared between the fake implementations only; tests use HostFakes.h.
+#pragma once
+
+#include "HostFakes.h"
+
+namespace hostfake {
+namespace detail {
+
+const uint64_t kNever = UINT64_MAX;
+
+// Blocks the calling task until 'until' holds (may be empty) or the clock reaches
+// wakeAt, running the other tasks and timers meanwhile. Returns whether 'until'
+// held (true for a plain sleep).
+bool block(const std::function<bool()>& until, uint64_t wakeAt);
+// Lets ready tasks of a higher priority run before the caller continues.
+void preemptIfHigherReady();
+uint64_t ticksToDeadline(TickType_t ticks);
+// While set, only this task runs (the CPU is in light sleep).
+void freezeOthers(TaskHandle_t sleeper);
+void endOtherTasks();
+void resetClock();
+
+void resetPins();
+void resetSerial();
+void resetWire();
+void resetSpiffs();
+void resetNetwork();
+
+} // namespace detail
+} // namespace hostfake
@@ -0,0 +1,183 @@
+// WiFi station state and the scripted HTTP server behind HTTPClient.
+#include <HTTPClient.h>
+
+#include <deque>
+
+#include "HostFakesInternal.h"
+
+WiFiClass WiFi;
+
+namespace {
+
+const uint64_t kConnectUs = 1200 * 1000ULL; // Association plus DHCP on a quiet network
+
+bool wifiAvailable = true;
+wifi_mode_t wifiMode = WIFI_OFF;
+bool joining = false;
+uint64_t connectedAtUs = 0;
+std::deque<hostfake::HttpResponse> responses;
+std::vector<hostfake::HttpRequest> requests;
+uint32_t connects = 0;
+
+bool sameName(const std::string& a, const char* b) { return String(a.c_str()).equalsIgnoreCase(String(b)); }
+
+// Decodes what is left of a chunked body; tolerant of a truncated tail.
+std::string chunkedDecode(const std::string& coded) {
+  std::string body;
+  size_t pos = 0;
+  for (;;) {
+    size_t lineEnd = coded.find("\r\n", pos);
+    if (lineEnd == std::string::npos) break;
+    size_t length = strtoul(coded.substr(pos, lineEnd - pos).c_str(), nullptr, 16);
+    pos = lineEnd + 2;
+    if (length == 0) break;
+    body += coded.substr(pos, length);
+    pos += length + 2;
+  }
+  return body;
+}
+
+} // namespace
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* passphrase) {
+  (void)ssid;
+  (void)passphrase;
+  if (wifiMode == WIFI_OFF) wifiMode = WIFI_STA;
+  joining = true;
+  connectedAtUs = hostfake::nowMicros() + kConnectUs;
+  return WL_DISCONNECTED;
+}
+
+bool WiFiClass::disconnect(bool wifiOff, bool eraseAp) {
+  (void)eraseAp;
+  joining = false;
+  if (wifiOff) wifiMode = WIFI_OFF;
+  return true;
+}
+
+wl_status_t WiFiClass::status() {
+  if (wifiMode == WIFI_OFF || !joining) return WL_DISCONNECTED;
+  if (!wifiAvailable) return WL_NO_SSID_AVAIL;
+  return hostfake::nowMicros() >= connectedAtUs ? WL_CONNECTED : WL_DISCONNECTED;
+}
+
+bool WiFiClass::mode(wifi_mode_t mode) {
+  wifiMode = mode;
+  if (mode == WIFI_OFF) joining = false;
+  return true;
+}
+
+wifi_mode_t WiFiClass::getMode() { return wifiMode; }
+
+bool HTTPClient::begin(WiFiClient& wifiClient, const String& requestUrl) {
+  client = &wifiClient;
+  url = requestUrl;
+  headers.clear();
+  size = -1;
+  chunked = false;
+  serverClose = false;
+  return url.length() > 0;
+}
+
+bool HTTPClient::begin(const String& requestUrl) { return begin(ownClient, requestUrl); }
+
+void HTTPClient::end() {
+  if (client != nullptr && (!reuse || serverClose)) client->stop();
+  headers.clear();
+  size = -1;
+}
+
+void HTTPClient::addHeader(const String& name, const String& value, bool first, bool replace) {
+  (void)first;
+  for (auto& header : headers) {
+    if (replace && sameName(header.first, name.c_str())) {
+      header.second = value.c_str();
+      return;
+    }
+  }
+  headers.emplace_back(name.c_str(), value.c_str());
+}
+
+void HTTPClient::collectHeaders(const char* headerKeys[], const size_t headerKeysCount) {
+  collected.assign(headerKeys, headerKeys + headerKeysCount);
+}
+
+String HTTPClient::header(const char* name) {
+  for (const std::string& key : collected) {
+    if (sameName(key, name) && sameName(key, "Transfer-Encoding")) {
+      return chunked ? String("chunked") : String();
+    }
+  }
+  return String();
+}
+
+int HTTPClient::GET() { return sendRequest("GET", String()); }
+
+int HTTPClient::POST(const String& payload) { return sendRequest("POST", payload); }
+
+int HTTPClient::PATCH(const String& payload) { return sendRequest("PATCH", payload); }
+
+int HTTPClient::sendRequest(const char* type, const String& payload) {
+  if (client == nullptr) return HTTPC_ERROR_NOT_CONNECTED;
+  hostfake::HttpRequest request = {type, url.c_str(), payload.c_str(), headers};
+  requests.push_back(request);
+  if (responses.empty()) {
+    client->stop();
+    return HTTPC_ERROR_CONNECTION_REFUSED;
+  }
+  if (!client->connected()) connects++;
+  hostfake::HttpResponse response = responses.front();
+  responses.pop_front();
+  chunked = response.chunked;
+  serverClose = response.closeConnection;
+  size = chunked ? -1 : (int)response.body.size();
+  client->hostDeliver(chunked ? hostfake::chunkedEncode(response.body, response.chunkSize) : response.body);
+  return response.status;
+}
+
+String HTTPClient::getString() {
+  if (client == nullptr) return String();
+  std::string rest;
+  int c;
+  while ((c = client->read()) >= 0) rest += (char)c;
+  return String(chunked ? chunkedDecode(rest) : rest);
+}
+
+namespace hostfake {
+
+void setWifiAvailable(bool available) { wifiAvailable = available; }
+
+void queueHttpResponse(const HttpResponse& response) { responses.push_back(response); }
+
+std::vector<HttpRequest>& httpRequests() { return requests; }
+
+uint32_t httpConnects() { return connects; }
+
+std::string chunkedEncode(const std::string& body, size_t chunkSize) {
+  std::string coded;
+  if (chunkSize == 0) chunkSize = body.size();
+  for (size_t pos = 0; pos < body.size(); pos += chunkSize) {
+    size_t length = std::min(chunkSize, body.size() - pos);
+    char line[16];
+    snprintf(line, sizeof(line), "%zx\r\n", length);
+    coded += line;
+    coded += body.substr(pos, length);
+    coded += "\r\n";
+  }
+  coded += "0\r\n\r\n";
+  return coded;
+}
+
+namespace detail {
+
+void resetNetwork() {
+  wifiAvailable = true;
+  wifiMode = WIFI_OFF;
+  joining = false;
+  responses.clear();
+  requests.clear();
+  connects = 0;
+}
+
+} // namespace detail
+} // namespace hostfake
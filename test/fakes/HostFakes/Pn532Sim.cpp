@@ -0,0 +1,257 @@
+// PN532 over I2C, from the host's side of the wire: every read starts with the
+// status byte (0x01 once a frame is waiting), a command is answered with an ACK
+// frame first and the response frame after it, and IRQ is low while either waits.
+// Reading the ACK starts the command; writing an ACK aborts it.
+#include "HostFakesInternal.h"
+
+namespace {
+
+const uint8_t kAckFrame[6] = {0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00};
+const uint8_t kHostToPn532 = 0xD4;
+const uint8_t kPn532ToHost = 0xD5;
+
+const uint8_t kGetFirmwareVersion = 0x02;
+const uint8_t kSamConfiguration = 0x14;
+const uint8_t kInDataExchange = 0x40;
+const uint8_t kInListPassiveTarget = 0x4A;
+const uint8_t kInRelease = 0x52;
+const uint8_t kNtagRead = 0x30;
+
+std::vector<uint8_t> buildFrame(const std::vector<uint8_t>& data) {
+  std::vector<uint8_t> frame = {0x00, 0x00, 0xFF, (uint8_t)data.size(), (uint8_t)(0x100 - data.size())};
+  uint8_t sum = 0;
+  for (uint8_t b : data) {
+    frame.push_back(b);
+    sum += b;
+  }
+  frame.push_back((uint8_t)(0x100 - sum));
+  frame.push_back(0x00);
+  return frame;
+}
+
+} // namespace
+
+namespace hostfake {
+
+void Pn532Sim::resetChip() {
+  tags.clear();
+  command.clear();
+  output.clear();
+  injected.clear();
+  ready = false;
+  commandPending = false;
+  armed = false;
+  maxTargets = 1;
+  epoch++;
+  detectionCount = 0;
+  commandCount = 0;
+  setIrq(HIGH);
+}
+
+void Pn532Sim::placeTag(const std::vector<uint8_t>& uid, const std::vector<uint8_t>& pages) {
+  if (findTag(uid) != nullptr) return;
+  Tag tag = {uid, pages, false, false};
+  tags.push_back(tag);
+  tryDetect();
+}
+
+void Pn532Sim::removeTag(const std::vector<uint8_t>& uid) {
+  for (size_t i = 0; i < tags.size(); i++) {
+    if (tags[i].uid == uid) {
+      tags.erase(tags.begin() + i);
+      return;
+    }
+  }
+}
+
+void Pn532Sim::removeAllTags() { tags.clear(); }
+
+void Pn532Sim::injectDetectionResponse(const std::vector<uint8_t>& frame) {
+  injected = frame;
+  tryDetect();
+}
+
+void Pn532Sim::onWrite(const uint8_t* data, size_t length) {
+  if (length >= sizeof(kAckFrame) && memcmp(data, kAckFrame, sizeof(kAckFrame)) == 0) {
+    epoch++; // Abort: whatever was running or scheduled is dropped
+    armed = false;
+    commandPending = false;
+    ready = false;
+    output.clear();
+    setIrq(HIGH);
+    return;
+  }
+  if (length < 8 || data[0] != 0x00 || data[1] != 0x00 || data[2] != 0xFF || data[5] != kHostToPn532 ||
+      (size_t)data[3] + 7 > length) {
+    return; // Not a frame the PN532 would take
+  }
+  epoch++;
+  armed = false;
+  commandCount++;
+  command.assign(data + 6, data + 5 + data[3]);
+  commandPending = true;
+  output.assign(kAckFrame, kAckFrame + sizeof(kAckFrame));
+  ready = false;
+  setIrq(HIGH);
+  uint32_t current = epoch;
+  scheduleAfter(kAckUs, [this, current] {
+    if (epoch != current) return;
+    ready = true;
+    setIrq(LOW);
+  });
+}
+
+void Pn532Sim::onRead(uint8_t* data, size_t length) {
+  memset(data, 0, length);
+  if (length == 0 || !ready) {
+    return; // Status 0x00: busy
+  }
+  data[0] = 0x01;
+  memcpy(data + 1, output.data(), std::min(length - 1, output.size()));
+  if (length == 1) {
+    return; // Status poll only, the frame stays
+  }
+  bool wasAck = output.size() == sizeof(kAckFrame) && memcmp(output.data(), kAckFrame, sizeof(kAckFrame)) == 0;
+  ready = false;
+  output.clear();
+  setIrq(HIGH);
+  if (wasAck && commandPending) {
+    commandPending = false;
+    execute();
+  }
+}
+
+void Pn532Sim::execute() {
+  if (command.empty()) return;
+  uint8_t code = command[0];
+  const uint8_t* params = command.data() + 1;
+  size_t paramLength = command.size() - 1;
+
+  switch (code) {
+    case kGetFirmwareVersion:
+      respond(code, {0x32, 0x01, 0x06, 0x07}, kCommandUs); // PN532 v1.6, ISO14443A/B and 18092
+      break;
+    case kSamConfiguration:
+      respond(code, {}, kCommandUs);
+      break;
+    case kInListPassiveTarget:
+      for (Tag& tag : tags) tag.inlisted = false;
+      maxTargets = paramLength > 0 && params[0] >= 1 && params[0] <= 2 ? params[0] : 1;
+      armed = true;
+      tryDetect();
+      break;
+    case kInDataExchange: {
+      Tag* tag = paramLength >= 3 ? inlistedTarget(params[0]) : nullptr;
+      if (tag == nullptr || params[1] != kNtagRead) {
+        respond(code, {0x01}, kReadUs); // Timeout: nothing answered
+        break;
+      }
+      std::vector<uint8_t> payload = {0x00};
+      for (size_t i = 0; i < 16; i++) {
+        size_t at = (size_t)params[2] * 4 + i;
+        payload.push_back(at < tag->pages.size() ? tag->pages[at] : 0x00);
+      }
+      respond(code, payload, kReadUs);
+      break;
+    }
+    case kInRelease: {
+      uint8_t tg = paramLength > 0 ? params[0] : 0;
+      for (size_t i = 0, n = 0; i < tags.size(); i++) {
+        if (!tags[i].inlisted) continue;
+        n++;
+        if (tg == 0 || tg == n) {
+          tags[i].halted = true; // HLTA: silent until it leaves the field
+          tags[i].inlisted = false;
+        }
+      }
+      respond(code, {0x00}, kCommandUs);
+      break;
+    }
+    default:
+      respond(code, {0x00}, kCommandUs);
+      break;
+  }
+}
+
+void Pn532Sim::respond(uint8_t code, const std::vector<uint8_t>& payload, uint32_t afterUs) {
+  std::vector<uint8_t> data = {kPn532ToHost, (uint8_t)(code + 1)};
+  data.insert(data.end(), payload.begin(), payload.end());
+  std::vector<uint8_t> frame = buildFrame(data);
+  uint32_t current = epoch;
+  scheduleAfter(afterUs, [this, current, frame] {
+    if (epoch == current) setOutput(frame);
+  });
+}
+
+void Pn532Sim::setOutput(const std::vector<uint8_t>& frame) {
+  output = frame;
+  ready = true;
+  setIrq(LOW);
+}
+
+void Pn532Sim::setIrq(int level) {
+  if (irqPin >= 0) setPinLevel((uint8_t)irqPin, level);
+}
+
+// An armed InListPassiveTarget answers once a tag that is not halted is in the
+// field; the anticollision loop costs extra time per additional target.
+void Pn532Sim::tryDetect() {
+  if (!armed) return;
+  size_t eligible = 0;
+  for (const Tag& tag : tags) eligible += tag.halted ? 0 : 1;
+  if (eligible == 0 && injected.empty()) return;
+  size_t targets = std::min<size_t>(std::max<size_t>(eligible, 1), maxTargets);
+  armed = false; // Until the response is built; an abort in between cancels it
+  uint32_t current = epoch;
+  scheduleAfter(kDetectUs + (targets - 1) * kExtraTargetUs, [this, current] {
+    if (epoch != current) return;
+    detectionCount++;
+    if (!injected.empty()) {
+      setOutput(injected);
+      injected.clear();
+      return;
+    }
+    std::vector<uint8_t> payload = {0x00};
+    uint8_t found = 0;
+    for (Tag& tag : tags) {
+      if (tag.halted || found >= maxTargets) continue;
+      found++;
+      tag.inlisted = true;
+      payload.push_back(found);                   // Tg
+      payload.insert(payload.end(), {0x00, 0x44}); // SENS_RES of an NTAG21x
+      payload.push_back(0x00);                    // SEL_RES
+      payload.push_back((uint8_t)tag.uid.size());
+      payload.insert(payload.end(), tag.uid.begin(), tag.uid.end());
+    }
+    if (found == 0) { // Left the field before anticollision finished
+      armed = true;
+      return;
+    }
+    payload[0] = found;
+    std::vector<uint8_t> data = {kPn532ToHost, (uint8_t)(kInListPassiveTarget + 1)};
+    data.insert(data.end(), payload.begin(), payload.end());
+    setOutput(buildFrame(data));
+  });
+}
+
+Pn532Sim::Tag* Pn532Sim::findTag(const std::vector<uint8_t>& uid) {
+  for (Tag& tag : tags) {
+    if (tag.uid == uid) return &tag;
+  }
+  return nullptr;
+}
+
+Pn532Sim::Tag* Pn532Sim::inlistedTarget(uint8_t tg) {
+  uint8_t n = 0;
+  for (Tag& tag : tags) {
+    if (tag.inlisted && ++n == tg) return &tag;
+  }
+  return nullptr;
+}
+
+Pn532Sim& pn532() {
+  static Pn532Sim chip;
+  return chip;
+}
+
+} // namespace hostfake
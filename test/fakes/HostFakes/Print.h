@@ -0,0 +1,99 @@
+// Arduino Print/Printable as in the ESP32 core: every overload funnels into write().
+#pragma once
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "WString.h"
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class Print;
+
+class Printable {
+ public:
+  virtual ~Printable() {}
+  virtual size_t printTo(Print& p) const = 0;
+};
+
+class Print {
+ public:
+  virtual ~Print() {}
+
+  virtual size_t write(uint8_t) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) {
+      if (!write(*buffer++)) break;
+      n++;
+    }
+    return n;
+  }
+  size_t write(const char* str) { return str ? write((const uint8_t*)str, strlen(str)) : 0; }
+  size_t write(const char* buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+  virtual int availableForWrite() { return 0; }
+  virtual void flush() {}
+
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+    va_list args;
+    va_start(args, format);
+    char small[64];
+    va_list copy;
+    va_copy(copy, args);
+    int len = vsnprintf(small, sizeof(small), format, copy);
+    va_end(copy);
+    size_t n = 0;
+    if (len >= (int)sizeof(small)) {
+      char* buffer = new char[len + 1];
+      vsnprintf(buffer, len + 1, format, args);
+      n = write((const uint8_t*)buffer, len);
+      delete[] buffer;
+    } else if (len > 0) {
+      n = write((const uint8_t*)small, len);
+    }
+    va_end(args);
+    return n;
+  }
+
+  size_t print(const __FlashStringHelper* str) { return write(reinterpret_cast<const char*>(str)); }
+  size_t print(const String& str) { return write((const uint8_t*)str.c_str(), str.length()); }
+  size_t print(const char* str) { return write(str); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(unsigned char value, int base = DEC) { return print((unsigned long)value, base); }
+  size_t print(int value, int base = DEC) { return print((long)value, base); }
+  size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+  size_t print(long value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+  size_t print(unsigned long value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+  size_t print(long long value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+  size_t print(unsigned long long value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+  size_t print(double value, int digits = 2) { return print(String(value, (unsigned int)digits)); }
+  size_t print(const Printable& printable) { return printable.printTo(*this); }
+  size_t print(const struct tm* timeinfo, const char* format = NULL) {
+    char buffer[64];
+    size_t len = strftime(buffer, sizeof(buffer), format ? format : "%c", timeinfo);
+    return write((const uint8_t*)buffer, len);
+  }
+
+  size_t println() { return write("\r\n"); }
+  template <typename T>
+  size_t println(const T& value) {
+    size_t n = print(value);
+    return n + println();
+  }
+  template <typename T>
+  size_t println(const T& value, int base) {
+    size_t n = print(value, base);
+    return n + println();
+  }
+  size_t println(const struct tm* timeinfo, const char* format = NULL) {
+    size_t n = print(timeinfo, format);
+    return n + println();
+  }
+};
@@ -0,0 +1,57 @@
+// No SPI device on this board; the class exists for the libraries that can use one.
+#pragma once
+
+#include <Arduino.h>
+
+#define SPI_HAS_TRANSACTION
+#define SPI_MODE0 0
+#define SPI_MODE1 1
+#define SPI_MODE2 2
+#define SPI_MODE3 3
+#define SPI_LSBFIRST 0
+#define SPI_MSBFIRST 1
+
+class SPISettings {
+ public:
+  SPISettings(uint32_t clock = 1000000, uint8_t bitOrder = SPI_MSBFIRST, uint8_t dataMode = SPI_MODE0)
+      : clock(clock), bitOrder(bitOrder), dataMode(dataMode) {}
+  uint32_t clock;
+  uint8_t bitOrder;
+  uint8_t dataMode;
+};
+
+class SPIClass {
+ public:
+  bool begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) {
+    (void)sck, (void)miso, (void)mosi, (void)ss;
+    return true;
+  }
+  void end() {}
+  void beginTransaction(SPISettings settings) { (void)settings; }
+  void endTransaction() {}
+  void setFrequency(uint32_t freq) { (void)freq; }
+  void setClockDivider(uint32_t divider) { (void)divider; }
+  void setBitOrder(uint8_t bitOrder) { (void)bitOrder; }
+  void setDataMode(uint8_t dataMode) { (void)dataMode; }
+
+  uint8_t transfer(uint8_t data) {
+    (void)data;
+    return 0xFF;
+  }
+  uint16_t transfer16(uint16_t data) {
+    (void)data;
+    return 0xFFFF;
+  }
+  void transfer(void* data, uint32_t size) { memset(data, 0xFF, size); }
+  void transferBytes(const uint8_t* data, uint8_t* out, uint32_t size) {
+    (void)data;
+    if (out != nullptr) memset(out, 0xFF, size);
+  }
+  void write(uint8_t data) { (void)data; }
+  void write16(uint16_t data) { (void)data; }
+  void write32(uint32_t data) { (void)data; }
+  void writeBytes(const uint8_t* data, uint32_t size) { (void)data, (void)size; }
+  void writePixels(const void* data, uint32_t size) { (void)data, (void)size; }
+};
+
+extern SPIClass SPI;
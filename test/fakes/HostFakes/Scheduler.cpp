@@ -0,0 +1,492 @@
+// FreeRTOS on the host. Each task gets a thread, but a single baton decides which
+// one runs: a task keeps it until it blocks (delay, notification, queue, semaphore,
+// bus transfer), then the highest-priority ready task takes over, round-robin among
+// equals. When nothing is ready the clock jumps to the next timer or timeout. Runs
+// are therefore repeatable, and CPU time is not modelled: code between two blocking
+// calls takes zero virtual time.
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include "HostFakesInternal.h"
+
+using hostfake::detail::kNever;
+
+struct hostTask {
+  std::string name;
+  TaskFunction_t code;
+  void* parameters;
+  UBaseType_t priority;
+  std::thread thread;
+  std::condition_variable wake;
+  uint32_t notifications;
+  bool blocked;
+  std::function<bool()> until;
+  uint64_t wakeAt;
+  bool killed;
+  bool ended;
+};
+
+struct hostQueue {
+  UBaseType_t length;
+  UBaseType_t itemSize;
+  std::deque<std::vector<uint8_t>> items;
+  bool isMutex;
+  TaskHandle_t holder;
+};
+
+namespace {
+
+struct TaskKilled {};
+
+std::mutex baton;
+hostTask* running = nullptr;
+std::vector<hostTask*> tasks;
+thread_local hostTask* self = nullptr;
+uint64_t clockUs = 0;
+std::multimap<uint64_t, std::function<void()>> timers; // Equal due times fire in the order scheduled
+hostTask* sleeper = nullptr;
+bool inScheduler = false;
+
+hostTask* newTask(const char* name, TaskFunction_t code, void* parameters, UBaseType_t priority) {
+  hostTask* task = new hostTask();
+  task->name = name ? name : "";
+  task->code = code;
+  task->parameters = parameters;
+  task->priority = priority;
+  task->notifications = 0;
+  task->blocked = false;
+  task->wakeAt = kNever;
+  task->killed = false;
+  task->ended = false;
+  return task;
+}
+
+// The thread that first touches the fakes is the Arduino loopTask (priority 1).
+hostTask* current() {
+  if (self == nullptr) {
+    if (running != nullptr) {
+      fprintf(stderr, "hostfake: a thread outside the scheduler called into FreeRTOS\n");
+      abort();
+    }
+    self = newTask("loopTask", nullptr, nullptr, 1);
+    tasks.push_back(self);
+    running = self;
+  }
+  return self;
+}
+
+bool isReady(hostTask* task) {
+  if (task->ended) return false;
+  if (task->killed) return true;
+  if (sleeper != nullptr && task != sleeper) return false;
+  if (!task->blocked) return true;
+  if (task->until && task->until()) return true;
+  return clockUs >= task->wakeAt;
+}
+
+UBaseType_t effectivePriority(hostTask* task) { return task->killed ? UINT32_MAX : task->priority; }
+
+// Highest priority wins; among equals the first after the running task, so a task
+// that yields lets its peers go first.
+hostTask* pickNext() {
+  size_t start = 0;
+  for (size_t i = 0; i < tasks.size(); i++) {
+    if (tasks[i] == running) start = i + 1;
+  }
+  hostTask* best = nullptr;
+  for (size_t n = 0; n < tasks.size(); n++) {
+    hostTask* task = tasks[(start + n) % tasks.size()];
+    if (isReady(task) && (best == nullptr || effectivePriority(task) > effectivePriority(best))) {
+      best = task;
+    }
+  }
+  return best;
+}
+
+void fireDueTimers() {
+  while (!timers.empty() && timers.begin()->first <= clockUs) {
+    std::function<void()> action = std::move(timers.begin()->second);
+    timers.erase(timers.begin());
+    action();
+  }
+}
+
+void dumpTasks() {
+  for (hostTask* task : tasks) {
+    fprintf(stderr, "  %-10s prio %u %s%s\n", task->name.c_str(), task->priority,
+            task->ended ? "ended" : task->blocked ? "blocked" : "ready",
+            task->blocked && task->wakeAt == kNever ? " forever" : "");
+  }
+}
+
+void advanceClock() {
+  uint64_t target = timers.empty() ? kNever : timers.begin()->first;
+  for (hostTask* task : tasks) {
+    if (!task->ended && task->blocked && (sleeper == nullptr || task == sleeper)) {
+      target = std::min(target, task->wakeAt);
+    }
+  }
+  if (target == kNever) {
+    fprintf(stderr, "hostfake: deadlock at %llu us, every task waits forever:\n", (unsigned long long)clockUs);
+    dumpTasks();
+    abort();
+  }
+  if (target > clockUs) clockUs = target;
+  fireDueTimers();
+}
+
+hostTask* findNextAdvancing() {
+  inScheduler = true;
+  for (;;) {
+    fireDueTimers();
+    hostTask* next = pickNext();
+    if (next != nullptr) {
+      inScheduler = false;
+      return next;
+    }
+    advanceClock();
+  }
+}
+
+void switchTo(hostTask* next) {
+  std::unique_lock<std::mutex> lock(baton);
+  running = next;
+  next->wake.notify_one();
+  self->wake.wait(lock, [] { return running == self; });
+}
+
+void reschedule() {
+  hostTask* next = findNextAdvancing();
+  if (next != self) switchTo(next);
+  if (self->killed && !self->ended && std::uncaught_exceptions() == 0) throw TaskKilled();
+}
+
+void releaseMutexesHeldBy(hostTask* task);
+
+void taskMain(hostTask* task) {
+  self = task;
+  {
+    std::unique_lock<std::mutex> lock(baton);
+    task->wake.wait(lock, [task] { return running == task; });
+  }
+  if (!task->killed) {
+    try {
+      task->code(task->parameters);
+    } catch (const TaskKilled&) {
+    }
+  }
+  task->ended = true;
+  task->blocked = false;
+  releaseMutexesHeldBy(task);
+  hostTask* next = findNextAdvancing();
+  std::unique_lock<std::mutex> lock(baton);
+  running = next;
+  next->wake.notify_one();
+}
+
+std::vector<hostQueue*> queues;
+
+void releaseMutexesHeldBy(hostTask* task) {
+  for (hostQueue* queue : queues) {
+    if (queue->isMutex && queue->holder == task) {
+      queue->holder = nullptr;
+      queue->items.emplace_back();
+    }
+  }
+}
+
+} // namespace
+
+namespace hostfake {
+namespace detail {
+
+bool block(const std::function<bool()>& until, uint64_t wakeAt) {
+  hostTask* me = current();
+  if (me->killed) return false; // Unwinding, nothing waits any more
+  if (until ? until() : wakeAt <= clockUs) {
+    return true;
+  }
+  me->blocked = true;
+  me->until = until;
+  me->wakeAt = wakeAt;
+  reschedule();
+  me->blocked = false;
+  me->until = nullptr;
+  me->wakeAt = kNever;
+  return until ? until() : true;
+}
+
+void preemptIfHigherReady() {
+  hostTask* me = current();
+  if (inScheduler) return; // Called from a timer, the scheduler is already choosing
+  for (hostTask* task : tasks) {
+    if (task != me && task->priority > me->priority && isReady(task)) {
+      reschedule();
+      return;
+    }
+  }
+}
+
+uint64_t ticksToDeadline(TickType_t ticks) {
+  return ticks == portMAX_DELAY ? kNever : clockUs + (uint64_t)ticks * portTICK_PERIOD_MS * 1000ULL;
+}
+
+void freezeOthers(TaskHandle_t task) { sleeper = task; }
+
+// Wakes every other task with 'killed' set; each unwinds out of its blocking call
+// and hands the baton on. Their threads are then joined.
+void endOtherTasks() {
+  hostTask* me = current();
+  sleeper = nullptr;
+  bool pending = false;
+  for (hostTask* task : tasks) {
+    if (task != me && !task->ended) {
+      task->killed = true;
+      pending = true;
+    }
+  }
+  while (pending) {
+    reschedule();
+    pending = false;
+    for (hostTask* task : tasks) {
+      pending |= task != me && !task->ended;
+    }
+  }
+  for (hostTask* task : tasks) {
+    if (task != me) {
+      task->thread.join();
+      delete task;
+    }
+  }
+  tasks.assign(1, me);
+  me->notifications = 0;
+}
+
+void resetClock() {
+  clockUs = 0;
+  timers.clear();
+}
+
+} // namespace detail
+
+uint64_t nowMicros() { return clockUs; }
+
+void scheduleAfter(uint64_t delayUs, std::function<void()> action) {
+  timers.emplace(clockUs + delayUs, std::move(action));
+}
+
+bool runUntil(const std::function<bool()>& done, uint32_t timeoutMs) {
+  return detail::block(done, clockUs + (uint64_t)timeoutMs * 1000ULL);
+}
+
+TaskHandle_t findTask(const char* name) {
+  for (hostTask* task : tasks) {
+    if (!task->ended && task->name == name) return task;
+  }
+  return nullptr;
+}
+
+} // namespace hostfake
+
+//------------------------------------------------------------------------------
+// Tasks
+//------------------------------------------------------------------------------
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char* name, uint32_t stackDepth, void* parameters,
+                                   UBaseType_t priority, TaskHandle_t* createdTask, BaseType_t coreId) {
+  (void)stackDepth;
+  (void)coreId;
+  current();
+  hostTask* task = newTask(name, code, parameters, priority);
+  tasks.push_back(task);
+  task->thread = std::thread(taskMain, task);
+  if (createdTask != nullptr) *createdTask = task;
+  hostfake::detail::preemptIfHigherReady();
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t code, const char* name, uint32_t stackDepth, void* parameters,
+                       UBaseType_t priority, TaskHandle_t* createdTask) {
+  return xTaskCreatePinnedToCore(code, name, stackDepth, parameters, priority, createdTask, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  hostTask* me = current();
+  if (task == nullptr || task == me) {
+    me->killed = true;
+    throw TaskKilled();
+  }
+  task->killed = true;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() { return current(); }
+
+void vTaskDelay(TickType_t ticks) {
+  if (ticks == 0) { // Plain yield: let equal or higher priorities run first
+    current();
+    reschedule();
+    return;
+  }
+  hostfake::detail::block(nullptr, hostfake::detail::ticksToDeadline(ticks));
+}
+
+TickType_t xTaskGetTickCount() { return (TickType_t)(clockUs / 1000ULL); }
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait) {
+  hostTask* me = current();
+  if (me->notifications == 0 && ticksToWait > 0) {
+    hostfake::detail::block([me] { return me->notifications > 0; }, hostfake::detail::ticksToDeadline(ticksToWait));
+  }
+  uint32_t value = me->notifications;
+  if (value > 0) {
+    me->notifications = clearCountOnExit ? 0 : value - 1;
+  }
+  return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  task->notifications++;
+  hostfake::detail::preemptIfHigherReady();
+  return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken) {
+  task->notifications++;
+  if (higherPriorityTaskWoken != nullptr && running != nullptr && task->priority > running->priority) {
+    *higherPriorityTaskWoken = pdTRUE;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Queues and semaphores
+//------------------------------------------------------------------------------
+namespace {
+
+hostQueue* newQueue(UBaseType_t length, UBaseType_t itemSize, bool isMutex) {
+  hostQueue* queue = new hostQueue();
+  queue->length = length;
+  queue->itemSize = itemSize;
+  queue->isMutex = isMutex;
+  queue->holder = nullptr;
+  queues.push_back(queue);
+  return queue;
+}
+
+bool waitFor(const std::function<bool()>& condition, TickType_t ticks) {
+  if (condition()) return true;
+  if (ticks == 0) return false;
+  return hostfake::detail::block(condition, hostfake::detail::ticksToDeadline(ticks));
+}
+
+} // namespace
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) { return newQueue(length, itemSize, false); }
+
+void vQueueDelete(QueueHandle_t queue) {
+  for (size_t i = 0; i < queues.size(); i++) {
+    if (queues[i] == queue) queues.erase(queues.begin() + i);
+  }
+  delete queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+  if (!waitFor([queue] { return queue->items.size() < queue->length; }, ticksToWait)) {
+    return errQUEUE_FULL;
+  }
+  const uint8_t* bytes = static_cast<const uint8_t*>(item);
+  queue->items.emplace_back(bytes, bytes + queue->itemSize);
+  hostfake::detail::preemptIfHigherReady();
+  return pdPASS;
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+  return xQueueSend(queue, item, ticksToWait);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* higherPriorityTaskWoken) {
+  (void)higherPriorityTaskWoken;
+  if (queue->items.size() >= queue->length) return errQUEUE_FULL;
+  const uint8_t* bytes = static_cast<const uint8_t*>(item);
+  queue->items.emplace_back(bytes, bytes + queue->itemSize);
+  return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* buffer, TickType_t ticksToWait) {
+  if (!waitFor([queue] { return !queue->items.empty(); }, ticksToWait)) {
+    return errQUEUE_EMPTY;
+  }
+  memcpy(buffer, queue->items.front().data(), queue->itemSize);
+  queue->items.pop_front();
+  return pdPASS;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+  queue->items.clear();
+  return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) { return queue->items.size(); }
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+  hostQueue* mutex = newQueue(1, 0, true);
+  mutex->items.emplace_back();
+  return mutex;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() { return newQueue(1, 0, false); }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait) {
+  hostTask* me = current();
+  if (semaphore->isMutex && semaphore->holder == me && ticksToWait == portMAX_DELAY) {
+    fprintf(stderr, "hostfake: task '%s' takes a mutex it already holds and would block forever\n", me->name.c_str());
+    abort();
+  }
+  if (!waitFor([semaphore] { return !semaphore->items.empty(); }, ticksToWait)) {
+    return pdFALSE;
+  }
+  semaphore->items.pop_front();
+  if (semaphore->isMutex) semaphore->holder = me;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+  if (semaphore->items.size() >= semaphore->length) return pdFALSE;
+  if (semaphore->isMutex) {
+    if (semaphore->holder != current()) return pdFALSE;
+    semaphore->holder = nullptr;
+  }
+  semaphore->items.emplace_back();
+  hostfake::detail::preemptIfHigherReady();
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t* higherPriorityTaskWoken) {
+  (void)higherPriorityTaskWoken;
+  if (semaphore->items.size() >= semaphore->length) return pdFALSE;
+  semaphore->items.emplace_back();
+  return pdTRUE;
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t semaphore) { return semaphore->items.size(); }
+
+//------------------------------------------------------------------------------
+// Arduino timing, on the same clock
+//------------------------------------------------------------------------------
+unsigned long millis() { return (unsigned long)(clockUs / 1000ULL); }
+unsigned long micros() { return (unsigned long)clockUs; }
+
+void delay(uint32_t ms) {
+  if (ms == 0) {
+    vTaskDelay(0);
+    return;
+  }
+  hostfake::detail::block(nullptr, clockUs + (uint64_t)ms * 1000ULL);
+}
+
+// A busy wait on the chip; here it still lets the clock move.
+void delayMicroseconds(uint32_t us) { hostfake::detail::block(nullptr, clockUs + us); }
+
+void yield() { vTaskDelay(0); }
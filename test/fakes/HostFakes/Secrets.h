@@ -0,0 +1,10 @@
+// Placeholder credentials for the native build; the device build uses the real,
+// untracked Secrets.h.
+#pragma once
+
+#define WIFI_SSID "host-ssid"
+#define WIFI_PASSWORD "host-password"
+#define AIRTABLE_API_KEY "keyHOSTFAKE"
+#define AIRTABLE_BASE_ID "appHOSTFAKE"
+#define AIRTABLE_TABLE_NAME "Equipment Pieces"
+#define ADMIN_TAG_UID_STRING "04AABBCCDDEEFF"
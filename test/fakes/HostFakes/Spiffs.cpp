@@ -0,0 +1,153 @@
+// SPIFFS in memory. Paths are flat strings as on SPIFFS; renaming onto an
+// existing path fails, as it does there.
+#include <SPIFFS.h>
+
+#include <map>
+
+#include "HostFakesInternal.h"
+
+fs::SPIFFSFS SPIFFS;
+
+namespace fs {
+
+struct FileNode {
+  std::string data;
+};
+
+} // namespace fs
+
+namespace {
+
+const size_t kDefaultCapacity = 1345 * 1024; // The default partition table's SPIFFS, less metadata
+
+std::map<std::string, std::shared_ptr<fs::FileNode>> files;
+size_t capacity = kDefaultCapacity;
+
+size_t usedBytes() {
+  size_t used = 0;
+  for (const auto& entry : files) used += entry.second->data.size();
+  return used;
+}
+
+} // namespace
+
+namespace fs {
+
+File::File(std::shared_ptr<FileNode> fileNode, const std::string& path, char mode)
+    : node(fileNode), filePath(path), fileMode(mode), pos(mode == 'a' ? fileNode->data.size() : 0) {}
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+  if (!node || fileMode == 'r') return 0;
+  size_t room = capacity > ::usedBytes() ? capacity - ::usedBytes() : 0;
+  if (fileMode == 'a') pos = node->data.size();
+  size_t overwrite = std::min(size, node->data.size() - pos);
+  size_t n = std::min(size, overwrite + room);
+  node->data.replace(pos, overwrite, (const char*)buffer, n);
+  pos += n;
+  return n;
+}
+
+int File::available() { return node ? (int)(node->data.size() - pos) : 0; }
+
+int File::read() { return node && pos < node->data.size() ? (uint8_t)node->data[pos++] : -1; }
+
+int File::peek() { return node && pos < node->data.size() ? (uint8_t)node->data[pos] : -1; }
+
+size_t File::read(uint8_t* buffer, size_t size) {
+  if (!node) return 0;
+  size_t n = std::min(size, node->data.size() - pos);
+  memcpy(buffer, node->data.data() + pos, n);
+  pos += n;
+  return n;
+}
+
+bool File::seek(uint32_t offset, SeekMode mode) {
+  if (!node) return false;
+  size_t base = mode == SeekSet ? 0 : mode == SeekCur ? pos : node->data.size();
+  if (base + offset > node->data.size()) return false;
+  pos = base + offset;
+  return true;
+}
+
+size_t File::size() const { return node ? node->data.size() : 0; }
+
+const char* File::name() const {
+  size_t slash = filePath.rfind('/');
+  return filePath.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+}
+
+File FS::open(const char* path, const char* mode, const bool create) {
+  (void)create;
+  char m = mode != nullptr ? mode[0] : 'r';
+  auto it = files.find(path);
+  if (m == 'r') {
+    return it == files.end() ? File() : File(it->second, path, 'r');
+  }
+  std::shared_ptr<FileNode> node;
+  if (it == files.end() || m == 'w') {
+    node = std::make_shared<FileNode>(); // "w" truncates by starting a new file
+    files[path] = node;
+  } else {
+    node = it->second;
+  }
+  return File(node, path, m);
+}
+
+bool FS::exists(const char* path) { return files.count(path) > 0; }
+
+bool FS::remove(const char* path) { return files.erase(path) > 0; }
+
+bool FS::rename(const char* pathFrom, const char* pathTo) {
+  auto from = files.find(pathFrom);
+  if (from == files.end() || files.count(pathTo) > 0) return false;
+  files[pathTo] = from->second;
+  files.erase(pathFrom);
+  return true;
+}
+
+bool SPIFFSFS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles, const char* partitionLabel) {
+  (void)formatOnFail;
+  (void)basePath;
+  (void)maxOpenFiles;
+  (void)partitionLabel;
+  return true;
+}
+
+bool SPIFFSFS::format() {
+  files.clear();
+  return true;
+}
+
+size_t SPIFFSFS::totalBytes() { return capacity; }
+
+size_t SPIFFSFS::usedBytes() { return ::usedBytes(); }
+
+} // namespace fs
+
+namespace hostfake {
+
+void writeFile(const char* path, const std::string& contents) {
+  files[path] = std::make_shared<fs::FileNode>();
+  files[path]->data = contents;
+}
+
+bool readFile(const char* path, std::string* contents) {
+  auto it = files.find(path);
+  if (it == files.end()) return false;
+  *contents = it->second->data;
+  return true;
+}
+
+bool fileExists(const char* path) { return files.count(path) > 0; }
+
+void setFlashCapacity(size_t bytes) { capacity = bytes; }
+
+namespace detail {
+
+void resetSpiffs() {
+  files.clear();
+  capacity = kDefaultCapacity;
+}
+
+} // namespace detail
+} // namespace hostfake
@@ -0,0 +1,88 @@
+// Arduino Stream with the ESP32 core's timed reads. Waiting for data calls delay(1)
+// so the virtual clock moves; a busy loop on millis() would never time out here.
+#pragma once
+
+#include "Print.h"
+
+void delay(uint32_t ms);
+unsigned long millis();
+
+class Stream : public Print {
+ public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void setTimeout(unsigned long timeout) { _timeout = timeout; }
+  unsigned long getTimeout() const { return _timeout; }
+
+  bool find(const char* target) { return find(target, strlen(target)); }
+  bool find(const char* target, size_t length) {
+    if (length == 0) return true;
+    size_t index = 0;
+    int c;
+    while ((c = timedRead()) >= 0) {
+      if (c != target[index]) index = 0;
+      if (c == target[index] && ++index >= length) return true;
+    }
+    return false;
+  }
+  bool find(char target) { return find(&target, 1); }
+
+  virtual size_t readBytes(char* buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+      int c = timedRead();
+      if (c < 0) break;
+      *buffer++ = (char)c;
+      count++;
+    }
+    return count;
+  }
+  virtual size_t readBytes(uint8_t* buffer, size_t length) { return readBytes((char*)buffer, length); }
+  size_t readBytesUntil(char terminator, char* buffer, size_t length) {
+    size_t index = 0;
+    while (index < length) {
+      int c = timedRead();
+      if (c < 0 || c == terminator) break;
+      *buffer++ = (char)c;
+      index++;
+    }
+    return index;
+  }
+
+  String readString() {
+    String ret;
+    int c;
+    while ((c = timedRead()) >= 0) ret += (char)c;
+    return ret;
+  }
+  String readStringUntil(char terminator) {
+    String ret;
+    int c;
+    while ((c = timedRead()) >= 0 && c != terminator) ret += (char)c;
+    return ret;
+  }
+
+ protected:
+  int timedRead() {
+    unsigned long start = millis();
+    do {
+      int c = read();
+      if (c >= 0) return c;
+      delay(1);
+    } while (millis() - start < _timeout);
+    return -1;
+  }
+  int timedPeek() {
+    unsigned long start = millis();
+    do {
+      int c = peek();
+      if (c >= 0) return c;
+      delay(1);
+    } while (millis() - start < _timeout);
+    return -1;
+  }
+
+  unsigned long _timeout = 1000;
+};
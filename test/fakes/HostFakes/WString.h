@@ -0,0 +1,197 @@
+// Arduino String on top of std::string, with the subset of the ESP32 core API the
+// firmware and its libraries use.
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper*>(string_literal))
+
+class String {
+ public:
+  String() {}
+  String(const char* cstr) : s(cstr ? cstr : "") {}
+  String(const char* cstr, unsigned int length) : s(cstr ? std::string(cstr, length) : std::string()) {}
+  String(const __FlashStringHelper* str) : String(reinterpret_cast<const char*>(str)) {}
+  String(const std::string& str) : s(str) {}
+  String(const String&) = default;
+  String(String&&) = default;
+  explicit String(char c) : s(1, c) {}
+  explicit String(unsigned char value, unsigned char base = 10) { setUnsigned(value, base); }
+  explicit String(int value, unsigned char base = 10) { setSigned(value, base); }
+  explicit String(unsigned int value, unsigned char base = 10) { setUnsigned(value, base); }
+  explicit String(long value, unsigned char base = 10) { setSigned(value, base); }
+  explicit String(unsigned long value, unsigned char base = 10) { setUnsigned(value, base); }
+  explicit String(long long value, unsigned char base = 10) { setSigned(value, base); }
+  explicit String(unsigned long long value, unsigned char base = 10) { setUnsigned(value, base); }
+  explicit String(float value, unsigned int decimals = 2) { setFloat(value, decimals); }
+  explicit String(double value, unsigned int decimals = 2) { setFloat(value, decimals); }
+
+  String& operator=(const String&) = default;
+  String& operator=(String&&) = default;
+  String& operator=(const char* cstr) {
+    s = cstr ? cstr : "";
+    return *this;
+  }
+
+  const char* c_str() const { return s.c_str(); }
+  unsigned int length() const { return s.size(); }
+  bool isEmpty() const { return s.empty(); }
+  bool reserve(unsigned int size) {
+    s.reserve(size);
+    return true;
+  }
+  explicit operator bool() const { return true; } // Never a failed allocation here
+
+  bool concat(const String& str) {
+    s += str.s;
+    return true;
+  }
+  bool concat(const char* cstr) {
+    if (!cstr) return false;
+    s += cstr;
+    return true;
+  }
+  bool concat(const char* cstr, unsigned int length) {
+    if (!cstr) return false;
+    s.append(cstr, length);
+    return true;
+  }
+  bool concat(char c) {
+    s += c;
+    return true;
+  }
+  template <typename T>
+  String& operator+=(const T& value) {
+    concat(value);
+    return *this;
+  }
+  bool concat(int value) { return concat(String(value)); }
+  bool concat(unsigned int value) { return concat(String(value)); }
+  bool concat(long value) { return concat(String(value)); }
+  bool concat(unsigned long value) { return concat(String(value)); }
+
+  bool equals(const String& other) const { return s == other.s; }
+  bool equals(const char* cstr) const { return s == (cstr ? cstr : ""); }
+  bool equalsIgnoreCase(const String& other) const {
+    if (s.size() != other.s.size()) return false;
+    for (size_t i = 0; i < s.size(); i++) {
+      if (tolower((unsigned char)s[i]) != tolower((unsigned char)other.s[i])) return false;
+    }
+    return true;
+  }
+  bool operator==(const String& other) const { return equals(other); }
+  bool operator==(const char* cstr) const { return equals(cstr); }
+  bool operator!=(const String& other) const { return !equals(other); }
+  bool operator!=(const char* cstr) const { return !equals(cstr); }
+  bool operator<(const String& other) const { return s < other.s; }
+  bool startsWith(const String& prefix) const { return s.compare(0, prefix.s.size(), prefix.s) == 0; }
+  bool endsWith(const String& suffix) const {
+    return s.size() >= suffix.s.size() && s.compare(s.size() - suffix.s.size(), suffix.s.size(), suffix.s) == 0;
+  }
+
+  char charAt(unsigned int index) const { return index < s.size() ? s[index] : 0; }
+  char operator[](unsigned int index) const { return charAt(index); }
+  char& operator[](unsigned int index) { return s[index]; }
+  int indexOf(char c, unsigned int from = 0) const { return position(s.find(c, from)); }
+  int indexOf(const String& str, unsigned int from = 0) const { return position(s.find(str.s, from)); }
+  int lastIndexOf(char c) const { return position(s.rfind(c)); }
+  String substring(unsigned int from) const { return substring(from, s.size()); }
+  String substring(unsigned int from, unsigned int to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= s.size()) return String();
+    return String(s.substr(from, std::min<size_t>(to, s.size()) - from));
+  }
+
+  void trim() {
+    size_t end = s.size();
+    while (end > 0 && isspace((unsigned char)s[end - 1])) end--;
+    size_t begin = 0;
+    while (begin < end && isspace((unsigned char)s[begin])) begin++;
+    s = s.substr(begin, end - begin);
+  }
+  void toUpperCase() {
+    for (char& c : s) c = toupper((unsigned char)c);
+  }
+  void toLowerCase() {
+    for (char& c : s) c = tolower((unsigned char)c);
+  }
+  void remove(unsigned int index) {
+    if (index < s.size()) s.erase(index);
+  }
+  void remove(unsigned int index, unsigned int count) {
+    if (index < s.size()) s.erase(index, count);
+  }
+  void replace(const String& find, const String& replacement) {
+    if (find.s.empty()) return;
+    for (size_t at = s.find(find.s); at != std::string::npos; at = s.find(find.s, at + replacement.s.size())) {
+      s.replace(at, find.s.size(), replacement.s);
+    }
+  }
+  long toInt() const { return atol(s.c_str()); }
+  float toFloat() const { return atof(s.c_str()); }
+  void toCharArray(char* buffer, unsigned int size) const { getBytes((unsigned char*)buffer, size); }
+  void getBytes(unsigned char* buffer, unsigned int size) const {
+    if (size == 0) return;
+    size_t n = std::min<size_t>(size - 1, s.size());
+    memcpy(buffer, s.data(), n);
+    buffer[n] = 0;
+  }
+
+ private:
+  static int position(size_t at) { return at == std::string::npos ? -1 : (int)at; }
+  void setUnsigned(unsigned long long value, unsigned char base) {
+    char digits[66];
+    int i = sizeof(digits) - 1;
+    digits[i] = '\0';
+    do {
+      unsigned digit = value % base;
+      digits[--i] = digit < 10 ? '0' + digit : 'A' + digit - 10;
+      value /= base;
+    } while (value > 0);
+    s = &digits[i];
+  }
+  void setSigned(long long value, unsigned char base) {
+    if (value < 0 && base == 10) {
+      setUnsigned(-(unsigned long long)value, base);
+      s.insert(0, 1, '-');
+    } else {
+      setUnsigned((unsigned long long)value, base);
+    }
+  }
+  void setFloat(double value, unsigned int decimals) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", (int)decimals, value);
+    s = buffer;
+  }
+
+  std::string s;
+};
+
+inline String operator+(const String& a, const String& b) {
+  String result(a);
+  result += b;
+  return result;
+}
+inline String operator+(const String& a, const char* b) {
+  String result(a);
+  result += b;
+  return result;
+}
+inline String operator+(const char* a, const String& b) {
+  String result(a);
+  result += b;
+  return result;
+}
+inline String operator+(const String& a, char b) {
+  String result(a);
+  result += b;
+  return result;
+}
+inline bool operator==(const char* a, const String& b) { return b == a; }
@@ -0,0 +1,99 @@
+// WiFi station and sockets. Connecting succeeds at once unless
+// hostfake::setWifiAvailable(false); sockets carry the scripted HTTP responses.
+#pragma once
+
+#include <Arduino.h>
+
+typedef enum {
+  WL_NO_SHIELD = 255,
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6,
+} wl_status_t;
+
+typedef enum {
+  WIFI_OFF = 0,
+  WIFI_MODE_NULL = 0,
+  WIFI_STA = 1,
+  WIFI_AP = 2,
+  WIFI_AP_STA = 3,
+} wifi_mode_t;
+
+class IPAddress : public Printable {
+ public:
+  IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : octets{a, b, c, d} {}
+  String toString() const {
+    char text[16];
+    snprintf(text, sizeof(text), "%u.%u.%u.%u", octets[0], octets[1], octets[2], octets[3]);
+    return String(text);
+  }
+  size_t printTo(Print& p) const override { return p.print(toString()); }
+
+ private:
+  uint8_t octets[4];
+};
+
+class WiFiClient : public Stream {
+ public:
+  virtual ~WiFiClient() {}
+  virtual uint8_t connected() { return open; }
+  virtual void stop() {
+    open = false;
+    rx.clear();
+    rxPos = 0;
+  }
+  explicit operator bool() { return open; }
+
+  int available() override { return (int)(rx.size() - rxPos); }
+  int read() override { return rxPos < rx.size() ? (uint8_t)rx[rxPos++] : -1; }
+  int peek() override { return rxPos < rx.size() ? (uint8_t)rx[rxPos] : -1; }
+  size_t readBytes(char* buffer, size_t length) override {
+    size_t n = std::min(length, rx.size() - rxPos);
+    memcpy(buffer, rx.data() + rxPos, n);
+    rxPos += n;
+    return n;
+  }
+  using Stream::readBytes;
+  size_t write(uint8_t c) override {
+    (void)c;
+    return 1;
+  }
+  size_t write(const uint8_t* buffer, size_t size) override {
+    (void)buffer;
+    return size;
+  }
+  using Print::write;
+
+  // Called by the HTTPClient fake: what the server sends next.
+  void hostDeliver(const std::string& bytes) {
+    open = true;
+    rx = bytes;
+    rxPos = 0;
+  }
+
+ private:
+  bool open = false;
+  std::string rx;
+  size_t rxPos = 0;
+};
+
+class WiFiClass {
+ public:
+  wl_status_t begin(const char* ssid, const char* passphrase = NULL);
+  bool disconnect(bool wifiOff = false, bool eraseAp = false);
+  wl_status_t status();
+  bool mode(wifi_mode_t mode);
+  wifi_mode_t getMode();
+  IPAddress localIP() { return IPAddress(192, 168, 1, 42); }
+  bool setSleep(bool enabled) {
+    (void)enabled;
+    return true;
+  }
+  int8_t RSSI() { return -55; }
+};
+
+extern WiFiClass WiFi;
@@ -0,0 +1,128 @@
+// The I2C bus: routes transfers to the attached simulated devices and charges
+// their time on the wire to the calling task.
+#include <SPI.h>
+#include <Wire.h>
+
+#include "HostFakesInternal.h"
+
+TwoWire Wire;
+SPIClass SPI;
+
+namespace {
+
+hostfake::I2cDevice* devices[128];
+hostfake::I2cStats stats;
+
+uint64_t busTimeUs(size_t bytes, uint32_t clock) {
+  uint64_t bits = (uint64_t)(1 + bytes) * 9;
+  return (bits * 1000000ULL + clock - 1) / clock;
+}
+
+} // namespace
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency) {
+  (void)sda;
+  (void)scl;
+  if (frequency != 0) clock = frequency;
+  return true;
+}
+
+bool TwoWire::setClock(uint32_t frequency) {
+  clock = frequency;
+  stats.clockChanges++;
+  return true;
+}
+
+void TwoWire::beginTransmission(uint16_t address) {
+  txAddress = address;
+  txLength = 0;
+}
+
+size_t TwoWire::write(uint8_t data) {
+  if (txLength >= I2C_BUFFER_LENGTH) return 0;
+  txBuffer[txLength++] = data;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t quantity) {
+  size_t n = 0;
+  while (n < quantity && write(data[n])) n++;
+  return n;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+  (void)sendStop;
+  hostfake::I2cDevice* device = txAddress < 128 ? devices[txAddress] : nullptr;
+  size_t length = device != nullptr ? txLength : 0; // A NACKed address ends the transfer
+  uint64_t busy = busTimeUs(length, clock);
+  stats.transactions++;
+  stats.bytes += 1 + length;
+  stats.busyUs += busy;
+  hostfake::detail::block(nullptr, hostfake::nowMicros() + busy);
+  txLength = 0;
+  if (device == nullptr) {
+    stats.nacks++;
+    return 2;
+  }
+  device->onWrite(txBuffer, length);
+  return 0;
+}
+
+size_t TwoWire::requestFrom(uint16_t address, size_t size, bool sendStop) {
+  (void)sendStop;
+  rxIndex = rxLength = 0;
+  hostfake::I2cDevice* device = address < 128 ? devices[address] : nullptr;
+  if (size > I2C_BUFFER_LENGTH) size = I2C_BUFFER_LENGTH;
+  size_t length = device != nullptr ? size : 0;
+  if (device != nullptr) device->onRead(rxBuffer, length); // Sampled at the start of the transfer
+  uint64_t busy = busTimeUs(length, clock);
+  stats.transactions++;
+  stats.bytes += 1 + length;
+  stats.busyUs += busy;
+  hostfake::detail::block(nullptr, hostfake::nowMicros() + busy);
+  if (device == nullptr) {
+    stats.nacks++;
+    return 0;
+  }
+  rxLength = length;
+  return length;
+}
+
+namespace hostfake {
+
+void attachI2cDevice(uint8_t address, I2cDevice* device) { devices[address & 0x7F] = device; }
+
+I2cStats& i2cStats() { return stats; }
+
+void Ssd1306Sim::onWrite(const uint8_t* data, size_t length) {
+  writes++;
+  if (length == 0) return;
+  if (data[0] == 0x40) {
+    dataBytes += length - 1;
+  } else {
+    commandBytes += length - 1;
+  }
+}
+
+void Ssd1306Sim::onRead(uint8_t* data, size_t length) { memset(data, 0, length); }
+
+Ssd1306Sim& ssd1306() {
+  static Ssd1306Sim display;
+  return display;
+}
+
+namespace detail {
+
+// The board: the PN532 and the OLED share the one bus.
+void resetWire() {
+  memset(devices, 0, sizeof(devices));
+  stats = I2cStats();
+  Wire.flush();
+  pn532().resetChip();
+  ssd1306() = Ssd1306Sim();
+  attachI2cDevice(Pn532Sim::kAddress, &pn532());
+  attachI2cDevice(Ssd1306Sim::kAddress, &ssd1306());
+}
+
+} // namespace detail
+} // namespace hostfake
@@ -0,0 +1,56 @@
+// TwoWire on the simulated bus (Wire.cpp). A transfer blocks the calling task for
+// its time on the wire, so other tasks run meanwhile, as with the ESP32 driver.
+#pragma once
+
+#include <Arduino.h>
+
+#define I2C_BUFFER_LENGTH 128
+
+class TwoWire : public Stream {
+ public:
+  bool begin() { return begin(-1, -1, 0); }
+  bool begin(int sda, int scl, uint32_t frequency = 0);
+  bool end() { return true; }
+  bool setClock(uint32_t frequency);
+  uint32_t getClock() { return clock; }
+  void setTimeOut(uint16_t timeOutMillis) { (void)timeOutMillis; }
+
+  void beginTransmission(uint16_t address);
+  void beginTransmission(uint8_t address) { beginTransmission((uint16_t)address); }
+  void beginTransmission(int address) { beginTransmission((uint16_t)address); }
+  uint8_t endTransmission(bool sendStop);
+  uint8_t endTransmission() { return endTransmission(true); }
+
+  size_t requestFrom(uint16_t address, size_t size, bool sendStop);
+  uint8_t requestFrom(uint16_t address, uint8_t size, bool sendStop) {
+    return (uint8_t)requestFrom(address, (size_t)size, sendStop);
+  }
+  uint8_t requestFrom(uint16_t address, uint8_t size, uint8_t sendStop) {
+    return (uint8_t)requestFrom(address, (size_t)size, (bool)sendStop);
+  }
+  uint8_t requestFrom(uint16_t address, uint8_t size) { return (uint8_t)requestFrom(address, (size_t)size, true); }
+  uint8_t requestFrom(uint8_t address, uint8_t size) { return (uint8_t)requestFrom((uint16_t)address, (size_t)size, true); }
+  uint8_t requestFrom(int address, int size) { return (uint8_t)requestFrom((uint16_t)address, (size_t)size, true); }
+
+  size_t write(uint8_t data) override;
+  size_t write(const uint8_t* data, size_t quantity) override;
+  using Print::write;
+  int available() override { return (int)(rxLength - rxIndex); }
+  int read() override { return rxIndex < rxLength ? rxBuffer[rxIndex++] : -1; }
+  int peek() override { return rxIndex < rxLength ? rxBuffer[rxIndex] : -1; }
+  void flush() override {
+    rxIndex = rxLength = 0;
+    txLength = 0;
+  }
+
+ private:
+  uint32_t clock = 100000;
+  uint16_t txAddress = 0;
+  uint8_t txBuffer[I2C_BUFFER_LENGTH];
+  size_t txLength = 0;
+  uint8_t rxBuffer[I2C_BUFFER_LENGTH];
+  size_t rxIndex = 0;
+  size_t rxLength = 0;
+};
+
+extern TwoWire Wire;
@@ -0,0 +1,6 @@
+// The sleep API itself is declared in Arduino.h, as the core pulls it in there too.
+#pragma once
+
+#include <Arduino.h>
+
+esp_err_t esp_sleep_disable_wakeup_source(esp_sleep_wakeup_cause_t source);
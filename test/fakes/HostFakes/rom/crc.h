@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Same contract as the ESP32 ROM: CRC-32/ISO-HDLC with the inversions inside, so
+// crc32_le(0, "123456789", 9) == 0xCBF43926 and calls can be chained.
+uint32_t crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,296 @@
+// The shared Airtable client against a scripted Airtable: requests in a row ride
+// one kept-alive connection, only a closed socket costs a new handshake, bulk
+// updates go out as PATCHes of at most AIRTABLE_BATCH_SIZE records, and a list
+// sync that could not keep every record is never stamped as done.
+#include <HostFakes.h>
+#include <unity.h>
+
+#include "../../main.cpp"
+
+using hostfake::HttpResponse;
+
+void setUp() {
+  hostfake::reset();
+  if (journalMutex == NULL) {
+    journalMutex = xSemaphoreCreateMutex();
+    spiffsMountMutex = xSemaphoreCreateMutex();
+    Wire.begin(PN532_SDA, PN532_SCL);
+    display.begin(SSD1306_SWITCHCAPVCC, OLED_I2C_ADDRESS); // Errors are shown as toasts
+  }
+  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+  TEST_ASSERT_TRUE(hostfake::runUntil([] { return WiFi.status() == WL_CONNECTED; }, 5000));
+}
+
+void tearDown() {
+  airtableClose();
+  WiFi.disconnect(true);
+  equipmentTableFree(equipment);
+}
+
+// A list answer with one record, as Airtable sends it (chunked).
+HttpResponse recordResponse(const char* id, const char* offset = nullptr, bool closeConnection = false) {
+  std::string body = std::string("{\"records\":[{\"id\":\"") + id + "\",\"fields\":{\"Bag Name\":\"Bag " + id + "\"}}]";
+  if (offset != nullptr) {
+    body += std::string(",\"offset\":\"") + offset + "\"";
+  }
+  HttpResponse response{200, body + "}", true, 24};
+  response.closeConnection = closeConnection;
+  return response;
+}
+
+void test_requests_in_a_row_share_one_connection() {
+  hostfake::queueHttpResponse(recordResponse("recAAAAAAAAAAAAAA"));
+  hostfake::queueHttpResponse(recordResponse("recBBBBBBBBBBBBBB"));
+  hostfake::queueHttpResponse(recordResponse("recCCCCCCCCCCCCCC", "page2"));
+  hostfake::queueHttpResponse(recordResponse("recDDDDDDDDDDDDDD"));
+
+  String recordId;
+  TEST_ASSERT_TRUE(getAirtableRecordIdByUID("04A1B2C3D4E5F6", recordId));
+  TEST_ASSERT_EQUAL_STRING("recAAAAAAAAAAAAAA", recordId.c_str());
+  TEST_ASSERT_TRUE(getAirtableRecordIdByUID("DEADBEEF", recordId));
+  TEST_ASSERT_EQUAL_STRING("recBBBBBBBBBBBBBB", recordId.c_str());
+  TEST_ASSERT_TRUE(fetchAvailableBags_Airtable()); // Two pages
+  TEST_ASSERT_EQUAL(2, availableBagCount);
+
+  TEST_ASSERT_EQUAL(4, hostfake::httpRequests().size());
+  TEST_ASSERT_EQUAL_UINT32(1, hostfake::httpConnects());
+  for (const hostfake::HttpRequest& request : hostfake::httpRequests()) {
+    bool authorized = false;
+    for (const auto& header : request.headers) {
+      authorized |= header.first == "Authorization";
+    }
+    TEST_ASSERT_TRUE(authorized); // Headers are set again on the reused client
+  }
+  TEST_ASSERT_TRUE(hostfake::httpRequests()[3].url.find("offset=page2") != std::string::npos);
+}
+
+void test_connection_closed_by_airtable_is_reopened() {
+  hostfake::queueHttpResponse(recordResponse("recAAAAAAAAAAAAAA", nullptr, true));
+  hostfake::queueHttpResponse(recordResponse("recBBBBBBBBBBBBBB"));
+  hostfake::queueHttpResponse(recordResponse("recCCCCCCCCCCCCCC"));
+
+  String recordId;
+  TEST_ASSERT_TRUE(getAirtableRecordIdByUID("04A1B2C3D4E5F6", recordId));
+  TEST_ASSERT_TRUE(getAirtableRecordIdByUID("04A1B2C3D4E5F6", recordId)); // Reconnects
+  TEST_ASSERT_TRUE(getAirtableRecordIdByUID("04A1B2C3D4E5F6", recordId)); // Reuses that one
+  TEST_ASSERT_EQUAL_STRING("recCCCCCCCCCCCCCC", recordId.c_str());
+  TEST_ASSERT_EQUAL_UINT32(2, hostfake::httpConnects());
+}
+
+void test_close_before_wifi_off_drops_the_connection() {
+  hostfake::queueHttpResponse(recordResponse("recAAAAAAAAAAAAAA"));
+  hostfake::queueHttpResponse(recordResponse("recBBBBBBBBBBBBBB"));
+
+  String recordId;
+  TEST_ASSERT_TRUE(getAirtableRecordIdByUID("04A1B2C3D4E5F6", recordId));
+  airtableClose();
+  TEST_ASSERT_FALSE(airtableTlsClient.connected());
+  TEST_ASSERT_TRUE(getAirtableRecordIdByUID("04A1B2C3D4E5F6", recordId));
+  TEST_ASSERT_EQUAL_UINT32(2, hostfake::httpConnects());
+}
+
+void test_error_answer_keeps_the_connection_usable() {
+  hostfake::queueHttpResponse(HttpResponse{422, "{\"error\":{\"type\":\"INVALID_FILTER\"}}", false, 0});
+  hostfake::queueHttpResponse(recordResponse("recBBBBBBBBBBBBBB"));
+
+  String recordId;
+  TEST_ASSERT_FALSE(getAirtableRecordIdByUID("04A1B2C3D4E5F6", recordId));
+  TEST_ASSERT_TRUE(getAirtableRecordIdByUID("04A1B2C3D4E5F6", recordId));
+  TEST_ASSERT_EQUAL_STRING("recBBBBBBBBBBBBBB", recordId.c_str());
+  TEST_ASSERT_EQUAL_UINT32(1, hostfake::httpConnects()); // The error body was read off the socket
+}
+
+// 'count' updates of {"Last Scanned": ...} to recUPDATE00000000 onwards.
+JsonDocument lastScannedUpdates(int count) {
+  JsonDocument updates;
+  JsonArray records = updates.to<JsonArray>();
+  for (int i = 0; i < count; i++) {
+    char id[24];
+    snprintf(id, sizeof(id), "recUPDATE%08d", i);
+    JsonObject record = records.add<JsonObject>();
+    record["id"] = id;
+    record["fields"]["Last Scanned"] = "2026-10-16T12:00:00Z";
+  }
+  return updates;
+}
+
+// Queues the answer to one PATCH: Airtable lists the 'count' records updated,
+// recUPDATE<first> onwards.
+void queuePatchAnswer(int first, int count) {
+  std::string body = "{\"records\":[";
+  for (int i = 0; i < count; i++) {
+    char id[24];
+    snprintf(id, sizeof(id), "recUPDATE%08d", first + i);
+    body += std::string(i > 0 ? "," : "") + "{\"id\":\"" + id + "\",\"fields\":{}}";
+  }
+  hostfake::queueHttpResponse(HttpResponse{200, body + "]}", true, 32});
+}
+
+void test_batch_update_splits_into_patches_of_ten() {
+  const int total = 2 * AIRTABLE_BATCH_SIZE + 3;
+  JsonDocument updates = lastScannedUpdates(total);
+  queuePatchAnswer(0, AIRTABLE_BATCH_SIZE);
+  queuePatchAnswer(AIRTABLE_BATCH_SIZE, AIRTABLE_BATCH_SIZE);
+  queuePatchAnswer(2 * AIRTABLE_BATCH_SIZE, 3);
+
+  TEST_ASSERT_TRUE(airtableBatchUpdate(getAirtableApiUrl(), updates.as<JsonArrayConst>()));
+
+  std::vector<hostfake::HttpRequest>& requests = hostfake::httpRequests();
+  TEST_ASSERT_EQUAL(3, requests.size());
+  int next = 0;
+  for (const hostfake::HttpRequest& request : requests) {
+    TEST_ASSERT_EQUAL_STRING("PATCH", request.method.c_str());
+    TEST_ASSERT_EQUAL_STRING(getAirtableApiUrl().c_str(), request.url.c_str());
+    bool json = false;
+    for (const auto& header : request.headers) {
+      json |= header.first == "Content-Type" && header.second == "application/json";
+    }
+    TEST_ASSERT_TRUE(json);
+
+    JsonDocument sent;
+    TEST_ASSERT_EQUAL(DeserializationError::Ok, deserializeJson(sent, request.body).code());
+    JsonArray records = sent["records"];
+    TEST_ASSERT_LESS_OR_EQUAL(AIRTABLE_BATCH_SIZE, records.size());
+    for (JsonObject record : records) {
+      TEST_ASSERT_EQUAL_STRING(updates[next]["id"].as<const char*>(), record["id"].as<const char*>());
+      TEST_ASSERT_EQUAL_STRING("2026-10-16T12:00:00Z", record["fields"]["Last Scanned"].as<const char*>());
+      next++;
+    }
+  }
+  TEST_ASSERT_EQUAL(total, next); // Every record sent once, in order
+  TEST_ASSERT_EQUAL_UINT32(1, hostfake::httpConnects());
+}
+
+void test_batch_update_stops_at_a_failed_patch() {
+  JsonDocument updates = lastScannedUpdates(3 * AIRTABLE_BATCH_SIZE);
+  queuePatchAnswer(0, AIRTABLE_BATCH_SIZE);
+  hostfake::queueHttpResponse(HttpResponse{422, "{\"error\":{\"type\":\"INVALID_RECORDS\"}}", false, 0});
+  queuePatchAnswer(2 * AIRTABLE_BATCH_SIZE, AIRTABLE_BATCH_SIZE); // Never asked for
+
+  TEST_ASSERT_FALSE(airtableBatchUpdate(getAirtableApiUrl(), updates.as<JsonArrayConst>()));
+  TEST_ASSERT_EQUAL(2, hostfake::httpRequests().size());
+}
+
+void test_batch_update_fails_on_a_partial_answer() {
+  JsonDocument updates = lastScannedUpdates(2 * AIRTABLE_BATCH_SIZE);
+  queuePatchAnswer(0, AIRTABLE_BATCH_SIZE - 1); // One record short
+  queuePatchAnswer(AIRTABLE_BATCH_SIZE, AIRTABLE_BATCH_SIZE);
+
+  TEST_ASSERT_FALSE(airtableBatchUpdate(getAirtableApiUrl(), updates.as<JsonArrayConst>()));
+  TEST_ASSERT_EQUAL(1, hostfake::httpRequests().size());
+}
+
+void test_record_ids_come_from_the_cached_list() {
+  TEST_ASSERT_TRUE(equipmentTableReserve(equipment, 2, 16));
+  TEST_ASSERT_TRUE(equipmentTableAdd(equipment, "04A1B2C3D4E5F6", 14, "Pads", 4, "recPADSPADSPADS01"));
+  TEST_ASSERT_TRUE(equipmentTableAdd(equipment, "DEADBEEF", 8, "Mask", 4, ""));
+  equipmentTableFinalize(equipment);
+  hostfake::queueHttpResponse(recordResponse("recMASKMASKMASK01"));
+
+  String recordId;
+  TEST_ASSERT_TRUE(resolveRecordIdForUid("04A1B2C3D4E5F6", recordId));
+  TEST_ASSERT_EQUAL_STRING("recPADSPADSPADS01", recordId.c_str());
+  TEST_ASSERT_EQUAL(0, hostfake::httpRequests().size()); // No GET for a cached id
+
+  TEST_ASSERT_TRUE(resolveRecordIdForUid("DEADBEEF", recordId)); // Cached without its id
+  TEST_ASSERT_EQUAL_STRING("recMASKMASKMASK01", recordId.c_str());
+  TEST_ASSERT_EQUAL(1, hostfake::httpRequests().size());
+}
+
+void test_bag_list_is_drawn_once() {
+  hostfake::queueHttpResponse(recordResponse("recAAAAAAAAAAAAAA"));
+  TEST_ASSERT_TRUE(fetchAvailableBags_Airtable());
+  currentState = ADMIN_SET_ACTIVE_BAG_SELECT;
+  currentMenuSelection = 0;
+  redrawOled = true;
+  handleAdminSetActiveBagSelectState();
+  TEST_ASSERT_FALSE(redrawOled); // loop() may idle until a button
+  uint32_t writes = hostfake::ssd1306().writes;
+  handleAdminSetActiveBagSelectState();
+  TEST_ASSERT_EQUAL_UINT32(writes, hostfake::ssd1306().writes);
+}
+
+// An equipment list answer with items first..first+count-1 of the active bag.
+HttpResponse equipmentResponse(int first, int count) {
+  std::string body = "{\"records\":[";
+  for (int i = first; i < first + count; i++) {
+    char record[160];
+    snprintf(record, sizeof(record),
+             "%s{\"id\":\"recITEM%010d\",\"fields\":{\"UID\":\"0400000000%04X\",\"Item Name\":\"Item %d\","
+             "\"Assigned Bag\":\"Main Bag\"}}",
+             i > first ? "," : "", i, i, i);
+    body += record;
+  }
+  return HttpResponse{200, body + "]}", true, 512};
+}
+
+std::string syncStamp() {
+  std::string contents;
+  hostfake::readFile(EQUIPMENT_SYNC_FILE, &contents);
+  return contents;
+}
+
+void startSyncTests() {
+  hostfake::setWallClock(1790000000);
+  currentAssignedBagID = "recBAGBAGBAGBAG01";
+  currentAssignedBagName = "Main Bag";
+}
+
+void test_full_fetch_is_stamped_and_delta_merges() {
+  startSyncTests();
+  hostfake::queueHttpResponse(equipmentResponse(0, 3));
+  TEST_ASSERT_TRUE(fetchEquipmentList_Airtable());
+  TEST_ASSERT_EQUAL_UINT16(3, equipment.count);
+  TEST_ASSERT_TRUE(hostfake::fileExists(EQUIPMENT_SYNC_FILE));
+
+  hostfake::setWallClock(1790000600);
+  hostfake::queueHttpResponse(equipmentResponse(3, 1));
+  TEST_ASSERT_TRUE(fetchEquipmentList_Airtable());
+  TEST_ASSERT_TRUE(hostfake::httpRequests()[1].url.find("LAST_MODIFIED_TIME") != std::string::npos);
+  TEST_ASSERT_EQUAL_UINT16(4, equipment.count);
+  TEST_ASSERT_TRUE(syncStamp().find(std::to_string(1790000600 - EQUIPMENT_SYNC_CLOCK_MARGIN_S)) != std::string::npos);
+}
+
+void test_full_fetch_over_the_item_cap_fails_unstamped() {
+  startSyncTests();
+  hostfake::queueHttpResponse(equipmentResponse(0, MAX_EXPECTED_ITEMS + 1));
+  TEST_ASSERT_FALSE(fetchEquipmentList_Airtable());
+  TEST_ASSERT_EQUAL_UINT16(0, equipment.count); // No list cut short
+  TEST_ASSERT_FALSE(hostfake::fileExists(EQUIPMENT_LIST_FILE));
+  TEST_ASSERT_FALSE(hostfake::fileExists(EQUIPMENT_SYNC_FILE));
+}
+
+void test_delta_over_the_item_cap_fails_unstamped() {
+  startSyncTests();
+  hostfake::queueHttpResponse(equipmentResponse(0, MAX_EXPECTED_ITEMS - 1));
+  TEST_ASSERT_TRUE(fetchEquipmentList_Airtable());
+  std::string stampBefore = syncStamp();
+
+  hostfake::setWallClock(1790000600);
+  hostfake::queueHttpResponse(equipmentResponse(MAX_EXPECTED_ITEMS - 1, 2)); // Merged list: cap + 1
+  TEST_ASSERT_FALSE(fetchEquipmentList_Airtable());
+  TEST_ASSERT_EQUAL_UINT16(MAX_EXPECTED_ITEMS - 1, equipment.count); // Kept as it was
+  TEST_ASSERT_EQUAL_STRING(stampBefore.c_str(), syncStamp().c_str());
+
+  hostfake::queueHttpResponse(equipmentResponse(0, MAX_EXPECTED_ITEMS + 1)); // Changed records alone over the cap
+  TEST_ASSERT_FALSE(fetchEquipmentList_Airtable());
+  TEST_ASSERT_EQUAL_UINT16(MAX_EXPECTED_ITEMS - 1, equipment.count);
+  TEST_ASSERT_EQUAL_STRING(stampBefore.c_str(), syncStamp().c_str());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_requests_in_a_row_share_one_connection);
+  RUN_TEST(test_connection_closed_by_airtable_is_reopened);
+  RUN_TEST(test_close_before_wifi_off_drops_the_connection);
+  RUN_TEST(test_error_answer_keeps_the_connection_usable);
+  RUN_TEST(test_batch_update_splits_into_patches_of_ten);
+  RUN_TEST(test_batch_update_stops_at_a_failed_patch);
+  RUN_TEST(test_batch_update_fails_on_a_partial_answer);
+  RUN_TEST(test_record_ids_come_from_the_cached_list);
+  RUN_TEST(test_bag_list_is_drawn_once);
+  RUN_TEST(test_full_fetch_is_stamped_and_delta_merges);
+  RUN_TEST(test_full_fetch_over_the_item_cap_fails_unstamped);
+  RUN_TEST(test_delta_over_the_item_cap_fails_unstamped);
+  return UNITY_END();
+}
@@ -0,0 +1,141 @@
+// Repack benchmark: full sessions of 20, 100 and 500 items on the virtual clock,
+// with the simulated PN532 and the I2C bus charging every transfer at the set
+// clock. The operator is as fast as the firmware: each tag enters the field as
+// soon as the previous one is on the screen. Prints one JSON line per bag size,
+//   {"bench":"repack_scan","items":N,"scans":N,"latency_us":{"p50":N,"p99":N,"max":N},
+//    "items_per_min":F,"i2c_bytes_per_scan":F,"i2c_busy_us_per_scan":F,
+//    "heap_allocations_per_scan":F,"cpu_time_modelled":false}
+// Latency runs from the tag entering the field to the end of the runStateMachine()
+// pass whose OLED push shows it. Host CPU time is not modelled, so latencies and
+// throughput are the bus and PN532 share only; compare them across commits, not
+// against the device.
+#include <HostFakes.h>
+#include <unity.h>
+
+#include <algorithm>
+
+#include "../../main.cpp"
+
+using hostfake::pn532;
+
+std::vector<uint8_t> itemUid(uint16_t i) { return {0x04, 0x00, 0x00, 0x00, 0x00, (uint8_t)(i >> 8), (uint8_t)i}; }
+
+void writeEquipmentCsv(uint16_t items) {
+  std::string csv;
+  for (uint16_t i = 0; i < items; i++) {
+    char line[48];
+    snprintf(line, sizeof(line), "0400000000%04X,recITEM%09u,Item %u\n", i, i, i);
+    csv += line;
+  }
+  hostfake::writeFile(EQUIPMENT_LIST_CSV_FILE, csv);
+}
+
+void setUp() {
+  static bool booted = false;
+  if (booted) {
+    return;
+  }
+  hostfake::reset();
+  pn532().wireIrq(PN532_IRQ);
+  hostfake::writeFile(BAG_CONFIG_FILE, "recBAGBAGBAGBAG01\nMain Bag\n");
+  writeEquipmentCsv(1);
+  setup();
+  booted = true;
+}
+
+void tearDown() {}
+
+bool runLoopUntil(const std::function<bool()>& done, uint32_t timeoutMs) {
+  unsigned long deadline = millis() + timeoutMs;
+  while (!done() && (long)(millis() - deadline) < 0) {
+    loop();
+  }
+  return done();
+}
+
+void pressAndWaitFor(uint8_t pin, SystemState state) {
+  hostfake::scheduleAfter(1000, [pin] { hostfake::setPinLevel(pin, HIGH); });
+  hostfake::scheduleAfter(81000, [pin] { hostfake::setPinLevel(pin, LOW); });
+  TEST_ASSERT_TRUE(runLoopUntil([state] { return currentState == state; }, 2000));
+  runLoopUntil([] { return false; }, 200); // Finger off, past the debounce window
+}
+
+// Swaps in a list of 'items' from the menu, as a sync would leave it.
+void loadBag(uint16_t items) {
+  TEST_ASSERT_TRUE(currentState == IDLE_MENU);
+  equipmentTableFree(equipment);
+  SPIFFS.remove(EQUIPMENT_LIST_FILE);
+  writeEquipmentCsv(items);
+  TEST_ASSERT_TRUE(loadListFromSPIFFS());
+  TEST_ASSERT_EQUAL_UINT16(items, equipment.count);
+}
+
+uint64_t percentile(const std::vector<uint64_t>& sorted, uint8_t percent) {
+  return sorted[(sorted.size() - 1) * percent / 100];
+}
+
+void benchRepackSession(uint16_t items) {
+  loadBag(items);
+  pressAndWaitFor(BUTTON_C_PIN, REPACK_SESSION_START_CONFIRM);
+  pressAndWaitFor(BUTTON_A_PIN, SESSION_ACTIVE);
+  pressAndWaitFor(BUTTON_C_PIN, REPACKING_SCAN);
+  TEST_ASSERT_EQUAL_UINT16(items, equipment.missingCount);
+  TEST_ASSERT_TRUE(runLoopUntil([] { return pn532().detectionArmed(); }, 500));
+  runLoopUntil([] { return false; }, 500); // Let the screen settle
+
+  std::vector<uint64_t> latencies;
+  uint64_t i2cBytes = 0;
+  uint64_t i2cBusyUs = 0;
+  uint64_t allocations = 0;
+  uint64_t sessionStartedAt = hostfake::nowMicros();
+  for (uint16_t i = 0; i < items; i++) {
+    uint16_t foundBefore = equipment.foundCount;
+    hostfake::I2cStats busBefore = hostfake::i2cStats();
+    uint64_t allocationsBefore = hostfake::heapStats().allocations;
+    uint64_t placedAt = hostfake::nowMicros();
+    pn532().placeTag(itemUid(i));
+    unsigned long deadline = millis() + 1000;
+    while (equipment.foundCount == foundBefore && (long)(millis() - deadline) < 0) {
+      runStateMachine();
+      if (equipment.foundCount == foundBefore) {
+        uiIdleWait();
+      }
+    }
+    TEST_ASSERT_EQUAL_UINT16(foundBefore + 1, equipment.foundCount);
+    latencies.push_back(hostfake::nowMicros() - placedAt);
+    i2cBytes += hostfake::i2cStats().bytes - busBefore.bytes;
+    i2cBusyUs += hostfake::i2cStats().busyUs - busBefore.busyUs;
+    allocations += hostfake::heapStats().allocations - allocationsBefore;
+    pn532().removeTag(itemUid(i));
+  }
+  uint64_t sessionUs = hostfake::nowMicros() - sessionStartedAt;
+  TEST_ASSERT_EQUAL_UINT16(0, equipment.missingCount);
+  TEST_ASSERT_TRUE(runLoopUntil([] { return currentState == REPACK_SESSION_COMPLETE; }, 1000));
+  TEST_ASSERT_TRUE(runLoopUntil([] { return currentState == IDLE_MENU; }, WELL_DONE_TIMEOUT_MS + 1000));
+  runLoopUntil([] { return false; }, 200);
+
+  std::sort(latencies.begin(), latencies.end());
+  printf("{\"bench\":\"repack_scan\",\"items\":%u,\"scans\":%u,"
+         "\"latency_us\":{\"p50\":%llu,\"p99\":%llu,\"max\":%llu},\"items_per_min\":%.1f,"
+         "\"i2c_bytes_per_scan\":%.1f,\"i2c_busy_us_per_scan\":%.1f,\"heap_allocations_per_scan\":%.2f,"
+         "\"cpu_time_modelled\":false}\n",
+         items, (unsigned)latencies.size(), (unsigned long long)percentile(latencies, 50),
+         (unsigned long long)percentile(latencies, 99), (unsigned long long)latencies.back(),
+         items * 60e6 / sessionUs, (double)i2cBytes / items, (double)i2cBusyUs / items,
+         (double)allocations / items);
+  fflush(stdout);
+}
+
+void test_bench_20_items() { benchRepackSession(20); }
+
+void test_bench_100_items() { benchRepackSession(100); }
+
+void test_bench_500_items() { benchRepackSession(500); }
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_bench_20_items);
+  RUN_TEST(test_bench_100_items);
+  RUN_TEST(test_bench_500_items);
+  return UNITY_END();
+}
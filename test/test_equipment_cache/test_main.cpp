@@ -0,0 +1,158 @@
+// The binary equipment list cache on SPIFFS: round trip, CRC and format checks,
+// and the one-time migration of the CSV cache older firmware wrote.
+#include <HostFakes.h>
+#include <unity.h>
+
+#include "../../main.cpp"
+
+void setUp() {
+  hostfake::reset();
+  if (spiffsMountMutex == NULL) {
+    spiffsMountMutex = xSemaphoreCreateMutex();
+  }
+  equipmentTableFree(equipment);
+  equipmentCacheCurrent = false;
+}
+
+void tearDown() { equipmentTableFree(equipment); }
+
+// Fills the table with 'count' items: UID 04 00 00 00 00 hi lo, "Item <n>", every
+// other one with a record id.
+void fillEquipment(uint16_t count) {
+  TEST_ASSERT_TRUE(equipmentTableReserve(equipment, count, count * 12));
+  for (uint16_t i = 0; i < count; i++) {
+    char uidHex[20];
+    char name[12];
+    char recordId[AIRTABLE_RECORD_ID_LENGTH + 1];
+    snprintf(uidHex, sizeof(uidHex), "0400000000%04X", (unsigned)(count - 1 - i)); // Reverse order, so the index sorts
+    snprintf(name, sizeof(name), "Item %u", (unsigned)i);
+    snprintf(recordId, sizeof(recordId), "rec%014u", (unsigned)i);
+    TEST_ASSERT_TRUE(equipmentTableAdd(equipment, uidHex, 14, name, strlen(name), (i % 2 == 0) ? recordId : nullptr));
+  }
+  equipmentTableFinalize(equipment);
+}
+
+int findHex(const char* uidHex) {
+  UidKey key;
+  TEST_ASSERT_TRUE(uidKeyFromHex(uidHex, strlen(uidHex), key));
+  return findItemIndexByUid(key.bytes, key.length);
+}
+
+void test_round_trip_keeps_every_section() {
+  fillEquipment(40);
+  TEST_ASSERT_TRUE(saveListToSPIFFS());
+  TEST_ASSERT_TRUE(equipmentCacheCurrent);
+  TEST_ASSERT_FALSE(hostfake::fileExists(EQUIPMENT_LIST_TEMP_FILE));
+  equipmentTableFree(equipment);
+
+  TEST_ASSERT_TRUE(loadListFromSPIFFS());
+  TEST_ASSERT_EQUAL_UINT16(40, equipment.count);
+  TEST_ASSERT_EQUAL_STRING("Item 0", equipmentName(0));
+  TEST_ASSERT_EQUAL_STRING("Item 39", equipmentName(39));
+  TEST_ASSERT_EQUAL_STRING("rec00000000000002", equipment.recordIds[2].id);
+  TEST_ASSERT_EQUAL_STRING("", equipment.recordIds[3].id);
+  TEST_ASSERT_EQUAL_INT(39, findHex("04000000000000")); // Cached index, no rebuild
+  TEST_ASSERT_EQUAL_INT(0, findHex("04000000000027"));
+  TEST_ASSERT_EQUAL_INT(-1, findHex("04000000000028"));
+}
+
+void test_empty_list_round_trips() {
+  TEST_ASSERT_TRUE(saveListToSPIFFS());
+  TEST_ASSERT_TRUE(loadListFromSPIFFS());
+  TEST_ASSERT_EQUAL_UINT16(0, equipment.count);
+}
+
+void test_corrupt_byte_fails_the_crc() {
+  fillEquipment(10);
+  TEST_ASSERT_TRUE(saveListToSPIFFS());
+  std::string image;
+  TEST_ASSERT_TRUE(hostfake::readFile(EQUIPMENT_LIST_FILE, &image));
+  image[image.size() - 3] ^= 0x01; // Inside a name
+  hostfake::writeFile(EQUIPMENT_LIST_FILE, image);
+  hostfake::writeFile(EQUIPMENT_SYNC_FILE, "1700000000");
+
+  TEST_ASSERT_FALSE(loadListFromSPIFFS());
+  TEST_ASSERT_EQUAL_UINT16(0, equipment.count);
+  TEST_ASSERT_NULL(equipment.uids);
+  TEST_ASSERT_FALSE(hostfake::fileExists(EQUIPMENT_SYNC_FILE)); // A full fetch follows
+}
+
+void test_truncated_image_is_ignored() {
+  fillEquipment(10);
+  TEST_ASSERT_TRUE(saveListToSPIFFS());
+  std::string image;
+  TEST_ASSERT_TRUE(hostfake::readFile(EQUIPMENT_LIST_FILE, &image));
+  hostfake::writeFile(EQUIPMENT_LIST_FILE, image.substr(0, image.size() - 20));
+  TEST_ASSERT_FALSE(loadListFromSPIFFS());
+  TEST_ASSERT_EQUAL_UINT16(0, equipment.count);
+}
+
+void test_other_version_is_ignored() {
+  fillEquipment(3);
+  TEST_ASSERT_TRUE(saveListToSPIFFS());
+  std::string image;
+  TEST_ASSERT_TRUE(hostfake::readFile(EQUIPMENT_LIST_FILE, &image));
+  image[offsetof(EquipmentCacheHeader, version)] = EQUIPMENT_CACHE_VERSION + 1;
+  hostfake::writeFile(EQUIPMENT_LIST_FILE, image);
+  TEST_ASSERT_FALSE(loadListFromSPIFFS());
+}
+
+void test_full_flash_keeps_the_previous_cache() {
+  fillEquipment(5);
+  TEST_ASSERT_TRUE(saveListToSPIFFS());
+  std::string before;
+  TEST_ASSERT_TRUE(hostfake::readFile(EQUIPMENT_LIST_FILE, &before));
+
+  fillEquipment(200);
+  hostfake::setFlashCapacity(before.size() + 100); // The temp file cannot be written whole
+  TEST_ASSERT_FALSE(saveListToSPIFFS());
+  TEST_ASSERT_FALSE(equipmentCacheCurrent);
+  TEST_ASSERT_FALSE(hostfake::fileExists(EQUIPMENT_LIST_TEMP_FILE));
+  std::string after;
+  TEST_ASSERT_TRUE(hostfake::readFile(EQUIPMENT_LIST_FILE, &after));
+  TEST_ASSERT_TRUE(before == after);
+}
+
+void test_csv_cache_is_migrated_once() {
+  hostfake::writeFile(EQUIPMENT_LIST_CSV_FILE,
+                      "04A1B2C3D4E5F6,recAAAAAAAAAAAAAA,Blocker\n"
+                      "DEADBEEF,,Catch Glove\n"
+                      "0411223344,Leg Pads, Left\n"
+                      "not a line\n"
+                      "\n"
+                      "0455,Stick");
+  TEST_ASSERT_TRUE(loadListFromSPIFFS());
+  TEST_ASSERT_EQUAL_UINT16(4, equipment.count);
+  TEST_ASSERT_EQUAL_STRING("Blocker", equipmentName(0));
+  TEST_ASSERT_EQUAL_STRING("recAAAAAAAAAAAAAA", equipment.recordIds[0].id);
+  TEST_ASSERT_EQUAL_STRING("Catch Glove", equipmentName(1));
+  TEST_ASSERT_EQUAL_STRING("", equipment.recordIds[1].id);
+  TEST_ASSERT_EQUAL_STRING("Leg Pads, Left", equipmentName(2)); // Old two-column form, comma in the name
+  TEST_ASSERT_EQUAL_INT(3, findHex("0455"));
+  TEST_ASSERT_FALSE(hostfake::fileExists(EQUIPMENT_LIST_CSV_FILE));
+  TEST_ASSERT_TRUE(hostfake::fileExists(EQUIPMENT_LIST_FILE));
+
+  equipmentTableFree(equipment);
+  TEST_ASSERT_TRUE(loadListFromSPIFFS()); // Now from the binary image
+  TEST_ASSERT_EQUAL_UINT16(4, equipment.count);
+  TEST_ASSERT_EQUAL_INT(1, findHex("DEADBEEF"));
+}
+
+void test_missing_cache_clears_the_list() {
+  fillEquipment(3);
+  TEST_ASSERT_FALSE(loadListFromSPIFFS());
+  TEST_ASSERT_EQUAL_UINT16(0, equipment.count);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_round_trip_keeps_every_section);
+  RUN_TEST(test_empty_list_round_trips);
+  RUN_TEST(test_corrupt_byte_fails_the_crc);
+  RUN_TEST(test_truncated_image_is_ignored);
+  RUN_TEST(test_other_version_is_ignored);
+  RUN_TEST(test_full_flash_keeps_the_previous_cache);
+  RUN_TEST(test_csv_cache_is_migrated_once);
+  RUN_TEST(test_missing_cache_clears_the_list);
+  return UNITY_END();
+}
@@ -0,0 +1,149 @@
+// HttpBodyStream: chunked transfer decoding and Content-Length framing, so the
+// JSON parser only ever sees body bytes and a kept-alive socket stays aligned.
+#include <HostFakes.h>
+#include <unity.h>
+
+#include "../../main.cpp"
+
+using hostfake::MemoryStream;
+
+void setUp() { hostfake::reset(); }
+
+void tearDown() {}
+
+std::string readAll(Stream& stream) {
+  std::string out;
+  for (int c = stream.read(); c >= 0; c = stream.read()) {
+    out += (char)c;
+  }
+  return out;
+}
+
+void test_chunked_body_is_reassembled() {
+  MemoryStream socket(hostfake::chunkedEncode("{\"records\":[{\"id\":\"rec1\"}]}", 5));
+  HttpBodyStream body(socket, true, -1);
+  TEST_ASSERT_EQUAL_STRING("{\"records\":[{\"id\":\"rec1\"}]}", readAll(body).c_str());
+  TEST_ASSERT_EQUAL_size_t(0, socket.remaining());
+}
+
+void test_chunk_extensions_and_uppercase_hex_sizes() {
+  MemoryStream socket("A;name=value\r\n0123456789\r\n1f\r\nabcdefghijklmnopqrstuvwxyz01234\r\n0\r\n\r\n");
+  HttpBodyStream body(socket, true, -1);
+  TEST_ASSERT_EQUAL_STRING("0123456789abcdefghijklmnopqrstuvwxyz01234", readAll(body).c_str());
+  TEST_ASSERT_EQUAL_size_t(0, socket.remaining());
+}
+
+void test_trailer_lines_are_consumed() {
+  MemoryStream socket("3\r\nabc\r\n0\r\nX-Checksum: 1234\r\nX-Other: 5\r\n\r\nHTTP/1.1 200 OK");
+  HttpBodyStream body(socket, true, -1);
+  TEST_ASSERT_EQUAL_STRING("abc", readAll(body).c_str());
+  TEST_ASSERT_EQUAL_size_t(strlen("HTTP/1.1 200 OK"), socket.remaining());
+}
+
+void test_content_length_stops_at_the_next_response() {
+  MemoryStream socket("{\"a\":1}HTTP/1.1 200 OK");
+  HttpBodyStream body(socket, false, 7);
+  TEST_ASSERT_EQUAL_STRING("{\"a\":1}", readAll(body).c_str());
+  TEST_ASSERT_EQUAL_size_t(strlen("HTTP/1.1 200 OK"), socket.remaining());
+}
+
+void test_unknown_length_reads_until_close() {
+  MemoryStream socket("until the server closes");
+  HttpBodyStream body(socket, false, -1);
+  TEST_ASSERT_EQUAL_STRING("until the server closes", readAll(body).c_str());
+}
+
+void test_peek_does_not_consume() {
+  MemoryStream socket(hostfake::chunkedEncode("xy", 1));
+  HttpBodyStream body(socket, true, -1);
+  TEST_ASSERT_EQUAL_INT('x', body.peek());
+  TEST_ASSERT_EQUAL_INT('x', body.peek());
+  TEST_ASSERT_EQUAL_INT(1, body.available());
+  TEST_ASSERT_EQUAL_INT('x', body.read());
+  TEST_ASSERT_EQUAL_INT('y', body.read());
+  TEST_ASSERT_EQUAL_INT(-1, body.peek());
+  TEST_ASSERT_EQUAL_INT(0, body.available());
+}
+
+void test_drain_leaves_the_socket_at_the_next_response() {
+  MemoryStream socket(hostfake::chunkedEncode("{\"records\":[],\"offset\":\"itr1\"}", 8) + "HTTP/1.1 200 OK");
+  HttpBodyStream body(socket, true, -1);
+  TEST_ASSERT_EQUAL_INT('{', body.read());
+  body.drain();
+  TEST_ASSERT_EQUAL_size_t(strlen("HTTP/1.1 200 OK"), socket.remaining());
+}
+
+void test_bad_chunk_size_ends_the_body() {
+  MemoryStream socket("3\r\nabc\r\nzz\r\nmore");
+  HttpBodyStream body(socket, true, -1);
+  TEST_ASSERT_EQUAL_STRING("abc", readAll(body).c_str());
+  TEST_ASSERT_EQUAL_INT(-1, body.read());
+}
+
+void test_connection_closed_mid_chunk() {
+  MemoryStream socket("10\r\nshort");
+  HttpBodyStream body(socket, true, -1);
+  TEST_ASSERT_EQUAL_STRING("short", readAll(body).c_str());
+}
+
+void test_json_parses_straight_from_a_chunked_body() {
+  // Chunk boundaries land inside keys and values
+  MemoryStream socket(hostfake::chunkedEncode("{\"records\":[{\"id\":\"recAAAAAAAAAAAAAA\",\"fields\":{\"Name\":\"Stove\"}}]}", 3));
+  HttpBodyStream body(socket, true, -1);
+  JsonDocument doc;
+  TEST_ASSERT_TRUE(deserializeJson(doc, body) == DeserializationError::Ok);
+  TEST_ASSERT_EQUAL_STRING("Stove", doc["records"][0]["fields"]["Name"].as<const char*>());
+}
+
+void test_records_and_offset_are_walked_one_by_one() {
+  MemoryStream socket(hostfake::chunkedEncode(
+      "{\"records\":[{\"id\":\"rec1\",\"fields\":{\"Name\":\"Stove\",\"Notes\":\"ignored\"}},"
+      "{\"id\":\"rec2\",\"fields\":{\"Name\":\"Tent\"}}],\"offset\":\"itrNext/rec2\"}", 16));
+  HttpBodyStream body(socket, true, -1);
+  JsonDocument filter;
+  filter["fields"]["Name"] = true;
+  String names;
+  String offset;
+  AirtableFetchResult walked = airtableForEachRecord(body, filter, [](JsonObject record, void* context) {
+    String& out = *(String*)context;
+    out += record["fields"]["Name"].as<const char*>();
+    out += record["fields"]["Notes"].isNull() ? ";" : "+notes;";
+    return AIRTABLE_RECORD_NEXT;
+  }, &names, &offset);
+  TEST_ASSERT_EQUAL(AIRTABLE_FETCH_OK, walked);
+  TEST_ASSERT_EQUAL_STRING("Stove;Tent;", names.c_str());
+  TEST_ASSERT_EQUAL_STRING("itrNext/rec2", offset.c_str());
+}
+
+void test_aborting_handler_fails_the_walk() {
+  MemoryStream socket("{\"records\":[{\"id\":\"rec1\"},{\"id\":\"rec2\"}],\"offset\":\"itrNext/rec2\"}");
+  HttpBodyStream body(socket, false, -1);
+  JsonDocument filter;
+  filter["id"] = true;
+  int seen = 0;
+  String offset;
+  AirtableFetchResult walked = airtableForEachRecord(body, filter, [](JsonObject record, void* context) {
+    (*(int*)context)++;
+    return AIRTABLE_RECORD_ABORT;
+  }, &seen, &offset);
+  TEST_ASSERT_EQUAL(AIRTABLE_FETCH_ABORTED, walked);
+  TEST_ASSERT_EQUAL(1, seen);
+  TEST_ASSERT_TRUE(offset.isEmpty()); // No next page to follow
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_chunked_body_is_reassembled);
+  RUN_TEST(test_chunk_extensions_and_uppercase_hex_sizes);
+  RUN_TEST(test_trailer_lines_are_consumed);
+  RUN_TEST(test_content_length_stops_at_the_next_response);
+  RUN_TEST(test_unknown_length_reads_until_close);
+  RUN_TEST(test_peek_does_not_consume);
+  RUN_TEST(test_drain_leaves_the_socket_at_the_next_response);
+  RUN_TEST(test_bad_chunk_size_ends_the_body);
+  RUN_TEST(test_connection_closed_mid_chunk);
+  RUN_TEST(test_json_parses_straight_from_a_chunked_body);
+  RUN_TEST(test_records_and_offset_are_walked_one_by_one);
+  RUN_TEST(test_aborting_handler_fails_the_walk);
+  return UNITY_END();
+}
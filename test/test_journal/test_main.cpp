@@ -0,0 +1,329 @@
+// The offline Airtable journal: appends, batching, torn lines, compaction with
+// its power-loss recovery, and flushing against scripted Airtable responses.
+#include <HostFakes.h>
+#include <unity.h>
+
+#include "../../main.cpp"
+
+using hostfake::HttpResponse;
+
+void setUp() {
+  hostfake::reset();
+  if (journalMutex == NULL) {
+    journalMutex = xSemaphoreCreateMutex();
+    spiffsMountMutex = xSemaphoreCreateMutex();
+    Wire.begin(PN532_SDA, PN532_SCL);
+    display.begin(SSD1306_SWITCHCAPVCC, OLED_I2C_ADDRESS); // Journal errors are shown as toasts
+  }
+  equipmentTableFree(equipment);
+  currentAssignedBagName = "Main Bag";
+}
+
+void tearDown() {
+  airtableClose();
+  WiFi.disconnect(true);
+  equipmentTableFree(equipment);
+}
+
+std::string journal() {
+  std::string contents;
+  hostfake::readFile(AIRTABLE_JOURNAL_FILE, &contents);
+  return contents;
+}
+
+void appendSeen(const char* uidHex) {
+  JsonDocument entry;
+  entry["op"] = "seen";
+  entry["uid"] = uidHex;
+  TEST_ASSERT_TRUE(journalAppend(entry));
+}
+
+void connect() {
+  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+  TEST_ASSERT_TRUE(hostfake::runUntil([] { return WiFi.status() == WL_CONNECTED; }, 5000));
+}
+
+// An Airtable PATCH answer listing 'count' updated records.
+HttpResponse patchResponse(int count) {
+  std::string body = "{\"records\":[";
+  for (int i = 0; i < count; i++) {
+    body += std::string(i > 0 ? "," : "") + "{\"id\":\"rec" + std::to_string(10000000000000LL + i) + "\",\"fields\":{}}";
+  }
+  return HttpResponse{200, body + "]}", true, 32};
+}
+
+void loadEquipment(std::initializer_list<std::pair<const char*, const char*>> items) {
+  TEST_ASSERT_TRUE(equipmentTableReserve(equipment, items.size(), 64));
+  for (const auto& item : items) {
+    TEST_ASSERT_TRUE(equipmentTableAdd(equipment, item.first, strlen(item.first), "x", 1, item.second));
+  }
+  equipmentTableFinalize(equipment);
+}
+
+void test_append_stamps_key_and_time() {
+  hostfake::setWallClock(1700000000);
+  appendSeen("04A1B2C3D4E5F6");
+  hostfake::setWallClock(0);
+  appendSeen("DEADBEEF");
+
+  JsonDocument batch;
+  size_t bytes = 0;
+  TEST_ASSERT_TRUE(journalReadBatch(batch, bytes));
+  TEST_ASSERT_EQUAL_size_t(journal().size(), bytes);
+  TEST_ASSERT_EQUAL(2, batch.size());
+  TEST_ASSERT_EQUAL_STRING("04A1B2C3D4E5F6", batch[0]["uid"].as<const char*>());
+  TEST_ASSERT_EQUAL(1700000000, batch[0]["at"].as<long long>());
+  TEST_ASSERT_EQUAL(0, batch[1]["at"].as<long long>()); // Stamped at flush time instead
+  TEST_ASSERT_EQUAL(16, strlen(batch[0]["k"].as<const char*>()));
+  TEST_ASSERT_TRUE(strcmp(batch[0]["k"], batch[1]["k"]) != 0);
+}
+
+void test_batches_split_by_table_and_size() {
+  for (int i = 0; i < AIRTABLE_BATCH_SIZE + 2; i++) {
+    appendSeen("DEADBEEF");
+  }
+  journalSessionOutcome(3, 2, 1);
+  appendSeen("DEADBEEF");
+
+  JsonDocument batch;
+  size_t bytes = 0;
+  size_t sizes[4];
+  for (int i = 0; i < 4; i++) {
+    TEST_ASSERT_TRUE(journalReadBatch(batch, bytes));
+    sizes[i] = batch.size();
+    if (i == 2) {
+      TEST_ASSERT_EQUAL_STRING("session", batch[0]["op"].as<const char*>());
+      TEST_ASSERT_EQUAL_STRING("Main Bag", batch[0]["bag"].as<const char*>());
+      TEST_ASSERT_EQUAL(1, batch[0]["missing"].as<int>());
+    }
+    journalDropPrefix(bytes);
+  }
+  TEST_ASSERT_EQUAL(AIRTABLE_BATCH_SIZE, sizes[0]);
+  TEST_ASSERT_EQUAL(2, sizes[1]);
+  TEST_ASSERT_EQUAL(1, sizes[2]);
+  TEST_ASSERT_EQUAL(1, sizes[3]);
+  TEST_ASSERT_FALSE(journalReadBatch(batch, bytes));
+  TEST_ASSERT_FALSE(hostfake::fileExists(AIRTABLE_JOURNAL_FILE));
+}
+
+void test_torn_lines_are_skipped_but_covered() {
+  appendSeen("DEADBEEF");
+  hostfake::writeFile(AIRTABLE_JOURNAL_FILE, journal() + "{\"k\":\"0011\",\"op\":\"se\n" + "{\"no\":\"op\"}\n");
+  appendSeen("CAFEF00D");
+
+  JsonDocument batch;
+  size_t bytes = 0;
+  TEST_ASSERT_TRUE(journalReadBatch(batch, bytes));
+  TEST_ASSERT_EQUAL(2, batch.size());
+  TEST_ASSERT_EQUAL_STRING("CAFEF00D", batch[1]["uid"].as<const char*>());
+  TEST_ASSERT_EQUAL_size_t(journal().size(), bytes);
+}
+
+void test_only_torn_lines_still_form_a_batch() {
+  hostfake::writeFile(AIRTABLE_JOURNAL_FILE, "garbage\n");
+  JsonDocument batch;
+  size_t bytes = 0;
+  TEST_ASSERT_TRUE(journalReadBatch(batch, bytes)); // So a flush drops them
+  TEST_ASSERT_EQUAL(0, batch.size());
+  TEST_ASSERT_EQUAL_size_t(8, bytes);
+}
+
+void test_drop_prefix_keeps_the_rest() {
+  appendSeen("DEADBEEF");
+  size_t first = journal().size();
+  appendSeen("CAFEF00D");
+  std::string rest = journal().substr(first);
+
+  journalDropPrefix(first);
+  TEST_ASSERT_EQUAL_STRING(rest.c_str(), journal().c_str());
+  TEST_ASSERT_FALSE(hostfake::fileExists(AIRTABLE_JOURNAL_TEMP_FILE));
+  TEST_ASSERT_FALSE(hostfake::fileExists(AIRTABLE_JOURNAL_OLD_FILE));
+}
+
+void test_recover_after_power_loss_before_the_swap() {
+  // Cut after the journal was moved aside, before the compacted copy took its place
+  hostfake::writeFile(AIRTABLE_JOURNAL_OLD_FILE, "{\"op\":\"seen\",\"uid\":\"AA\"}\n{\"op\":\"seen\",\"uid\":\"BB\"}\n");
+  hostfake::writeFile(AIRTABLE_JOURNAL_TEMP_FILE, "{\"op\":\"seen\",\"uid\":\"BB\"}\n");
+  appendSeen("CAFEF00D");
+  JsonDocument batch;
+  size_t bytes = 0;
+  TEST_ASSERT_TRUE(journalReadBatch(batch, bytes));
+  TEST_ASSERT_EQUAL(2, batch.size());
+  TEST_ASSERT_EQUAL_STRING("BB", batch[0]["uid"].as<const char*>());
+  TEST_ASSERT_FALSE(hostfake::fileExists(AIRTABLE_JOURNAL_OLD_FILE));
+  TEST_ASSERT_FALSE(hostfake::fileExists(AIRTABLE_JOURNAL_TEMP_FILE));
+}
+
+void test_recover_without_the_compacted_copy() {
+  hostfake::writeFile(AIRTABLE_JOURNAL_OLD_FILE, "{\"op\":\"seen\",\"uid\":\"AA\"}\n");
+  JsonDocument batch;
+  size_t bytes = 0;
+  TEST_ASSERT_TRUE(journalReadBatch(batch, bytes)); // The batch is replayed, harmless
+  TEST_ASSERT_EQUAL_STRING("AA", batch[0]["uid"].as<const char*>());
+}
+
+void test_full_journal_refuses_entries() {
+  hostfake::writeFile(AIRTABLE_JOURNAL_FILE, std::string(AIRTABLE_JOURNAL_MAX_BYTES, '\n'));
+  JsonDocument entry;
+  entry["op"] = "seen";
+  entry["uid"] = "DEADBEEF";
+  TEST_ASSERT_FALSE(journalAppend(entry));
+  TEST_ASSERT_EQUAL_size_t(AIRTABLE_JOURNAL_MAX_BYTES, journal().size());
+}
+
+void test_flush_merges_entries_per_record() {
+  loadEquipment({{"DEADBEEF", "recAAAAAAAAAAAAAA"}, {"CAFEF00D", "recBBBBBBBBBBBBBB"}});
+  hostfake::setWallClock(1700000000);
+  appendSeen("DEADBEEF");
+  journalReplaceTag("CAFEF00D", "0102030405", "New Pads");
+  appendSeen("DEADBEEF");
+  connect();
+  hostfake::queueHttpResponse(patchResponse(2));
+
+  int dropped = -1;
+  TEST_ASSERT_TRUE(journalFlush(&dropped));
+  TEST_ASSERT_EQUAL(0, dropped);
+  TEST_ASSERT_FALSE(hostfake::fileExists(AIRTABLE_JOURNAL_FILE));
+  TEST_ASSERT_EQUAL(1, hostfake::httpRequests().size()); // Record ids came from the list
+  const hostfake::HttpRequest& patch = hostfake::httpRequests()[0];
+  TEST_ASSERT_EQUAL_STRING("PATCH", patch.method.c_str());
+  JsonDocument sent;
+  TEST_ASSERT_TRUE(deserializeJson(sent, patch.body) == DeserializationError::Ok);
+  TEST_ASSERT_EQUAL(2, sent["records"].size());
+  TEST_ASSERT_EQUAL_STRING("recAAAAAAAAAAAAAA", sent["records"][0]["id"].as<const char*>());
+  TEST_ASSERT_EQUAL_STRING("2023-11-14T22:13:20Z", sent["records"][0]["fields"]["Last Scanned"].as<const char*>());
+  TEST_ASSERT_EQUAL_STRING("0102030405", sent["records"][1]["fields"]["UID"].as<const char*>());
+  TEST_ASSERT_EQUAL_STRING("New Pads", sent["records"][1]["fields"]["Item Name"].as<const char*>());
+}
+
+void test_failed_batch_stays_queued() {
+  loadEquipment({{"DEADBEEF", "recAAAAAAAAAAAAAA"}});
+  appendSeen("DEADBEEF");
+  std::string before = journal();
+  connect();
+  hostfake::queueHttpResponse(HttpResponse{422, "{\"error\":\"INVALID\"}", false, 0});
+
+  TEST_ASSERT_FALSE(journalFlush());
+  TEST_ASSERT_EQUAL_STRING(before.c_str(), journal().c_str());
+}
+
+void test_flush_without_wifi_sends_nothing() {
+  appendSeen("DEADBEEF");
+  TEST_ASSERT_FALSE(journalFlush());
+  TEST_ASSERT_EQUAL(0, hostfake::httpRequests().size());
+}
+
+void test_unknown_uid_is_looked_up_then_dropped() {
+  journalReplaceTag("0A0B0C0D", "01020304", "Stick");
+  connect();
+  hostfake::queueHttpResponse(HttpResponse{200, "{\"records\":[]}", true, 8}); // Old UID
+  hostfake::queueHttpResponse(HttpResponse{200, "{\"records\":[]}", false, 0}); // New UID
+
+  int dropped = 0;
+  TEST_ASSERT_TRUE(journalFlush(&dropped));
+  TEST_ASSERT_EQUAL(1, dropped);
+  TEST_ASSERT_EQUAL(2, hostfake::httpRequests().size());
+  TEST_ASSERT_TRUE(hostfake::httpRequests()[0].url.find("0A0B0C0D") != std::string::npos);
+  TEST_ASSERT_FALSE(hostfake::fileExists(AIRTABLE_JOURNAL_FILE));
+}
+
+void test_sessions_are_upserted_on_their_key() {
+  journalSessionOutcome(5, 4, 1);
+  connect();
+  hostfake::queueHttpResponse(patchResponse(1));
+
+  TEST_ASSERT_TRUE(journalFlush());
+  const hostfake::HttpRequest& patch = hostfake::httpRequests()[0];
+  TEST_ASSERT_TRUE(patch.url.find("Repack%20Sessions") != std::string::npos);
+  JsonDocument sent;
+  TEST_ASSERT_TRUE(deserializeJson(sent, patch.body) == DeserializationError::Ok);
+  TEST_ASSERT_EQUAL_STRING("Session Key", sent["performUpsert"]["fieldsToMergeOn"][0].as<const char*>());
+  TEST_ASSERT_EQUAL(16, strlen(sent["records"][0]["fields"]["Session Key"].as<const char*>()));
+  TEST_ASSERT_EQUAL(4, sent["records"][0]["fields"]["Items Returned"].as<int>());
+}
+
+// A bag of 'count' items, all scanned back in the session just completed.
+void loadFoundBag(uint16_t count) {
+  TEST_ASSERT_TRUE(equipmentTableReserve(equipment, count, count * 12));
+  for (uint16_t i = 0; i < count; i++) {
+    char uidHex[16];
+    char recordId[24];
+    char name[12];
+    snprintf(uidHex, sizeof(uidHex), "0400000000%04X", i);
+    snprintf(recordId, sizeof(recordId), "recITEM%010u", i);
+    snprintf(name, sizeof(name), "Item %u", i);
+    TEST_ASSERT_TRUE(equipmentTableAdd(equipment, uidHex, strlen(uidHex), name, strlen(name), recordId));
+  }
+  equipmentTableFinalize(equipment);
+  bitsetSetAll(equipment.foundInRepack, count);
+  equipment.foundCount = count;
+}
+
+void test_session_seen_is_one_entry_per_batch() {
+  loadFoundBag(2 * AIRTABLE_BATCH_SIZE + 5);
+  journalSessionSeen();
+
+  JsonDocument batch;
+  size_t bytes = 0;
+  size_t uids[3];
+  for (int i = 0; i < 3; i++) {
+    TEST_ASSERT_TRUE(journalReadBatch(batch, bytes));
+    TEST_ASSERT_EQUAL(1, batch.size()); // A full entry is a batch of its own
+    TEST_ASSERT_EQUAL_STRING("seen", batch[0]["op"].as<const char*>());
+    uids[i] = batch[0]["uids"].size();
+    journalDropPrefix(bytes);
+  }
+  TEST_ASSERT_EQUAL(AIRTABLE_BATCH_SIZE, uids[0]);
+  TEST_ASSERT_EQUAL(AIRTABLE_BATCH_SIZE, uids[1]);
+  TEST_ASSERT_EQUAL(5, uids[2]);
+  TEST_ASSERT_FALSE(journalReadBatch(batch, bytes));
+}
+
+void test_full_bag_session_leaves_room_for_more() {
+  hostfake::setWallClock(1790000000);
+  loadFoundBag(MAX_EXPECTED_ITEMS);
+  journalSessionSeen();
+  journalSessionOutcome(MAX_EXPECTED_ITEMS, MAX_EXPECTED_ITEMS, 0);
+  TEST_ASSERT_LESS_THAN(AIRTABLE_JOURNAL_MAX_BYTES / 2, journal().size()); // Two full sessions fit
+  TEST_ASSERT_TRUE(journal().find("\"op\":\"session\"") != std::string::npos);
+}
+
+void test_flush_sends_seen_entries_as_patches() {
+  loadFoundBag(2 * AIRTABLE_BATCH_SIZE + 5);
+  hostfake::setWallClock(1700000000);
+  journalSessionSeen();
+  connect();
+  hostfake::queueHttpResponse(patchResponse(AIRTABLE_BATCH_SIZE));
+  hostfake::queueHttpResponse(patchResponse(AIRTABLE_BATCH_SIZE));
+  hostfake::queueHttpResponse(patchResponse(5));
+
+  TEST_ASSERT_TRUE(journalFlush());
+  TEST_ASSERT_FALSE(hostfake::fileExists(AIRTABLE_JOURNAL_FILE));
+  TEST_ASSERT_EQUAL(3, hostfake::httpRequests().size()); // Record ids came from the list
+  JsonDocument sent;
+  TEST_ASSERT_TRUE(deserializeJson(sent, hostfake::httpRequests()[2].body) == DeserializationError::Ok);
+  TEST_ASSERT_EQUAL(5, sent["records"].size());
+  TEST_ASSERT_EQUAL_STRING("recITEM0000000020", sent["records"][0]["id"].as<const char*>());
+  TEST_ASSERT_EQUAL_STRING("2023-11-14T22:13:20Z", sent["records"][0]["fields"]["Last Scanned"].as<const char*>());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_append_stamps_key_and_time);
+  RUN_TEST(test_batches_split_by_table_and_size);
+  RUN_TEST(test_torn_lines_are_skipped_but_covered);
+  RUN_TEST(test_only_torn_lines_still_form_a_batch);
+  RUN_TEST(test_drop_prefix_keeps_the_rest);
+  RUN_TEST(test_recover_after_power_loss_before_the_swap);
+  RUN_TEST(test_recover_without_the_compacted_copy);
+  RUN_TEST(test_full_journal_refuses_entries);
+  RUN_TEST(test_flush_merges_entries_per_record);
+  RUN_TEST(test_failed_batch_stays_queued);
+  RUN_TEST(test_flush_without_wifi_sends_nothing);
+  RUN_TEST(test_unknown_uid_is_looked_up_then_dropped);
+  RUN_TEST(test_sessions_are_upserted_on_their_key);
+  RUN_TEST(test_session_seen_is_one_entry_per_batch);
+  RUN_TEST(test_full_bag_session_leaves_room_for_more);
+  RUN_TEST(test_flush_sends_seen_entries_as_patches);
+  return UNITY_END();
+}
@@ -0,0 +1,105 @@
+// The NFC task on its own: no UI loop, just the scan requests the UI would post
+// and the simulated PN532 with its IRQ line wired. Checks that an armed detection
+// leaves the bus alone until IRQ falls, and that the tag event follows the edge
+// instead of the next NFC_TASK_POLL_MS wake-up.
+#include <HostFakes.h>
+#include <unity.h>
+
+#include "../../main.cpp"
+
+using hostfake::pn532;
+
+const std::vector<uint8_t> kUidA = {0x04, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66};
+const std::vector<uint8_t> kUidB = {0x04, 0xA1, 0xB2, 0xC3, 0xD4, 0xE5, 0xF6};
+
+void setUp() {
+  static bool started = false;
+  if (started) {
+    return;
+  }
+  hostfake::reset();
+  pn532().wireIrq(PN532_IRQ);
+  i2cMutex = xSemaphoreCreateMutex();
+  Wire.begin(PN532_SDA, PN532_SCL);
+  uiTaskHandle = xTaskGetCurrentTaskHandle();
+  nfcEngineSetup();
+  xTaskCreatePinnedToCore(nfcTask, "nfc", NFC_TASK_STACK_SIZE, NULL, NFC_TASK_PRIORITY, &nfcTaskHandle, NFC_TASK_CORE);
+  started = true;
+}
+
+void tearDown() {}
+
+// Waits for the next tag event and returns how long after 'since' it arrived.
+uint64_t waitForEvent(NfcTagEvent& event, uint64_t since, uint32_t timeoutMs) {
+  TEST_ASSERT_TRUE(hostfake::runUntil([] { return uxQueueMessagesWaiting(nfcEventQueue) > 0; }, timeoutMs));
+  uint64_t latencyUs = hostfake::nowMicros() - since;
+  TEST_ASSERT_TRUE(nfcEventQueuePop(event));
+  return latencyUs;
+}
+
+void test_scan_request_arms_the_reader() {
+  nfcEngineSetEnabled(true, PN532_MAX_TARGETS, NFC_SCAN_UID_ONLY);
+  TEST_ASSERT_TRUE(hostfake::runUntil([] { return nfcEngineState == NFC_ENGINE_ARMED; }, 500));
+  TEST_ASSERT_TRUE(nfcReaderReady); // First request configured the PN532
+  TEST_ASSERT_TRUE(pn532().detectionArmed());
+}
+
+void test_armed_reader_leaves_the_bus_alone() {
+  uint32_t transactionsBefore = hostfake::i2cStats().transactions;
+  uint32_t commandsBefore = pn532().commands();
+  hostfake::runUntil([] { return false; }, 2000); // 200 poll wake-ups, no tag
+  TEST_ASSERT_EQUAL_UINT32(transactionsBefore, hostfake::i2cStats().transactions);
+  TEST_ASSERT_EQUAL_UINT32(commandsBefore, pn532().commands());
+  TEST_ASSERT_TRUE(pn532().detectionArmed());
+}
+
+void test_tag_event_follows_the_irq_edge() {
+  uint64_t placedAt = hostfake::nowMicros();
+  pn532().placeTag(kUidA);
+  NfcTagEvent event;
+  uint64_t latencyUs = waitForEvent(event, placedAt, 100);
+  TEST_ASSERT_EQUAL_UINT8(7, event.uidLength);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(kUidA.data(), event.uid, 7);
+  // Chip time plus the response read, well inside one poll period
+  TEST_ASSERT_LESS_THAN(hostfake::Pn532Sim::kDetectUs + 2000, latencyUs);
+  TEST_ASSERT_LESS_THAN(NFC_TASK_POLL_MS * 1000ULL, latencyUs);
+  TEST_ASSERT_EQUAL_UINT32(placedAt / 1000, event.detectedAt - hostfake::Pn532Sim::kDetectUs / 1000);
+  pn532().removeTag(kUidA);
+}
+
+void test_each_swipe_is_one_prompt_event() {
+  for (int i = 0; i < 5; i++) {
+    hostfake::runUntil([] { return false; }, NFC_TAG_GONE_MS + 10); // Previous tag forgotten
+    const std::vector<uint8_t>& uid = (i % 2) ? kUidB : kUidA;
+    uint64_t placedAt = hostfake::nowMicros();
+    pn532().placeTag(uid);
+    NfcTagEvent event;
+    uint64_t latencyUs = waitForEvent(event, placedAt, 100);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(uid.data(), event.uid, 7);
+    TEST_ASSERT_LESS_THAN(hostfake::Pn532Sim::kDetectUs + 2000, latencyUs);
+    pn532().removeTag(uid);
+  }
+}
+
+void test_disabled_reader_stays_off_the_bus() {
+  nfcEngineSetEnabled(false, 1, NFC_SCAN_UID_ONLY);
+  TEST_ASSERT_TRUE(hostfake::runUntil([] { return nfcAppliedGeneration == nfcRequestedGeneration; }, 100));
+  TEST_ASSERT_FALSE(pn532().detectionArmed()); // Detection aborted
+  uint32_t transactionsBefore = hostfake::i2cStats().transactions;
+  pn532().placeTag(kUidA);
+  hostfake::runUntil([] { return false; }, 1000);
+  TEST_ASSERT_EQUAL_UINT32(transactionsBefore, hostfake::i2cStats().transactions);
+  NfcTagEvent event;
+  TEST_ASSERT_FALSE(nfcEventQueuePop(event));
+  pn532().removeTag(kUidA);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_scan_request_arms_the_reader);
+  RUN_TEST(test_armed_reader_leaves_the_bus_alone);
+  RUN_TEST(test_tag_event_follows_the_irq_edge);
+  RUN_TEST(test_each_swipe_is_one_prompt_event);
+  RUN_TEST(test_disabled_reader_stays_off_the_bus);
+  return UNITY_END();
+}
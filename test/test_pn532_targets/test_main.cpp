@@ -0,0 +1,156 @@
+// InListPassiveTarget with up to two targets: the response parser behind the
+// repack inventory, fed by the simulated PN532.
+#include <HostFakes.h>
+#include <unity.h>
+
+#include "../../main.cpp"
+
+using hostfake::pn532;
+
+const std::vector<uint8_t> kUid7a = {0x04, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66};
+const std::vector<uint8_t> kUid7b = {0x04, 0xA1, 0xB2, 0xC3, 0xD4, 0xE5, 0xF6};
+const std::vector<uint8_t> kUid4 = {0xDE, 0xAD, 0xBE, 0xEF};
+
+uint8_t uids[PN532_MAX_TARGETS][7];
+uint8_t uidLengths[PN532_MAX_TARGETS];
+
+void setUp() {
+  hostfake::reset();
+  pn532().wireIrq(PN532_IRQ);
+  memset(uids, 0, sizeof(uids));
+  memset(uidLengths, 0, sizeof(uidLengths));
+  TEST_ASSERT_TRUE(nfc.begin());
+  TEST_ASSERT_NOT_EQUAL(0, nfc.getFirmwareVersion());
+}
+
+void tearDown() {}
+
+// Frames a PN532 -> host InListPassiveTarget response around 'payload' (NbTg onwards).
+std::vector<uint8_t> detectionFrame(const std::vector<uint8_t>& payload, int lengthAdjust = 0) {
+  std::vector<uint8_t> data = {0xD5, 0x4B};
+  data.insert(data.end(), payload.begin(), payload.end());
+  uint8_t length = (uint8_t)(data.size() + lengthAdjust);
+  std::vector<uint8_t> frame = {0x00, 0x00, 0xFF, length, (uint8_t)(0x100 - length)};
+  uint8_t sum = 0;
+  for (uint8_t b : data) {
+    frame.push_back(b);
+    sum += b;
+  }
+  frame.push_back((uint8_t)(0x100 - sum));
+  frame.push_back(0x00);
+  return frame;
+}
+
+// Arms a detection and waits for the response, as the scan engine does.
+uint8_t detect(uint8_t maxTargets) {
+  TEST_ASSERT_TRUE(nfc.startPassiveTargetIDDetection(PN532_MIFARE_ISO14443A, maxTargets));
+  TEST_ASSERT_TRUE(hostfake::runUntil([] { return digitalRead(PN532_IRQ) == LOW; }, 100));
+  return nfc.readDetectedPassiveTargetIDs(uids, uidLengths, maxTargets);
+}
+
+void test_single_seven_byte_uid() {
+  pn532().placeTag(kUid7a);
+  TEST_ASSERT_EQUAL_UINT8(1, detect(1));
+  TEST_ASSERT_EQUAL_UINT8(7, uidLengths[0]);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(kUid7a.data(), uids[0], 7);
+}
+
+void test_two_targets_in_one_response() {
+  pn532().placeTag(kUid7a);
+  pn532().placeTag(kUid4);
+  TEST_ASSERT_EQUAL_UINT8(2, detect(2));
+  TEST_ASSERT_EQUAL_UINT8(7, uidLengths[0]);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(kUid7a.data(), uids[0], 7);
+  TEST_ASSERT_EQUAL_UINT8(4, uidLengths[1]);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(kUid4.data(), uids[1], 4);
+}
+
+void test_max_targets_caps_the_result() {
+  pn532().injectDetectionResponse(detectionFrame({0x02,
+                                                  0x01, 0x00, 0x44, 0x00, 0x07, 0x04, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66,
+                                                  0x02, 0x00, 0x44, 0x00, 0x04, 0xDE, 0xAD, 0xBE, 0xEF}));
+  TEST_ASSERT_EQUAL_UINT8(1, detect(1));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(kUid7a.data(), uids[0], 7);
+}
+
+void test_released_targets_stay_quiet_until_removed() {
+  pn532().placeTag(kUid7a);
+  pn532().placeTag(kUid7b);
+  TEST_ASSERT_EQUAL_UINT8(2, detect(2));
+  TEST_ASSERT_TRUE(nfc.inRelease(0));
+
+  pn532().placeTag(kUid4);
+  TEST_ASSERT_EQUAL_UINT8(1, detect(2));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(kUid4.data(), uids[0], 4);
+  TEST_ASSERT_TRUE(nfc.inRelease(0));
+
+  pn532().removeTag(kUid7b); // Answers REQA again once back in the field
+  pn532().placeTag(kUid7b);
+  TEST_ASSERT_EQUAL_UINT8(1, detect(2));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(kUid7b.data(), uids[0], 7);
+}
+
+void test_ats_is_skipped_before_the_next_target() {
+  // An ISO14443-4 card (SEL_RES bit 5) carries its ATS, whose first byte is its length
+  pn532().injectDetectionResponse(detectionFrame({0x02,
+                                                  0x01, 0x03, 0x44, 0x20, 0x07, 0x04, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66,
+                                                  0x05, 0x75, 0x77, 0x81, 0x02,
+                                                  0x02, 0x00, 0x44, 0x00, 0x04, 0xDE, 0xAD, 0xBE, 0xEF}));
+  TEST_ASSERT_EQUAL_UINT8(2, detect(2));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(kUid7a.data(), uids[0], 7);
+  TEST_ASSERT_EQUAL_UINT8(4, uidLengths[1]);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(kUid4.data(), uids[1], 4);
+}
+
+void test_truncated_second_target_keeps_the_first() {
+  // The frame ends two bytes into the second target's UID
+  std::vector<uint8_t> payload = {0x02, 0x01, 0x00, 0x44, 0x00, 0x07, 0x04, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66,
+                                  0x02, 0x00, 0x44, 0x00, 0x07, 0x04, 0xA1};
+  pn532().injectDetectionResponse(detectionFrame(payload));
+  TEST_ASSERT_EQUAL_UINT8(1, detect(2));
+  TEST_ASSERT_EQUAL_UINT8(7, uidLengths[0]);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(kUid7a.data(), uids[0], 7);
+}
+
+void test_uid_longer_than_seven_bytes_is_rejected() {
+  pn532().injectDetectionResponse(detectionFrame({0x01, 0x01, 0x00, 0x44, 0x00, 0x0A,
+                                                  0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A}));
+  TEST_ASSERT_EQUAL_UINT8(0, detect(2));
+}
+
+void test_no_target_found() {
+  pn532().injectDetectionResponse(detectionFrame({0x00}));
+  TEST_ASSERT_EQUAL_UINT8(0, detect(2));
+}
+
+void test_wrong_response_code_is_rejected() {
+  std::vector<uint8_t> frame = detectionFrame({0x01, 0x01, 0x00, 0x44, 0x00, 0x04, 0xDE, 0xAD, 0xBE, 0xEF});
+  frame[6] = 0x41; // InDataExchange response
+  pn532().injectDetectionResponse(frame);
+  TEST_ASSERT_EQUAL_UINT8(0, detect(2));
+}
+
+void test_abort_cancels_a_pending_detection() {
+  TEST_ASSERT_TRUE(nfc.startPassiveTargetIDDetection(PN532_MIFARE_ISO14443A, 2));
+  TEST_ASSERT_TRUE(pn532().detectionArmed());
+  nfc.abortCommand();
+  TEST_ASSERT_FALSE(pn532().detectionArmed());
+  pn532().placeTag(kUid7a);
+  TEST_ASSERT_FALSE(hostfake::runUntil([] { return digitalRead(PN532_IRQ) == LOW; }, 50));
+  TEST_ASSERT_EQUAL_UINT32(0, pn532().detections());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_single_seven_byte_uid);
+  RUN_TEST(test_two_targets_in_one_response);
+  RUN_TEST(test_max_targets_caps_the_result);
+  RUN_TEST(test_released_targets_stay_quiet_until_removed);
+  RUN_TEST(test_ats_is_skipped_before_the_next_target);
+  RUN_TEST(test_truncated_second_target_keeps_the_first);
+  RUN_TEST(test_uid_longer_than_seven_bytes_is_rejected);
+  RUN_TEST(test_no_target_found);
+  RUN_TEST(test_wrong_response_code_is_rejected);
+  RUN_TEST(test_abort_cancels_a_pending_detection);
+  return UNITY_END();
+}
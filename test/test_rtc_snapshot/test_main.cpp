@@ -0,0 +1,136 @@
+// The RTC snapshot that carries the active bag and the equipment table (repack
+// bitsets included) across deep sleep.
+#include <HostFakes.h>
+#include <unity.h>
+
+#include "../../main.cpp"
+
+void setUp() {
+  hostfake::reset();
+  equipmentTableFree(equipment);
+  memset(rtcSnapshot, 0, sizeof(rtcSnapshot));
+  currentAssignedBagID = "recBAGBAGBAGBAG01";
+  currentAssignedBagName = "Main Bag";
+}
+
+void tearDown() { equipmentTableFree(equipment); }
+
+void fillEquipment(uint16_t count) {
+  TEST_ASSERT_TRUE(equipmentTableReserve(equipment, count, count * 12));
+  for (uint16_t i = 0; i < count; i++) {
+    char uidHex[15];
+    char name[12];
+    snprintf(uidHex, sizeof(uidHex), "0400000000%04X", (unsigned)i);
+    snprintf(name, sizeof(name), "Item %u", (unsigned)i);
+    TEST_ASSERT_TRUE(equipmentTableAdd(equipment, uidHex, 14, name, strlen(name), "recXXXXXXXXXXXXXX"));
+  }
+  equipmentTableFinalize(equipment);
+}
+
+// Marks the even items out and scans back every fourth one, keeping the counters in step.
+void fakeRepackProgress() {
+  for (uint16_t i = 0; i < equipment.count; i += 2) {
+    bitsetSet(equipment.usedInitially, i);
+    equipment.usedInitiallyCount++;
+  }
+  for (uint16_t i = 0; i < equipment.count; i += 4) {
+    bitsetSet(equipment.foundInRepack, i);
+    equipment.foundCount++;
+  }
+  equipment.missingCount = equipment.usedInitiallyCount - equipment.foundCount;
+}
+
+void forgetRamState() {
+  equipmentTableFree(equipment);
+  currentAssignedBagID = "";
+  currentAssignedBagName = "";
+}
+
+void test_round_trip_restores_table_bag_and_progress() {
+  fillEquipment(33); // Bitsets spill into a second word
+  fakeRepackProgress();
+  TEST_ASSERT_TRUE(saveRtcSnapshot());
+  forgetRamState();
+
+  TEST_ASSERT_TRUE(restoreRtcSnapshot());
+  TEST_ASSERT_EQUAL_STRING("recBAGBAGBAGBAG01", currentAssignedBagID.c_str());
+  TEST_ASSERT_EQUAL_STRING("Main Bag", currentAssignedBagName.c_str());
+  TEST_ASSERT_EQUAL_UINT16(33, equipment.count);
+  TEST_ASSERT_EQUAL_STRING("Item 32", equipmentName(32));
+  TEST_ASSERT_EQUAL_UINT16(17, equipment.usedInitiallyCount);
+  TEST_ASSERT_EQUAL_UINT16(9, equipment.foundCount);
+  TEST_ASSERT_EQUAL_UINT16(8, equipment.missingCount);
+  TEST_ASSERT_TRUE(bitsetTest(equipment.usedInitially, 32));
+  TEST_ASSERT_TRUE(bitsetTest(equipment.foundInRepack, 32));
+  TEST_ASSERT_FALSE(bitsetTest(equipment.foundInRepack, 30));
+  UidKey key;
+  TEST_ASSERT_TRUE(uidKeyFromHex("04000000000020", 14, key));
+  TEST_ASSERT_EQUAL_INT(32, findItemIndexByUid(key.bytes, key.length));
+}
+
+void test_empty_list_with_a_bag() {
+  TEST_ASSERT_TRUE(saveRtcSnapshot());
+  forgetRamState();
+  TEST_ASSERT_TRUE(restoreRtcSnapshot());
+  TEST_ASSERT_EQUAL_UINT16(0, equipment.count);
+  TEST_ASSERT_EQUAL_STRING("Main Bag", currentAssignedBagName.c_str());
+}
+
+void test_no_bag_means_no_snapshot() {
+  fillEquipment(3);
+  TEST_ASSERT_TRUE(saveRtcSnapshot());
+  currentAssignedBagID = "";
+  TEST_ASSERT_FALSE(saveRtcSnapshot()); // Also drops the one taken before
+  TEST_ASSERT_FALSE(restoreRtcSnapshot());
+}
+
+void test_flipped_bit_fails_the_crc() {
+  fillEquipment(20);
+  TEST_ASSERT_TRUE(saveRtcSnapshot());
+  ((uint8_t*)rtcSnapshot)[sizeof(RtcSnapshotHeader) + 5] ^= 0x10;
+  forgetRamState();
+  TEST_ASSERT_FALSE(restoreRtcSnapshot());
+  TEST_ASSERT_EQUAL_UINT16(0, equipment.count);
+  TEST_ASSERT_TRUE(currentAssignedBagID.isEmpty());
+}
+
+void test_header_counts_are_covered_by_the_crc() {
+  fillEquipment(20);
+  fakeRepackProgress();
+  TEST_ASSERT_TRUE(saveRtcSnapshot());
+  ((RtcSnapshotHeader*)rtcSnapshot)->foundCount++;
+  TEST_ASSERT_FALSE(restoreRtcSnapshot());
+}
+
+void test_list_too_large_for_rtc_memory() {
+  fillEquipment(200); // Far beyond RTC_SNAPSHOT_BYTES
+  TEST_ASSERT_FALSE(saveRtcSnapshot());
+  TEST_ASSERT_FALSE(restoreRtcSnapshot());
+}
+
+void test_invalidate_drops_the_snapshot() {
+  fillEquipment(3);
+  TEST_ASSERT_TRUE(saveRtcSnapshot());
+  invalidateRtcSnapshot();
+  TEST_ASSERT_FALSE(restoreRtcSnapshot());
+}
+
+void test_body_length_beyond_rtc_memory_is_rejected() {
+  fillEquipment(3);
+  TEST_ASSERT_TRUE(saveRtcSnapshot());
+  ((RtcSnapshotHeader*)rtcSnapshot)->bodyBytes = RTC_SNAPSHOT_BYTES; // Checked before the CRC reads that far
+  TEST_ASSERT_FALSE(restoreRtcSnapshot());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_round_trip_restores_table_bag_and_progress);
+  RUN_TEST(test_empty_list_with_a_bag);
+  RUN_TEST(test_no_bag_means_no_snapshot);
+  RUN_TEST(test_flipped_bit_fails_the_crc);
+  RUN_TEST(test_header_counts_are_covered_by_the_crc);
+  RUN_TEST(test_list_too_large_for_rtc_memory);
+  RUN_TEST(test_invalidate_drops_the_snapshot);
+  RUN_TEST(test_body_length_beyond_rtc_memory_is_rejected);
+  return UNITY_END();
+}
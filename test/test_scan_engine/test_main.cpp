@@ -0,0 +1,202 @@
+// The whole firmware on the virtual clock: setup(), the NFC and network tasks and
+// the UI loop run unchanged against the simulated PN532 and OLED, while the tests
+// press buttons and move tags. One boot is shared by the tests, which run in order
+// like a user at the bench: menu, repack, scans, idle, deep sleep.
+#include <HostFakes.h>
+#include <unity.h>
+
+#include "../../main.cpp"
+
+using hostfake::pn532;
+
+const uint16_t kItems = 8;
+
+std::vector<uint8_t> itemUid(uint16_t i) { return {0x04, 0x00, 0x00, 0x00, 0x00, 0x00, (uint8_t)i}; }
+
+void setUp() {
+  static bool booted = false;
+  if (booted) {
+    return;
+  }
+  hostfake::reset();
+  pn532().wireIrq(PN532_IRQ);
+  hostfake::writeFile(BAG_CONFIG_FILE, "recBAGBAGBAGBAG01\nMain Bag\n");
+  std::string csv;
+  for (uint16_t i = 0; i < kItems; i++) {
+    char line[48];
+    snprintf(line, sizeof(line), "040000000000%02X,recITEM%09u,Item %u\n", i, i, i);
+    csv += line;
+  }
+  hostfake::writeFile(EQUIPMENT_LIST_CSV_FILE, csv);
+  setup();
+  booted = true;
+}
+
+void tearDown() {}
+
+// Runs passes of loop() until 'done' holds or timeoutMs of virtual time passed.
+bool runLoopUntil(const std::function<bool()>& done, uint32_t timeoutMs) {
+  unsigned long deadline = millis() + timeoutMs;
+  while (!done() && (long)(millis() - deadline) < 0) {
+    loop();
+  }
+  return done();
+}
+
+// A press as a finger makes it: down after 'afterMs', up 80 ms later.
+void pressButton(uint8_t pin, uint32_t afterMs = 1) {
+  hostfake::scheduleAfter(afterMs * 1000ULL, [pin] { hostfake::setPinLevel(pin, HIGH); });
+  hostfake::scheduleAfter((afterMs + 80) * 1000ULL, [pin] { hostfake::setPinLevel(pin, LOW); });
+}
+
+// Swipes a tag over the pad for 'holdMs'.
+void swipeTag(const std::vector<uint8_t>& uid, uint32_t afterMs, uint32_t holdMs = 150) {
+  hostfake::scheduleAfter(afterMs * 1000ULL, [uid] { pn532().placeTag(uid); });
+  hostfake::scheduleAfter((afterMs + holdMs) * 1000ULL, [uid] { pn532().removeTag(uid); });
+}
+
+bool stateIs(SystemState state) { return currentState == state; }
+
+void pressAndWaitFor(uint8_t pin, SystemState state) {
+  pressButton(pin);
+  TEST_ASSERT_TRUE(runLoopUntil([state] { return stateIs(state); }, 2000));
+  runLoopUntil([] { return false; }, 200); // Finger off, past the debounce window
+}
+
+void test_cold_boot_loads_the_list_and_idles() {
+  TEST_ASSERT_EQUAL_UINT16(kItems, equipment.count);
+  TEST_ASSERT_EQUAL_STRING("Main Bag", currentAssignedBagName.c_str());
+  TEST_ASSERT_TRUE(hostfake::fileExists(EQUIPMENT_LIST_FILE)); // CSV migrated
+  TEST_ASSERT_TRUE(stateIs(IDLE_MENU));
+
+  uint32_t sleepsBefore = hostfake::sleepStats().lightSleeps;
+  runLoopUntil([] { return false; }, 5000);
+  TEST_ASSERT_TRUE(nfcReaderReady); // Configured by the NFC task during boot
+  TEST_ASSERT_FALSE(pn532().detectionArmed()); // The menu does not scan
+  TEST_ASSERT_GREATER_THAN(sleepsBefore, hostfake::sleepStats().lightSleeps);
+}
+
+void test_menu_leads_to_scanning() {
+  pressAndWaitFor(BUTTON_C_PIN, REPACK_SESSION_START_CONFIRM);
+  pressAndWaitFor(BUTTON_A_PIN, SESSION_ACTIVE);
+  TEST_ASSERT_EQUAL_UINT16(kItems, equipment.missingCount);
+  pressAndWaitFor(BUTTON_C_PIN, REPACKING_SCAN);
+  TEST_ASSERT_TRUE(runLoopUntil([] { return pn532().detectionArmed(); }, 500));
+  TEST_ASSERT_EQUAL_UINT8(PN532_MAX_TARGETS, nfcEngineMaxTargets);
+}
+
+void test_idle_scan_passes_do_not_allocate() {
+  runLoopUntil([] { return false; }, 3000); // Let the screen settle
+  for (int i = 0; i < 20; i++) {
+    uint64_t before = hostfake::heapStats().allocations;
+    runStateMachine();
+    TEST_ASSERT_EQUAL_UINT64(before, hostfake::heapStats().allocations);
+    uiIdleWait();
+  }
+}
+
+void test_swiped_tags_are_found_quickly() {
+  for (uint16_t i = 0; i < 3; i++) {
+    swipeTag(itemUid(i), 200 + i * 600);
+  }
+  // Drives the passes by hand to time each runStateMachine() that handles a scan
+  uint64_t worstUs = 0;
+  uint64_t scanAllocations = 0;
+  unsigned long deadline = millis() + 3000;
+  while (equipment.foundCount < 3 && (long)(millis() - deadline) < 0) {
+    uint16_t foundBefore = equipment.foundCount;
+    uint64_t allocationsBefore = hostfake::heapStats().allocations;
+    uint64_t startedAt = hostfake::nowMicros();
+    runStateMachine();
+    if (equipment.foundCount != foundBefore) {
+      worstUs = std::max(worstUs, hostfake::nowMicros() - startedAt);
+      scanAllocations += hostfake::heapStats().allocations - allocationsBefore;
+    }
+    uiIdleWait();
+  }
+  TEST_ASSERT_EQUAL_UINT16(3, equipment.foundCount);
+  TEST_ASSERT_EQUAL_UINT16(kItems - 3, equipment.missingCount);
+  // A scan pass pushes the changed OLED pages and the toast
+  TEST_ASSERT_LESS_THAN(20000, worstUs);
+  TEST_ASSERT_LESS_OR_EQUAL(3 * 20, scanAllocations); // Toast and status Strings only
+  TEST_ASSERT_EQUAL_UINT32(3, pn532().detections());
+}
+
+void test_tag_resting_on_the_pad_counts_once() {
+  uint32_t detectionsBefore = pn532().detections();
+  hostfake::scheduleAfter(10000, [] { pn532().placeTag(itemUid(3)); });
+  runLoopUntil([] { return false; }, 2000);
+  TEST_ASSERT_EQUAL_UINT16(4, equipment.foundCount);
+  TEST_ASSERT_EQUAL_UINT32(detectionsBefore + 1, pn532().detections()); // Halted after the read
+  TEST_ASSERT_TRUE(hostfake::serialOutput().find("Already Scanned") == std::string::npos);
+  pn532().removeTag(itemUid(3));
+}
+
+void test_two_tags_in_the_field_are_read_together() {
+  uint32_t detectionsBefore = pn532().detections();
+  hostfake::scheduleAfter(10000, [] {
+    pn532().placeTag(itemUid(4));
+    pn532().placeTag(itemUid(5));
+  });
+  TEST_ASSERT_TRUE(runLoopUntil([] { return equipment.foundCount == 6; }, 1000));
+  TEST_ASSERT_EQUAL_UINT32(detectionsBefore + 1, pn532().detections());
+  pn532().removeAllTags();
+}
+
+void test_rescanned_item_shows_only_already_scanned() {
+  hostfake::serialOutput().clear();
+  swipeTag(itemUid(0), NFC_TAG_GONE_MS + 10); // Left the pad long ago, so it reads again
+  TEST_ASSERT_TRUE(runLoopUntil([] { return hostfake::serialOutput().find("already scanned") != std::string::npos; }, 2000));
+  TEST_ASSERT_TRUE(hostfake::serialOutput().find("Matched") == std::string::npos); // No "Scanned:" toast
+  TEST_ASSERT_EQUAL_UINT16(6, equipment.foundCount);
+  runLoopUntil([] { return false; }, 200);
+}
+
+void test_unknown_tag_is_reported() {
+  hostfake::serialOutput().clear();
+  swipeTag({0x04, 0xEE, 0xEE, 0xEE, 0xEE, 0xEE, 0xEE}, 10);
+  TEST_ASSERT_TRUE(runLoopUntil([] { return hostfake::serialOutput().find("Unknown Tag") != std::string::npos; }, 1000));
+  TEST_ASSERT_EQUAL_UINT16(6, equipment.foundCount);
+}
+
+void test_last_items_complete_the_session() {
+  swipeTag(itemUid(6), 10);
+  swipeTag(itemUid(7), 400);
+  TEST_ASSERT_TRUE(runLoopUntil([] { return stateIs(REPACK_SESSION_COMPLETE); }, 2000));
+  TEST_ASSERT_EQUAL_UINT16(0, equipment.missingCount);
+  std::string journal;
+  TEST_ASSERT_TRUE(runLoopUntil([&journal] {
+    return hostfake::readFile(AIRTABLE_JOURNAL_FILE, &journal) && journal.find("\"op\":\"session\"") != std::string::npos;
+  }, 500));
+  TEST_ASSERT_FALSE(pn532().detectionArmed()); // Reader idles again
+  TEST_ASSERT_TRUE(runLoopUntil([] { return stateIs(IDLE_MENU); }, WELL_DONE_TIMEOUT_MS + 1000));
+}
+
+void test_inactivity_ends_in_deep_sleep() {
+  bool slept = false;
+  try {
+    runLoopUntil([] { return false; }, DEEP_SLEEP_TIMEOUT_MS + 5000);
+  } catch (const hostfake::DeepSleep&) {
+    slept = true;
+  }
+  TEST_ASSERT_TRUE(slept);
+  TEST_ASSERT_TRUE(rtcDataIsValid);
+  equipmentTableFree(equipment);
+  TEST_ASSERT_TRUE(restoreRtcSnapshot()); // What the button wake will find
+  TEST_ASSERT_EQUAL_UINT16(kItems, equipment.count);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_cold_boot_loads_the_list_and_idles);
+  RUN_TEST(test_menu_leads_to_scanning);
+  RUN_TEST(test_idle_scan_passes_do_not_allocate);
+  RUN_TEST(test_swiped_tags_are_found_quickly);
+  RUN_TEST(test_tag_resting_on_the_pad_counts_once);
+  RUN_TEST(test_two_tags_in_the_field_are_read_together);
+  RUN_TEST(test_rescanned_item_shows_only_already_scanned);
+  RUN_TEST(test_unknown_tag_is_reported);
+  RUN_TEST(test_last_items_complete_the_session);
+  RUN_TEST(test_inactivity_ends_in_deep_sleep);
+  return UNITY_END();
+}